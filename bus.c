@@ -0,0 +1,651 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "bus.h"
+#include "catalog.h"
+
+#ifdef HAVE_LIBSYSTEMD
+#include <systemd/sd-bus.h>
+
+#define SD_DEST        "org.freedesktop.systemd1"
+#define SD_UNIT_PREFIX "/org/freedesktop/systemd1/unit"
+#define SD_UNIT_IFACE  "org.freedesktop.systemd1.Unit"
+#define SD_SVC_IFACE   "org.freedesktop.systemd1.Service"
+#define DBUS_PROPS     "org.freedesktop.DBus.Properties"
+#define SD_MGR_PATH    "/org/freedesktop/systemd1"
+#define SD_MGR_IFACE   "org.freedesktop.systemd1.Manager"
+
+static sd_bus *system_bus = NULL;
+static sd_bus *user_bus   = NULL;
+
+/* sd-bus-Verbindungen sind nicht threadsicher: jede oeffentliche Funktion
+   haelt bus_mutex. Signal-Handler laufen darunter und nehmen data_lock(),
+   die Reihenfolge ist also immer Bus vor Daten - wer data_lock() haelt,
+   darf hier nichts aufrufen (ausser bus_events_active()). */
+static pthread_mutex_t bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Anzahl Cache-Eintraege, die seit dem letzten bus_process_events() per Signal
+// invalidiert wurden
+static atomic_int events_subscribed = 0;
+static int events_changed = 0;
+
+// --------------------------------------------------
+// Verbindung
+// --------------------------------------------------
+static int have_bus(void) {
+    return system_bus != NULL || user_bus != NULL;
+}
+
+int bus_init(void) {
+    pthread_mutex_lock(&bus_mutex);
+    if (!have_bus()) {
+        if (sd_bus_open_system(&system_bus) < 0) system_bus = NULL;
+        if (sd_bus_open_user(&user_bus) < 0)     user_bus = NULL;
+    }
+    int ok = have_bus();
+    pthread_mutex_unlock(&bus_mutex);
+    return ok ? 0 : -1;
+}
+
+void bus_close(void) {
+    pthread_mutex_lock(&bus_mutex);
+    atomic_store(&events_subscribed, 0);
+    if (system_bus) system_bus = sd_bus_flush_close_unref(system_bus);
+    if (user_bus)   user_bus   = sd_bus_flush_close_unref(user_bus);
+    pthread_mutex_unlock(&bus_mutex);
+}
+
+int bus_available(void) {
+    pthread_mutex_lock(&bus_mutex);
+    int ok = have_bus();
+    pthread_mutex_unlock(&bus_mutex);
+    return ok;
+}
+
+// --------------------------------------------------
+// Properties lesen
+// --------------------------------------------------
+static void copy_prop(char *dst, size_t dstsize, const char *src) {
+    snprintf(dst, dstsize, "%s", src ? src : "");
+}
+
+// Mikrosekunden seit der Epoche -> wie "systemctl show" (ohne --timestamp)
+static void format_usec(uint64_t usec, char *out, size_t outsize) {
+    out[0] = '\0';
+    if (usec == 0) return;
+
+    time_t t = (time_t)(usec / 1000000);
+    struct tm tm;
+    if (localtime_r(&t, &tm)) strftime(out, outsize, "%a %Y-%m-%d %H:%M:%S %Z", &tm);
+}
+
+/* Liest das a{sv} aus einem GetAll-Reply.
+   Bekannte Properties landen in info, alles andere wird uebersprungen. */
+static int read_props(sd_bus_message *m, struct unit_info *info) {
+    int r = sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sv}");
+    if (r < 0) return r;
+
+    while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY, "sv")) > 0) {
+        const char *name = NULL;
+        r = sd_bus_message_read(m, "s", &name);
+        if (r < 0) return r;
+
+        char *dst = NULL;
+        size_t dstsize = 0;
+        if (strcmp(name, "ActiveState") == 0) {
+            dst = info->active;     dstsize = sizeof(info->active);
+        } else if (strcmp(name, "UnitFileState") == 0) {
+            dst = info->enabled;    dstsize = sizeof(info->enabled);
+        } else if (strcmp(name, "LoadState") == 0) {
+            dst = info->load_state; dstsize = sizeof(info->load_state);
+        } else if (strcmp(name, "SubState") == 0) {
+            dst = info->sub_state;  dstsize = sizeof(info->sub_state);
+        } else if (strcmp(name, "Description") == 0) {
+            dst = info->desc;       dstsize = sizeof(info->desc);
+        } else if (strcmp(name, "ControlGroup") == 0) {
+            dst = info->cgroup;     dstsize = sizeof(info->cgroup);
+        } else if (strcmp(name, "FragmentPath") == 0) {
+            dst = info->fragment;   dstsize = sizeof(info->fragment);
+        }
+
+        if (dst) {
+            const char *val = NULL;
+            r = sd_bus_message_read(m, "v", "s", &val);
+            if (r >= 0) copy_prop(dst, dstsize, val);
+        } else if (strcmp(name, "MainPID") == 0) {
+            uint32_t pid = 0;
+            r = sd_bus_message_read(m, "v", "u", &pid);
+            if (r >= 0) info->main_pid = (long)pid;
+        } else if (strcmp(name, "ActiveEnterTimestamp") == 0) {
+            uint64_t usec = 0;
+            r = sd_bus_message_read(m, "v", "t", &usec);
+            if (r >= 0) format_usec(usec, info->active_since, sizeof(info->active_since));
+        } else {
+            r = sd_bus_message_skip(m, "v");
+        }
+        if (r < 0) return r;
+
+        r = sd_bus_message_exit_container(m);
+        if (r < 0) return r;
+    }
+    if (r < 0) return r;
+
+    return sd_bus_message_exit_container(m);
+}
+
+/* Ein GetAll fuer ein Interface. systemd laedt die Unit beim Zugriff
+   auf den Objektpfad selbst, ein vorheriges LoadUnit ist nicht noetig. */
+static int get_all(sd_bus *bus, const char *path, const char *iface,
+                   struct unit_info *info) {
+    sd_bus_error err = SD_BUS_ERROR_NULL;
+    sd_bus_message *reply = NULL;
+
+    int r = sd_bus_call_method(bus, SD_DEST, path, DBUS_PROPS, "GetAll",
+                               &err, &reply, "s", iface);
+    if (r >= 0) r = read_props(reply, info);
+
+    sd_bus_message_unref(reply);
+    sd_bus_error_free(&err);
+    return r;
+}
+
+static int is_service_unit(const char *svc) {
+    size_t len = strlen(svc);
+    return len > 8 && strcmp(svc + len - 8, ".service") == 0;
+}
+
+/* Fragt die Unit auf einem Bus ab.
+   Rueckgabe: 1 = geladen, 0 = nicht geladen, <0 = Busfehler */
+static int query_unit(sd_bus *bus, const char *svc, struct unit_info *info) {
+    if (!bus) return -1;
+
+    char *path = NULL;
+    if (sd_bus_path_encode(SD_UNIT_PREFIX, svc, &path) < 0) return -1;
+
+    int r = get_all(bus, path, SD_UNIT_IFACE, info);
+    if (r >= 0 && strcmp(info->load_state, "loaded") == 0) {
+        if (is_service_unit(svc)) {
+            get_all(bus, path, SD_SVC_IFACE, info);
+        }
+        r = 1;
+    } else if (r >= 0) {
+        r = 0;
+    }
+
+    free(path);
+    return r;
+}
+
+// --------------------------------------------------
+// Oeffentliche Abfragen
+// --------------------------------------------------
+static int get_unit_info_locked(const char *svc, struct unit_info *info) {
+    if (!have_bus()) return -1;
+
+    memset(info, 0, sizeof(*info));
+    int r_sys = query_unit(system_bus, svc, info);
+    if (r_sys == 1) {
+        strcpy(info->scope, "system");
+        return 0;
+    }
+
+    memset(info, 0, sizeof(*info));
+    int r_usr = query_unit(user_bus, svc, info);
+    if (r_usr == 1) {
+        strcpy(info->scope, "user");
+        return 0;
+    }
+
+    // Beide Busse kaputt -> Aufrufer soll auf systemctl zurueckfallen
+    if (r_sys < 0 && r_usr < 0) return -1;
+
+    memset(info, 0, sizeof(*info));
+    strcpy(info->scope, "none");
+    return 0;
+}
+
+// --------------------------------------------------
+// Batch: alle GetAll-Calls pipelined, dann gemeinsam abarbeiten
+// --------------------------------------------------
+struct batch_slot {
+    sd_bus_slot *slot;
+    struct unit_info *info;
+    int *pending;
+    int done;
+    int failed;
+};
+
+static int on_getall_reply(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+    (void)ret_error;
+    struct batch_slot *slot = userdata;
+
+    if (sd_bus_message_is_method_error(m, NULL) || read_props(m, slot->info) < 0) {
+        slot->failed = 1;
+    }
+    slot->done = 1;
+    (*slot->pending)--;
+    return 0;
+}
+
+#define BATCH_TIMEOUT_USEC (2ULL * 1000 * 1000)
+
+/* Schickt fuer alle Units mit todo[i] die GetAll-Calls (Unit + Service)
+   ohne auf Antworten zu warten und sammelt sie danach ein.
+   Ein Roundtrip fuer N Units statt N. */
+static int batch_query(sd_bus *bus, const char **svcs, int count,
+                       struct unit_info *infos, const int *todo) {
+    if (!bus) return -1;
+
+    struct batch_slot *slots = calloc((size_t)count * 2, sizeof(*slots));
+    if (!slots) return -1;
+
+    int pending = 0;
+    int sent = 0;
+    for (int i = 0; i < count; i++) {
+        if (!todo[i]) continue;
+
+        char *path = NULL;
+        if (sd_bus_path_encode(SD_UNIT_PREFIX, svcs[i], &path) < 0) continue;
+
+        const char *ifaces[2] = { SD_UNIT_IFACE, SD_SVC_IFACE };
+        int n_ifaces = is_service_unit(svcs[i]) ? 2 : 1;
+        for (int k = 0; k < n_ifaces; k++) {
+            struct batch_slot *slot = &slots[i * 2 + k];
+            slot->info = &infos[i];
+            slot->pending = &pending;
+            if (sd_bus_call_method_async(bus, &slot->slot, SD_DEST, path, DBUS_PROPS, "GetAll",
+                                         on_getall_reply, slot, "s", ifaces[k]) >= 0) {
+                pending++;
+                sent++;
+            } else {
+                slot->failed = 1;
+            }
+        }
+        free(path);
+    }
+
+    int r = 0;
+    while (pending > 0) {
+        r = sd_bus_process(bus, NULL);
+        if (r < 0) break;
+        if (r > 0) continue;
+        r = sd_bus_wait(bus, BATCH_TIMEOUT_USEC);
+        if (r < 0) break;
+        if (r == 0) { r = -1; break; } // Timeout
+    }
+
+    // Offene Calls (Timeout) abbrechen, bevor die Slots freigegeben werden
+    int ok = 0;
+    for (int i = 0; i < count * 2; i++) {
+        if (slots[i].slot) sd_bus_slot_unref(slots[i].slot);
+        if (i % 2 == 0 && slots[i].done && !slots[i].failed) ok++;
+    }
+    free(slots);
+
+    if (sent == 0 || (r < 0 && ok == 0)) return -1;
+    return 0;
+}
+
+static int get_unit_infos_locked(const char **svcs, int count, struct unit_info *infos) {
+    if (!have_bus()) return -1;
+
+    int *todo = malloc((size_t)count * sizeof(int));
+    if (!todo) return -1;
+
+    memset(infos, 0, (size_t)count * sizeof(*infos));
+    for (int i = 0; i < count; i++) todo[i] = 1;
+    int r_sys = batch_query(system_bus, svcs, count, infos, todo);
+
+    // Was system-weit nicht geladen ist, auf dem User-Bus nachfragen
+    int remaining = 0;
+    for (int i = 0; i < count; i++) {
+        if (r_sys == 0 && strcmp(infos[i].load_state, "loaded") == 0) {
+            strcpy(infos[i].scope, "system");
+            todo[i] = 0;
+        } else {
+            memset(&infos[i], 0, sizeof(infos[i]));
+            remaining++;
+        }
+    }
+
+    int r_usr = remaining ? batch_query(user_bus, svcs, count, infos, todo) : 0;
+    for (int i = 0; i < count; i++) {
+        if (!todo[i]) continue;
+        if (r_usr == 0 && strcmp(infos[i].load_state, "loaded") == 0) {
+            strcpy(infos[i].scope, "user");
+        } else {
+            memset(&infos[i], 0, sizeof(infos[i]));
+            strcpy(infos[i].scope, "none");
+        }
+    }
+    free(todo);
+
+    return (r_sys < 0 && r_usr < 0) ? -1 : 0;
+}
+
+static int load_state_on(sd_bus *bus, const char *svc, char *out, size_t outsize) {
+    if (!bus) return -1;
+
+    char *path = NULL;
+    if (sd_bus_path_encode(SD_UNIT_PREFIX, svc, &path) < 0) return -1;
+
+    sd_bus_error err = SD_BUS_ERROR_NULL;
+    char *val = NULL;
+    int r = sd_bus_get_property_string(bus, SD_DEST, path, SD_UNIT_IFACE,
+                                       "LoadState", &err, &val);
+    if (r >= 0) copy_prop(out, outsize, val);
+
+    free(val);
+    free(path);
+    sd_bus_error_free(&err);
+    return r < 0 ? -1 : 0;
+}
+
+static int detect_scope_locked(const char *svc, char *scope, size_t bufsize) {
+    if (!have_bus()) return -1;
+
+    char state[32] = {0};
+    int r_sys = load_state_on(system_bus, svc, state, sizeof(state));
+    if (r_sys == 0 && strcmp(state, "loaded") == 0) {
+        snprintf(scope, bufsize, "system");
+        return 0;
+    }
+
+    state[0] = '\0';
+    int r_usr = load_state_on(user_bus, svc, state, sizeof(state));
+    if (r_usr == 0 && strcmp(state, "loaded") == 0) {
+        snprintf(scope, bufsize, "user");
+        return 0;
+    }
+
+    if (r_sys < 0 && r_usr < 0) return -1;
+
+    snprintf(scope, bufsize, "none");
+    return 0;
+}
+
+int bus_get_unit_info(const char *svc, struct unit_info *info) {
+    if (!svc || !info) return -1;
+    pthread_mutex_lock(&bus_mutex);
+    int r = get_unit_info_locked(svc, info);
+    pthread_mutex_unlock(&bus_mutex);
+    return r;
+}
+
+int bus_get_unit_infos(const char **svcs, int count, struct unit_info *infos) {
+    if (!svcs || !infos || count <= 0) return -1;
+    pthread_mutex_lock(&bus_mutex);
+    int r = get_unit_infos_locked(svcs, count, infos);
+    pthread_mutex_unlock(&bus_mutex);
+    return r;
+}
+
+int bus_detect_scope(const char *svc, char *scope, size_t bufsize) {
+    if (!svc || !scope) return -1;
+    pthread_mutex_lock(&bus_mutex);
+    int r = detect_scope_locked(svc, scope, bufsize);
+    pthread_mutex_unlock(&bus_mutex);
+    return r;
+}
+
+// --------------------------------------------------
+// Unit-Katalog: ein ListUnits + ein ListUnitFiles pro Scope
+// --------------------------------------------------
+static int list_units(sd_bus *bus, int scope) {
+    sd_bus_error err = SD_BUS_ERROR_NULL;
+    sd_bus_message *reply = NULL;
+
+    int r = sd_bus_call_method(bus, SD_DEST, SD_MGR_PATH, SD_MGR_IFACE, "ListUnits",
+                               &err, &reply, NULL);
+    if (r >= 0) r = sd_bus_message_enter_container(reply, SD_BUS_TYPE_ARRAY, "(ssssssouso)");
+    while (r >= 0) {
+        const char *name, *desc, *load, *active, *sub, *following, *path, *job_type, *job_path;
+        uint32_t job_id;
+        r = sd_bus_message_read(reply, "(ssssssouso)", &name, &desc, &load, &active, &sub,
+                                &following, &path, &job_id, &job_type, &job_path);
+        if (r <= 0) break;
+        // Nur referenziert, aber ohne Unit-Datei: nicht im Scope vorhanden
+        if (strcmp(load, "not-found") == 0) continue;
+
+        struct catalog_unit *u = catalog_add(name, scope);
+        if (!u) continue;
+        catalog_set(&u->load, load);
+        catalog_set(&u->sub, sub);
+        catalog_set(&u->desc, desc);
+        u->active = (unsigned char)unit_active_parse(active);
+    }
+
+    sd_bus_message_unref(reply);
+    sd_bus_error_free(&err);
+    return r < 0 ? r : 0;
+}
+
+static int list_unit_files(sd_bus *bus, int scope) {
+    sd_bus_error err = SD_BUS_ERROR_NULL;
+    sd_bus_message *reply = NULL;
+
+    int r = sd_bus_call_method(bus, SD_DEST, SD_MGR_PATH, SD_MGR_IFACE, "ListUnitFiles",
+                               &err, &reply, NULL);
+    if (r >= 0) r = sd_bus_message_enter_container(reply, SD_BUS_TYPE_ARRAY, "(ss)");
+    while (r >= 0) {
+        const char *file, *state;
+        r = sd_bus_message_read(reply, "(ss)", &file, &state);
+        if (r <= 0) break;
+
+        const char *slash = strrchr(file, '/');
+        struct catalog_unit *u = catalog_add(slash ? slash + 1 : file, scope);
+        if (!u) continue;
+        u->enabled = (unsigned char)unit_enabled_parse(state);
+    }
+
+    sd_bus_message_unref(reply);
+    sd_bus_error_free(&err);
+    return r < 0 ? r : 0;
+}
+
+int bus_fill_catalog(int scope) {
+    pthread_mutex_lock(&bus_mutex);
+    sd_bus *bus = scope == UNIT_SCOPE_USER ? user_bus : system_bus;
+    int r = bus ? 0 : -1;
+
+    // Geladene Units zuerst: sie bringen Zustand und Beschreibung mit
+    if (bus && list_units(bus, scope) < 0) r = -1;
+    if (r == 0) list_unit_files(bus, scope);
+    pthread_mutex_unlock(&bus_mutex);
+    return r;
+}
+
+// --------------------------------------------------
+// Signale: PropertiesChanged, UnitNew/UnitRemoved, JobRemoved,
+//          Reloading, UnitFilesChanged
+// --------------------------------------------------
+
+// Objektpfad /org/freedesktop/systemd1/unit/foo_2eservice -> foo.service
+static int on_properties_changed(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+    (void)userdata; (void)ret_error;
+
+    char *name = NULL;
+    const char *path = sd_bus_message_get_path(m);
+    if (!path || sd_bus_path_decode(path, SD_UNIT_PREFIX, &name) <= 0) return 0;
+
+    if (invalidate_service_cache_event(name, 0)) events_changed++;
+    free(name);
+    return 0;
+}
+
+/* UnitNew/UnitRemoved kommen auch, wenn unsere eigene Abfrage eine Unit
+   laedt bzw. systemd sie danach wieder wegraeumt. Gerade erst geholte
+   Eintraege deshalb nicht erneut invalidieren, sonst pingpongt es. */
+#define UNIT_EVENT_MIN_AGE 2
+
+static int on_unit_new_removed(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+    (void)userdata; (void)ret_error;
+
+    const char *id = NULL, *path = NULL;
+    if (sd_bus_message_read(m, "so", &id, &path) < 0 || !id) return 0;
+
+    if (invalidate_service_cache_event(id, UNIT_EVENT_MIN_AGE)) events_changed++;
+    return 0;
+}
+
+static int on_job_removed(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+    (void)userdata; (void)ret_error;
+
+    uint32_t job_id = 0;
+    const char *job_path = NULL, *unit = NULL, *result = NULL;
+    if (sd_bus_message_read(m, "uoss", &job_id, &job_path, &unit, &result) < 0 || !unit)
+        return 0;
+
+    if (invalidate_service_cache_event(unit, 0)) events_changed++;
+    return 0;
+}
+
+/* daemon-reload bzw. enable/disable/neue Unit-Dateien: Scopes und
+   UnitFileState koennen sich fuer beliebige Units geaendert haben */
+static int on_reloading(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+    (void)userdata; (void)ret_error;
+
+    int active = 0;
+    if (sd_bus_message_read(m, "b", &active) < 0 || active) return 0; // erst nach dem Reload
+
+    events_changed += invalidate_scope_cache_event();
+    return 0;
+}
+
+static int on_unit_files_changed(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+    (void)m; (void)userdata; (void)ret_error;
+
+    events_changed += invalidate_scope_cache_event();
+    return 0;
+}
+
+static int subscribe_bus(sd_bus *bus) {
+    if (!bus) return -1;
+
+    sd_bus_error err = SD_BUS_ERROR_NULL;
+    int r = sd_bus_call_method(bus, SD_DEST, SD_MGR_PATH, SD_MGR_IFACE, "Subscribe",
+                               &err, NULL, NULL);
+    sd_bus_error_free(&err);
+    if (r < 0) return r;
+
+    if (sd_bus_match_signal(bus, NULL, SD_DEST, NULL, DBUS_PROPS, "PropertiesChanged",
+                            on_properties_changed, NULL) < 0 ||
+        sd_bus_match_signal(bus, NULL, SD_DEST, SD_MGR_PATH, SD_MGR_IFACE, "UnitNew",
+                            on_unit_new_removed, NULL) < 0 ||
+        sd_bus_match_signal(bus, NULL, SD_DEST, SD_MGR_PATH, SD_MGR_IFACE, "UnitRemoved",
+                            on_unit_new_removed, NULL) < 0 ||
+        sd_bus_match_signal(bus, NULL, SD_DEST, SD_MGR_PATH, SD_MGR_IFACE, "JobRemoved",
+                            on_job_removed, NULL) < 0 ||
+        sd_bus_match_signal(bus, NULL, SD_DEST, SD_MGR_PATH, SD_MGR_IFACE, "Reloading",
+                            on_reloading, NULL) < 0 ||
+        sd_bus_match_signal(bus, NULL, SD_DEST, SD_MGR_PATH, SD_MGR_IFACE, "UnitFilesChanged",
+                            on_unit_files_changed, NULL) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Abonniert die systemd-Signale auf beiden Bussen. Solange das klappt,
+   verfallen Cache-Eintraege nicht mehr per TTL, sondern nur per Signal. */
+int bus_subscribe(void) {
+    pthread_mutex_lock(&bus_mutex);
+    int r = 0;
+    if (!atomic_load(&events_subscribed)) {
+        int r_sys = subscribe_bus(system_bus);
+        int r_usr = subscribe_bus(user_bus);
+
+        // Beide vorhandenen Busse muessen Signale liefern, sonst TTL behalten
+        if ((system_bus && r_sys < 0) || (user_bus && r_usr < 0) || !have_bus()) r = -1;
+        else atomic_store(&events_subscribed, 1);
+    }
+    pthread_mutex_unlock(&bus_mutex);
+    return r;
+}
+
+// Ohne bus_mutex: wird unter data_lock() aus dem Zustands-Cache gefragt
+int bus_events_active(void) {
+    return atomic_load(&events_subscribed);
+}
+
+int bus_fill_pollfds(struct pollfd *pfds, int max) {
+    pthread_mutex_lock(&bus_mutex);
+    sd_bus *buses[2] = { system_bus, user_bus };
+    int n = 0;
+
+    for (int i = 0; i < 2 && n < max; i++) {
+        if (!buses[i]) continue;
+        int fd = sd_bus_get_fd(buses[i]);
+        int ev = sd_bus_get_events(buses[i]);
+        if (fd < 0 || ev < 0) continue;
+        pfds[n].fd = fd;
+        pfds[n].events = (short)ev;
+        pfds[n].revents = 0;
+        n++;
+    }
+    pthread_mutex_unlock(&bus_mutex);
+    return n;
+}
+
+/* Arbeitet alle anstehenden Nachrichten ab (nicht blockierend).
+   Rueckgabe: Anzahl betroffener Cache-Eintraege */
+int bus_process_events(void) {
+    pthread_mutex_lock(&bus_mutex);
+    sd_bus *buses[2] = { system_bus, user_bus };
+
+    for (int i = 0; i < 2; i++) {
+        if (!buses[i]) continue;
+        while (sd_bus_process(buses[i], NULL) > 0)
+            ;
+    }
+
+    // Auch Signale, die waehrend einer Abfrage (batch_query) kamen
+    int changed = events_changed;
+    events_changed = 0;
+    pthread_mutex_unlock(&bus_mutex);
+    return changed;
+}
+
+#else /* !HAVE_LIBSYSTEMD */
+
+// Ohne libsystemd: nur systemctl-Fallback
+int  bus_init(void) { return -1; }
+void bus_close(void) { }
+int  bus_available(void) { return 0; }
+
+int bus_detect_scope(const char *svc, char *scope, size_t bufsize) {
+    (void)svc; (void)scope; (void)bufsize;
+    return -1;
+}
+
+int bus_get_unit_info(const char *svc, struct unit_info *info) {
+    (void)svc; (void)info;
+    return -1;
+}
+
+int bus_get_unit_infos(const char **svcs, int count, struct unit_info *infos) {
+    (void)svcs; (void)count; (void)infos;
+    return -1;
+}
+
+int bus_fill_catalog(int scope) {
+    (void)scope;
+    return -1;
+}
+
+int bus_subscribe(void) { return -1; }
+int bus_events_active(void) { return 0; }
+
+int bus_fill_pollfds(struct pollfd *pfds, int max) {
+    (void)pfds; (void)max;
+    return 0;
+}
+
+int bus_process_events(void) { return 0; }
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef BUS_H
+#define BUS_H
+
+#include <stddef.h>
+
+#include "sys_dashboard.h"
+
+// Ergebnis einer Unit-Abfrage (ein GetAll pro Interface)
+struct unit_info {
+    char scope[16];          // "system", "user" oder "none"
+    char active[32];         // ActiveState
+    char enabled[32];        // UnitFileState
+    char load_state[32];     // LoadState
+    char sub_state[32];      // SubState
+    char desc[MAX_DESC];     // Description
+    long main_pid;           // MainPID (nur .service)
+    char cgroup[MAX_CGROUP]; // ControlGroup (nur .service)
+    char fragment[MAX_LINE]; // FragmentPath
+    char active_since[64];   // ActiveEnterTimestamp, lesbar; "" = nie aktiv
+};
+
+/* sd-bus Backend fuer org.freedesktop.systemd1.
+   Ohne HAVE_LIBSYSTEMD liefern alle Funktionen -1 und die Aufrufer
+   fallen auf systemctl (execute_argv) zurueck.
+   Fuer Tests gegen einen Mock-Bus: DBUS_SYSTEM_BUS_ADDRESS bzw.
+   DBUS_SESSION_BUS_ADDRESS auf den privaten Bus setzen.
+   Threadsicher ueber ein eigenes Lock. Signal-Handler nehmen darunter
+   data_lock(), deshalb nie mit gehaltenem data_lock() aufrufen. */
+int  bus_init(void);
+void bus_close(void);
+int  bus_available(void);
+int  bus_detect_scope(const char *svc, char *scope, size_t bufsize);
+int  bus_get_unit_info(const char *svc, struct unit_info *info);
+int  bus_get_unit_infos(const char **svcs, int count, struct unit_info *infos);
+
+// Alle Units eines Scopes (UNIT_SCOPE_SYSTEM/_USER) per catalog_add() eintragen
+int  bus_fill_catalog(int scope);
+
+// systemd-Signale -> gezielte Cache-Invalidierung
+#define BUS_MAX_FDS 2
+struct pollfd;
+int  bus_subscribe(void);
+int  bus_events_active(void);
+int  bus_fill_pollfds(struct pollfd *pfds, int max);
+int  bus_process_events(void);
+
+#endif
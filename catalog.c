@@ -0,0 +1,447 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <stdatomic.h>
+
+#include "catalog.h"
+#include "bus.h"
+#include "spawn.h"
+#include "strpool.h"
+
+static struct catalog_unit *units = NULL;
+static int num_units = 0;
+static int cap_units = 0;
+static unsigned catalog_gen = 1;            // zaehlt jede Aenderung
+static atomic_int stale = 0;
+
+/* Suchindex, nach jedem catalog_refresh() bzw. Delta neu aufgebaut: Namen klein
+   geschrieben (ein Block) und je Name die enthaltenen Zeichen als Bitmaske.
+   Eine Anfrage mit Zeichen, die der Name nicht hat, faellt ohne Vergleich raus. */
+static char *lower_text = NULL;
+static const char **lower_names = NULL;
+static uint64_t *name_masks = NULL;
+
+// Name -> Index + 1 (0 = frei), offene Adressierung, Zweierpotenz
+static int *index_tab = NULL;
+static size_t index_size = 0;
+
+static unsigned long hash_name(const char *s) {
+    unsigned long h = 2166136261UL;
+    for (; *s; s++) {
+        h ^= (unsigned char)*s;
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static int *index_slot(const char *name) {
+    size_t mask = index_size - 1;
+    for (size_t i = hash_name(name) & mask; ; i = (i + 1) & mask) {
+        if (index_tab[i] == 0 || strcmp(units[index_tab[i] - 1].name, name) == 0) {
+            return &index_tab[i];
+        }
+    }
+}
+
+static int index_rebuild(size_t min_entries) {
+    size_t size = index_size ? index_size : 1024;
+    while (size < min_entries * 2) size *= 2;
+    if (size != index_size) {
+        int *tab = realloc(index_tab, size * sizeof(*tab));
+        if (!tab) return -1;
+        index_tab = tab;
+        index_size = size;
+    }
+    memset(index_tab, 0, index_size * sizeof(*index_tab));
+    for (int i = 0; i < num_units; i++) *index_slot(units[i].name) = i + 1;
+    return 0;
+}
+
+static int is_service_name(const char *name) {
+    size_t len = strlen(name);
+    if (len <= 8 || strcmp(name + len - 8, ".service") != 0) return 0;
+    // Templates (foo@.service) lassen sich nicht starten; Instanzen kommen aus ListUnits
+    return name[len - 9] != '@';
+}
+
+struct catalog_unit *catalog_add(const char *name, int scope) {
+    if (!is_service_name(name)) return NULL;
+
+    if (index_size == 0 && index_rebuild(0) != 0) return NULL;
+    int *slot = index_slot(name);
+    if (*slot) {
+        struct catalog_unit *u = &units[*slot - 1];
+        return u->scope == scope ? u : NULL;
+    }
+
+    if (num_units == cap_units) {
+        int cap = cap_units ? cap_units * 2 : 512;
+        struct catalog_unit *p = realloc(units, (size_t)cap * sizeof(*p));
+        if (!p) return NULL;
+        units = p;
+        cap_units = cap;
+    }
+    const char *empty = str_intern("");
+    struct catalog_unit *u = &units[num_units++];
+    u->name = str_intern(name);
+    u->load = u->sub = u->desc = empty;
+    u->scope = (unsigned char)scope;
+    u->active = UNIT_ACTIVE_INACTIVE;
+    u->enabled = UNIT_ENABLED_NONE;
+    if (!u->name || !empty) {
+        num_units--;
+        return NULL;
+    }
+
+    if ((size_t)num_units * 2 > index_size) {
+        if (index_rebuild((size_t)num_units) != 0) {
+            num_units--;
+            return NULL;
+        }
+    } else {
+        *slot = num_units;
+    }
+    return u;
+}
+
+void catalog_set(const char **field, const char *value) {
+    const char *v = str_intern(value ? value : "");
+    if (v) *field = v;
+}
+
+// --------------------------------------------------
+// Fallback: systemctl, ein Aufruf pro Liste und Scope
+// --------------------------------------------------
+static char *run_systemctl(int scope, const char *verb) {
+    const char *argv[12];
+    int a = 0;
+    argv[a++] = "systemctl";
+    if (scope == UNIT_SCOPE_USER) argv[a++] = "--user";
+    argv[a++] = verb;
+    if (strcmp(verb, "list-units") == 0) argv[a++] = "--all";
+    argv[a++] = "--type=service";
+    argv[a++] = "--plain";
+    argv[a++] = "--no-legend";
+    argv[a++] = "--no-pager";
+    argv[a++] = "--full";
+    argv[a] = NULL;
+
+    char *out = NULL;
+    int ret = spawn_cmd(argv, SPAWN_CAPTURE | SPAWN_QUIET, CMD_TIMEOUT_MS, &out, NULL);
+    if (ret != 0) {
+        free(out);
+        return NULL;
+    }
+    return out;
+}
+
+// Naechstes durch Leerzeichen getrenntes Feld; *p steht danach dahinter
+static char *next_field(char **p) {
+    char *s = *p;
+    while (*s == ' ' || *s == '\t') s++;
+    if (!*s) return NULL;
+    char *end = s;
+    while (*end && *end != ' ' && *end != '\t') end++;
+    if (*end) *end++ = '\0';
+    *p = end;
+    return s;
+}
+
+/* list-units: UNIT LOAD ACTIVE SUB DESCRIPTION...
+   Aeltere Versionen setzen vor fehlgeschlagene Units ein "●" (bzw. "*"). */
+static int fill_units_systemctl(int scope) {
+    char *out = run_systemctl(scope, "list-units");
+    if (!out) return -1;
+
+    char *save = NULL;
+    for (char *line = strtok_r(out, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        char *p = line;
+        char *name = next_field(&p);
+        if (name && (strcmp(name, "●") == 0 || strcmp(name, "*") == 0)) name = next_field(&p);
+        char *load   = next_field(&p);
+        char *active = next_field(&p);
+        char *sub    = next_field(&p);
+        if (!name || !sub || strcmp(load, "not-found") == 0) continue;
+        while (*p == ' ' || *p == '\t') p++;
+
+        struct catalog_unit *u = catalog_add(name, scope);
+        if (!u) continue;
+        catalog_set(&u->load, load);
+        catalog_set(&u->sub, sub);
+        catalog_set(&u->desc, p);
+        u->active = (unsigned char)unit_active_parse(active);
+    }
+    free(out);
+    return 0;
+}
+
+// list-unit-files: UNIT STATE [PRESET]
+static int fill_unit_files_systemctl(int scope) {
+    char *out = run_systemctl(scope, "list-unit-files");
+    if (!out) return -1;
+
+    char *save = NULL;
+    for (char *line = strtok_r(out, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        char *p = line;
+        char *name  = next_field(&p);
+        char *state = next_field(&p);
+        if (!state) continue;
+
+        struct catalog_unit *u = catalog_add(name, scope);
+        if (!u) continue;
+        u->enabled = (unsigned char)unit_enabled_parse(state);
+    }
+    free(out);
+    return 0;
+}
+
+// --------------------------------------------------
+// Oeffentliche Funktionen
+// --------------------------------------------------
+static int cmp_unit_name(const void *a, const void *b) {
+    return strcmp(((const struct catalog_unit *)a)->name,
+                  ((const struct catalog_unit *)b)->name);
+}
+
+static uint64_t char_bit(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return 1ULL << (c - 'a');
+    if (c >= '0' && c <= '9') return 1ULL << (26 + c - '0');
+    return 1ULL << (36 + c % 28);
+}
+
+static int build_search_index(void) {
+    size_t total = 0;
+    for (int i = 0; i < num_units; i++) total += strlen(units[i].name) + 1;
+
+    char *text = realloc(lower_text, total ? total : 1);
+    if (!text) return -1;
+    lower_text = text;
+    const char **names = realloc(lower_names, (size_t)(num_units ? num_units : 1) * sizeof(*names));
+    if (!names) return -1;
+    lower_names = names;
+    uint64_t *masks = realloc(name_masks, (size_t)(num_units ? num_units : 1) * sizeof(*masks));
+    if (!masks) return -1;
+    name_masks = masks;
+
+    char *p = lower_text;
+    for (int i = 0; i < num_units; i++) {
+        uint64_t mask = 0;
+        lower_names[i] = p;
+        for (const char *c = units[i].name; *c; c++) {
+            *p = (char)tolower((unsigned char)*c);
+            mask |= char_bit((unsigned char)*p++);
+        }
+        *p++ = '\0';
+        name_masks[i] = mask;
+    }
+    return 0;
+}
+
+int catalog_refresh(void) {
+    static const int scopes[] = { UNIT_SCOPE_SYSTEM, UNIT_SCOPE_USER };
+
+    atomic_store(&stale, 0);
+    catalog_gen++;
+    num_units = 0;
+    if (index_size) memset(index_tab, 0, index_size * sizeof(*index_tab));
+
+    int ok = 0;
+    for (int s = 0; s < 2; s++) {
+        if (bus_fill_catalog(scopes[s]) == 0) {
+            ok = 1;
+            continue;
+        }
+        // list-units zuerst: geladene Units bringen Zustand und Beschreibung mit
+        if (fill_units_systemctl(scopes[s]) == 0) ok = 1;
+        if (fill_unit_files_systemctl(scopes[s]) == 0) ok = 1;
+    }
+
+    if (num_units > 1) qsort(units, (size_t)num_units, sizeof(*units), cmp_unit_name);
+    if (index_rebuild((size_t)num_units) != 0) return -1;
+    if (build_search_index() != 0) return -1;
+    return ok ? num_units : -1;
+}
+
+int catalog_count(void) {
+    return num_units;
+}
+
+void catalog_invalidate(void) {
+    atomic_store(&stale, 1);
+}
+
+int catalog_stale(void) {
+    return atomic_load(&stale);
+}
+
+// Erste Position in units[0..n), deren Name nicht kleiner als name ist
+static int lower_bound(int n, const char *name) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (strcmp(units[mid].name, name) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int catalog_file_event(const char *name, int scope, int present) {
+    const struct catalog_unit *known = catalog_find(name);
+
+    if (present) {
+        if (known) return 0;
+        struct catalog_unit *u = catalog_add(name, scope);
+        if (!u) return 0;
+        u->enabled = UNIT_ENABLED_UNKNOWN;   // liefert der Poller fuer sichtbare Zeilen nach
+
+        // Angehaengt -> an die sortierte Stelle schieben
+        struct catalog_unit added = *u;
+        int pos = lower_bound(num_units - 1, added.name);
+        memmove(&units[pos + 1], &units[pos], (size_t)(num_units - 1 - pos) * sizeof(*units));
+        units[pos] = added;
+    } else {
+        if (!known || known->scope != scope) return 0;
+        int idx = (int)(known - units);
+        if (units[idx].load[0] != '\0') {
+            // Bleibt bis zum naechsten daemon-reload geladen
+            units[idx].enabled = UNIT_ENABLED_NONE;
+            catalog_gen++;
+            return 1;
+        }
+        memmove(&units[idx], &units[idx + 1], (size_t)(num_units - idx - 1) * sizeof(*units));
+        num_units--;
+    }
+
+    // Nur im Speicher: Indizes verschieben sich ab pos, kein neues Einsammeln
+    catalog_gen++;
+    if (index_rebuild((size_t)num_units) != 0 || build_search_index() != 0) catalog_invalidate();
+    return 1;
+}
+
+const struct catalog_unit *catalog_get(int i) {
+    return (i >= 0 && i < num_units) ? &units[i] : NULL;
+}
+
+const struct catalog_unit *catalog_find(const char *name) {
+    if (num_units == 0) return NULL;
+    int idx = *index_slot(name);
+    return idx ? &units[idx - 1] : NULL;
+}
+
+// --------------------------------------------------
+// Unscharfe Suche
+// --------------------------------------------------
+static int is_word_start(const char *name, size_t pos) {
+    return pos == 0 || strchr("-_.@:", name[pos - 1]) != NULL;
+}
+
+/* Guete eines Namens fuer die Anfrage, -1 = kein Treffer.
+   Zusammenhaengend schlaegt verstreut; frueher und am Wortanfang besser. */
+static int fuzzy_score(const char *name, const char *q, int qlen) {
+    size_t nlen = strlen(name);
+    const char *sub = memmem(name, nlen, q, (size_t)qlen);
+    if (sub) {
+        size_t pos = (size_t)(sub - name);
+        return 1000 + (is_word_start(name, pos) ? 200 : 0) - (int)pos;
+    }
+
+    // Teilfolge, von links gierig
+    int score = 0;
+    long prev = -2;
+    const char *p = name;
+    for (int i = 0; i < qlen; i++) {
+        const char *hit = strchr(p, q[i]);
+        if (!hit) return -1;
+        long pos = hit - name;
+        score += 10;
+        if (pos == prev + 1) score += 15;
+        else if (is_word_start(name, (size_t)pos)) score += 8;
+        prev = pos;
+        p = hit + 1;
+    }
+    return score;
+}
+
+static int cmp_match(const void *a, const void *b) {
+    const struct catalog_match *x = a, *y = b;
+    if (x->score != y->score) return y->score - x->score;
+    return x->idx - y->idx;
+}
+
+// Stufe k (Anfrage query[0..k]) aus Stufe k-1 bzw. dem ganzen Katalog
+static int filter_level(struct catalog_filter *f, int k) {
+    int n_prev = k > 0 ? f->count[k - 1] : num_units;
+    if (f->cap[k] < n_prev || !f->level[k]) {
+        int cap = n_prev > 0 ? n_prev : 1;
+        struct catalog_match *m = realloc(f->level[k], (size_t)cap * sizeof(*m));
+        if (!m) return -1;
+        f->level[k] = m;
+        f->cap[k] = cap;
+    }
+
+    uint64_t qmask = 0;
+    for (int i = 0; i <= k; i++) qmask |= char_bit((unsigned char)f->query[i]);
+
+    const struct catalog_match *prev = k > 0 ? f->level[k - 1] : NULL;
+    struct catalog_match *out = f->level[k];
+    int n = 0;
+    for (int i = 0; i < n_prev; i++) {
+        int idx = prev ? prev[i].idx : i;
+        if (qmask & ~name_masks[idx]) continue;
+        int score = fuzzy_score(lower_names[idx], f->query, k + 1);
+        if (score < 0) continue;
+        out[n].idx = idx;
+        out[n].score = score;
+        n++;
+    }
+    qsort(out, (size_t)n, sizeof(*out), cmp_match);
+    f->count[k] = n;
+    return 0;
+}
+
+void catalog_filter_init(struct catalog_filter *f) {
+    memset(f, 0, sizeof(*f));
+}
+
+void catalog_filter_free(struct catalog_filter *f) {
+    for (int k = 0; k < CATALOG_QUERY_LEN; k++) free(f->level[k]);
+    memset(f, 0, sizeof(*f));
+}
+
+int catalog_filter_set(struct catalog_filter *f, const char *query) {
+    char q[CATALOG_QUERY_LEN];
+    int len = 0;
+    for (; query[len] && len < CATALOG_QUERY_LEN - 1; len++) {
+        q[len] = (char)tolower((unsigned char)query[len]);
+    }
+    q[len] = '\0';
+
+    // Stufen enthalten Katalogindizes, die nach einer Aenderung nicht mehr stimmen
+    if (f->gen != catalog_gen) {
+        f->gen = catalog_gen;
+        f->len = 0;
+    }
+
+    int common = 0;
+    while (common < len && common < f->len && q[common] == f->query[common]) common++;
+
+    memcpy(f->query, q, (size_t)len + 1);
+    f->len = common;
+    while (f->len < len) {
+        if (filter_level(f, f->len) != 0) break;
+        f->len++;
+    }
+    f->query[f->len] = '\0';
+    return catalog_filter_count(f);
+}
+
+int catalog_filter_count(const struct catalog_filter *f) {
+    return f->len > 0 ? f->count[f->len - 1] : num_units;
+}
+
+int catalog_filter_at(const struct catalog_filter *f, int i) {
+    return f->len > 0 ? f->level[f->len - 1][i].idx : i;
+}
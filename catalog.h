@@ -0,0 +1,78 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include "sys_dashboard.h"
+#include "unitstate.h"
+
+/* Eine Unit mit allem, was die Browse-Ansicht pro Zeile braucht.
+   Alle Texte aus dem String-Pool (strpool.h), nie NULL. */
+struct catalog_unit {
+    const char *name;
+    const char *load;        // LoadState, "" = nur Unit-Datei, nicht geladen
+    const char *sub;         // SubState
+    const char *desc;
+    unsigned char scope;     // UNIT_SCOPE_SYSTEM oder UNIT_SCOPE_USER
+    unsigned char active;    // enum unit_active
+    unsigned char enabled;   // enum unit_enabled, NONE = keine Unit-Datei
+};
+
+/* Alle .service-Units beider Scopes aus je einem Sammelaufruf pro Scope:
+   ListUnits + ListUnitFiles ueber sd-bus (bus.c), sonst
+   systemctl list-units --all bzw. list-unit-files.
+   Gibt es eine Unit in beiden Scopes, gewinnt system.
+   Nach catalog_refresh() nach Namen sortiert. Nur aus dem UI-Thread. */
+int  catalog_refresh(void);                 // Anzahl Units, -1 Fehler
+int  catalog_count(void);
+
+/* Nach daemon-reload/UnitFilesChanged (aus jedem Thread): der naechste
+   Aufruf von build_all_services_list() sammelt neu ein. */
+void catalog_invalidate(void);
+int  catalog_stale(void);
+
+/* Delta aus inotify (unitwatch.c): Unit-Datei name in einem Verzeichnis
+   des Scopes angelegt (present=1) bzw. keine Datei des Scopes mehr da
+   (present=0). Ungeladene Units verschwinden, geladene verlieren nur den
+   Datei-Zustand. Rueckgabe: 1 wenn sich der Katalog geaendert hat. */
+int  catalog_file_event(const char *name, int scope, int present);
+const struct catalog_unit *catalog_get(int i);
+const struct catalog_unit *catalog_find(const char *name);
+
+/* Fuer die Befueller: liefert den Eintrag zu name (neu angelegt oder
+   schon vorhanden). NULL, wenn die Unit schon aus dem anderen Scope
+   stammt oder kein Speicher da ist. Texte per catalog_set() setzen. */
+struct catalog_unit *catalog_add(const char *name, int scope);
+void catalog_set(const char **field, const char *value);
+
+/* Unscharfe Suche ueber die Unit-Namen: die Zeichen der Anfrage muessen in
+   dieser Reihenfolge im Namen vorkommen (Gross/klein egal), zusammenhaengende
+   Treffer und Wortanfaenge zaehlen mehr. Ergebnis nach Guete sortiert.
+   Pro Laenge der Anfrage bleibt das Ergebnis liegen: ein weiteres Zeichen
+   filtert nur die vorige Stufe, Backspace springt ohne Suche zurueck.
+   Aendert sich der Katalog, faengt der Filter beim naechsten Setzen neu an. */
+#define CATALOG_QUERY_LEN 64
+
+struct catalog_match {
+    int idx;                 // fuer catalog_get()
+    int score;
+};
+
+struct catalog_filter {
+    char query[CATALOG_QUERY_LEN];          // klein geschrieben
+    int len;
+    unsigned gen;                           // Katalog-Stand der Stufen
+    struct catalog_match *level[CATALOG_QUERY_LEN];   // level[k]: Treffer fuer query[0..k]
+    int count[CATALOG_QUERY_LEN];
+    int cap[CATALOG_QUERY_LEN];
+};
+
+void catalog_filter_init(struct catalog_filter *f);
+void catalog_filter_free(struct catalog_filter *f);
+
+// Setzt die Anfrage (gemeinsamer Anfang mit der vorigen wird wiederverwendet); Rueckgabe: Trefferzahl
+int  catalog_filter_set(struct catalog_filter *f, const char *query);
+
+// i-ter Treffer als Katalogindex; bei leerer Anfrage einfach i
+int  catalog_filter_count(const struct catalog_filter *f);
+int  catalog_filter_at(const struct catalog_filter *f, int i);
+
+#endif
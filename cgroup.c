@@ -0,0 +1,254 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include "cgroup.h"
+
+// --------------------------------------------------
+// Pfad aufloesen
+// --------------------------------------------------
+int cgroup_resolve(const char *cgroup, char *dir, size_t dirsize) {
+    if (!cgroup || cgroup[0] != '/') return -1;
+
+    static const struct {
+        const char *root;
+        int kind;
+    } roots[] = {
+        { CGROUP_ROOT,             CGROUP_UNIFIED },
+        { CGROUP_ROOT "/unified",  CGROUP_UNIFIED },
+        { CGROUP_ROOT "/systemd",  CGROUP_LEGACY  },
+    };
+
+    for (size_t i = 0; i < sizeof(roots) / sizeof(roots[0]); i++) {
+        char probe[PATH_MAX];
+        // Reines v2 erkennt man an cgroup.controllers in der Wurzel
+        if (i == 0) {
+            snprintf(probe, sizeof(probe), "%s/cgroup.controllers", roots[i].root);
+            if (access(probe, F_OK) != 0) continue;
+        }
+        snprintf(probe, sizeof(probe), "%s%s/cgroup.procs", roots[i].root, cgroup);
+        if (access(probe, R_OK) == 0) {
+            snprintf(dir, dirsize, "%s%s", roots[i].root, cgroup);
+            return roots[i].kind;
+        }
+    }
+    return -1;
+}
+
+// --------------------------------------------------
+// PIDs einsammeln (rekursiv)
+// --------------------------------------------------
+static int walk(const char *dir, int depth, cgroup_pid_fn fn, void *arg) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/cgroup.procs", dir);
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    long pid;
+    while (fscanf(fp, "%ld", &pid) == 1) {
+        fn(pid, arg);
+    }
+    fclose(fp);
+
+    if (depth >= CGROUP_MAX_DEPTH) return 0;
+
+    DIR *d = opendir(dir);
+    if (!d) return 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        walk(path, depth + 1, fn, arg);
+    }
+    closedir(d);
+    return 0;
+}
+
+int cgroup_walk_pids(const char *dir, cgroup_pid_fn fn, void *arg) {
+    if (!dir || !fn) return -1;
+    return walk(dir, 0, fn, arg);
+}
+
+// --------------------------------------------------
+// v2-Statistik: Dateien offen halten, per pread neu lesen
+// --------------------------------------------------
+#define CG_READ_BUF 8192   // memory.stat ~2 KB, io.stat je Geraet eine Zeile
+
+static const char *const cg_file_names[CG_NFILES] = {
+    [CG_CPU_STAT]        = "cpu.stat",
+    [CG_MEMORY_CURRENT]  = "memory.current",
+    [CG_MEMORY_STAT]     = "memory.stat",
+    [CG_IO_STAT]         = "io.stat",
+    [CG_PIDS_CURRENT]    = "pids.current",
+    [CG_CPU_PRESSURE]    = "cpu.pressure",
+    [CG_MEMORY_PRESSURE] = "memory.pressure",
+    [CG_IO_PRESSURE]     = "io.pressure",
+};
+
+void cgroup_handle_init(struct cgroup_handle *h) {
+    h->cgroup[0] = '\0';
+    h->kind = -1;
+    for (int i = 0; i < CG_NFILES; i++) h->fds[i] = -1;
+}
+
+void cgroup_close(struct cgroup_handle *h) {
+    for (int i = 0; i < CG_NFILES; i++) {
+        if (h->fds[i] >= 0) close(h->fds[i]);
+        h->fds[i] = -1;
+    }
+    h->kind = -1;
+}
+
+/* Loest das Verzeichnis auf und oeffnet alle vorhandenen Dateien.
+   Nicht aktivierte Controller (z.B. io) bleiben -1.
+   Rueckgabe: 0, oder -1 wenn keine v2-Cgroup existiert (Unit gestoppt, v1) */
+int cgroup_open(struct cgroup_handle *h, const char *cgroup) {
+    cgroup_close(h);
+    if (cgroup != h->cgroup) snprintf(h->cgroup, sizeof(h->cgroup), "%s", cgroup ? cgroup : "");
+
+    char dir[PATH_MAX];
+    int kind = cgroup_resolve(h->cgroup, dir, sizeof(dir));
+    if (kind != CGROUP_UNIFIED) return -1;
+
+    int dfd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd < 0) return -1;
+    for (int i = 0; i < CG_NFILES; i++) {
+        h->fds[i] = openat(dfd, cg_file_names[i], O_RDONLY | O_CLOEXEC);
+    }
+    close(dfd);
+
+    if (h->fds[CG_CPU_STAT] < 0) {
+        cgroup_close(h);
+        return -1;
+    }
+    h->kind = kind;
+    return 0;
+}
+
+// Handgeschriebene Parser, arbeiten direkt auf dem pread-Puffer
+static const char *parse_u64(const char *p, unsigned long long *v) {
+    unsigned long long x = 0;
+    while (*p >= '0' && *p <= '9') x = x * 10 + (unsigned long long)(*p++ - '0');
+    *v = x;
+    return p;
+}
+
+// "12.34" -> 12.34 (PSI hat immer zwei Nachkommastellen)
+static double parse_fixed(const char *p) {
+    unsigned long long ip, fp = 0;
+    p = parse_u64(p, &ip);
+    double frac = 0.0;
+    if (*p == '.') {
+        const char *start = ++p;
+        p = parse_u64(p, &fp);
+        frac = (double)fp;
+        for (; start < p; start++) frac /= 10.0;
+    }
+    return (double)ip + frac;
+}
+
+static const char *next_line(const char *p) {
+    while (*p && *p != '\n') p++;
+    return *p ? p + 1 : p;
+}
+
+static int starts_with(const char *p, const char *key, size_t keylen) {
+    return strncmp(p, key, keylen) == 0;
+}
+
+#define KEY(p, lit) starts_with((p), lit, sizeof(lit) - 1)
+#define AFTER(p, lit) ((p) + sizeof(lit) - 1)
+
+// "usage_usec N\nuser_usec N\nsystem_usec N\n..."
+static void parse_cpu_stat(const char *p, struct cgroup_stats *st) {
+    for (; *p; p = next_line(p)) {
+        if (KEY(p, "usage_usec "))       parse_u64(AFTER(p, "usage_usec "), &st->cpu_usage_usec);
+        else if (KEY(p, "user_usec "))   parse_u64(AFTER(p, "user_usec "), &st->cpu_user_usec);
+        else if (KEY(p, "system_usec ")) parse_u64(AFTER(p, "system_usec "), &st->cpu_system_usec);
+    }
+}
+
+static void parse_memory_stat(const char *p, struct cgroup_stats *st) {
+    for (; *p; p = next_line(p)) {
+        if (KEY(p, "anon "))      parse_u64(AFTER(p, "anon "), &st->memory_anon);
+        else if (KEY(p, "file ")) parse_u64(AFTER(p, "file "), &st->memory_file);
+    }
+}
+
+// "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0" je Geraet
+static void parse_io_stat(const char *p, struct cgroup_stats *st) {
+    st->io_rbytes = st->io_wbytes = 0;
+    while (*p) {
+        unsigned long long v;
+        if (KEY(p, "rbytes=")) {
+            p = parse_u64(AFTER(p, "rbytes="), &v);
+            st->io_rbytes += v;
+        } else if (KEY(p, "wbytes=")) {
+            p = parse_u64(AFTER(p, "wbytes="), &v);
+            st->io_wbytes += v;
+        } else {
+            p++;
+        }
+    }
+}
+
+// "some avg10=0.12 avg60=... total=N\nfull ..."
+static double parse_pressure(const char *p) {
+    if (KEY(p, "some avg10=")) return parse_fixed(AFTER(p, "some avg10="));
+    return 0.0;
+}
+
+/* pread in den festen Puffer. Rueckgabe: Laenge, -1 = Fehler,
+   -2 = Cgroup wurde entfernt (ENODEV) */
+static int pread_file(int fd, char *buf, size_t size) {
+    ssize_t n = pread(fd, buf, size - 1, 0);
+    if (n < 0) return errno == ENODEV ? -2 : -1;
+    buf[n] = '\0';
+    return (int)n;
+}
+
+static int read_all_files(struct cgroup_handle *h, struct cgroup_stats *st) {
+    char buf[CG_READ_BUF];
+    memset(st, 0, sizeof(*st));
+
+    for (int i = 0; i < CG_NFILES; i++) {
+        if (h->fds[i] < 0) continue;
+        int n = pread_file(h->fds[i], buf, sizeof(buf));
+        if (n == -2) return -2;
+        if (n < 0) continue;
+
+        unsigned long long v;
+        switch (i) {
+        case CG_CPU_STAT:        parse_cpu_stat(buf, st); break;
+        case CG_MEMORY_CURRENT:  parse_u64(buf, &v); st->memory_current = v; break;
+        case CG_MEMORY_STAT:     parse_memory_stat(buf, st); break;
+        case CG_IO_STAT:         parse_io_stat(buf, st); break;
+        case CG_PIDS_CURRENT:    parse_u64(buf, &v); st->pids_current = v; break;
+        case CG_CPU_PRESSURE:    st->cpu_some_avg10 = parse_pressure(buf); break;
+        case CG_MEMORY_PRESSURE: st->memory_some_avg10 = parse_pressure(buf); break;
+        case CG_IO_PRESSURE:     st->io_some_avg10 = parse_pressure(buf); break;
+        }
+        st->valid |= 1u << i;
+    }
+    return 0;
+}
+
+/* Rueckgabe: 0 wenn mindestens cpu.stat gelesen wurde, sonst -1 */
+int cgroup_read(struct cgroup_handle *h, struct cgroup_stats *st) {
+    if (h->kind < 0) return -1;
+
+    int r = read_all_files(h, st);
+    if (r == -2) {
+        // Unit neu gestartet: Verzeichnis ist neu, alte fds sind tot
+        if (cgroup_open(h, h->cgroup) != 0) return -1;
+        r = read_all_files(h, st);
+    }
+    if (r != 0 || !(st->valid & (1u << CG_CPU_STAT))) return -1;
+    return 0;
+}
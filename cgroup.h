@@ -0,0 +1,71 @@
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include <stddef.h>
+
+#define CGROUP_ROOT      "/sys/fs/cgroup"
+#define CGROUP_MAX_DEPTH 8
+#define CGROUP_NAME_LEN  512
+
+// Rueckgabe von cgroup_resolve()
+#define CGROUP_UNIFIED 2   // v2-Hierarchie: cpu.stat, memory.current, ...
+#define CGROUP_LEGACY  1   // nur systemd-v1-Hierarchie: nur cgroup.procs
+
+/* ControlGroup einer Unit ("/system.slice/foo.service") -> Verzeichnis.
+   Probiert reines v2, dann hybrid (unified, systemd).
+   Rueckgabe: CGROUP_UNIFIED/CGROUP_LEGACY oder -1 */
+int cgroup_resolve(const char *cgroup, char *dir, size_t dirsize);
+
+/* Ruft fn fuer jede PID in cgroup.procs von dir und allen Unter-Cgroups auf.
+   Rueckgabe: 0, oder -1 wenn dir/cgroup.procs nicht lesbar ist */
+typedef void (*cgroup_pid_fn)(long pid, void *arg);
+int cgroup_walk_pids(const char *dir, cgroup_pid_fn fn, void *arg);
+
+// --------------------------------------------------
+// v2-Statistik mit offen gehaltenen Dateien
+// --------------------------------------------------
+enum cgroup_file {
+    CG_CPU_STAT,
+    CG_MEMORY_CURRENT,
+    CG_MEMORY_STAT,
+    CG_IO_STAT,
+    CG_PIDS_CURRENT,
+    CG_CPU_PRESSURE,
+    CG_MEMORY_PRESSURE,
+    CG_IO_PRESSURE,
+    CG_NFILES
+};
+
+// Ein Satz Zaehler; valid hat ein Bit (1 << cgroup_file) je gelesener Datei
+struct cgroup_stats {
+    unsigned valid;
+    unsigned long long cpu_usage_usec;
+    unsigned long long cpu_user_usec;
+    unsigned long long cpu_system_usec;
+    unsigned long long memory_current;     // Bytes
+    unsigned long long memory_anon;        // memory.stat anon
+    unsigned long long memory_file;        // memory.stat file
+    unsigned long long io_rbytes;          // Summe ueber alle Geraete
+    unsigned long long io_wbytes;
+    unsigned long long pids_current;
+    double cpu_some_avg10;                 // PSI in %
+    double memory_some_avg10;
+    double io_some_avg10;
+};
+
+/* Verzeichnis wird einmal aufgeloest, die Dateien bleiben offen und
+   werden per pread() neu gelesen: im Normalbetrieb weder open/close
+   noch malloc. Nur wenn die Cgroup neu angelegt wurde (Unit-Neustart,
+   pread liefert ENODEV) wird einmal neu geoeffnet. */
+struct cgroup_handle {
+    char cgroup[CGROUP_NAME_LEN];   // ControlGroup der Unit
+    int kind;                       // cgroup_resolve(), -1 = nicht geoeffnet
+    int fds[CG_NFILES];             // -1 = nicht vorhanden
+};
+
+void cgroup_handle_init(struct cgroup_handle *h);
+int  cgroup_open(struct cgroup_handle *h, const char *cgroup);
+int  cgroup_read(struct cgroup_handle *h, struct cgroup_stats *st);
+void cgroup_close(struct cgroup_handle *h);
+
+#endif
@@ -0,0 +1,502 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "daemon.h"
+#include "wire.h"
+#include "remote.h"
+#include "poller.h"
+#include "bus.h"
+#include "strpool.h"
+
+// Was ein Client zuletzt bekommen hat (parallel zu seinem Abo)
+struct sent_row {
+    int valid;
+    struct unit_state state;
+    struct unit_usage usage;
+    int hist_valid;
+    int hist_count;
+    unsigned long hist_seq;
+};
+
+struct client {
+    int fd;
+    uint32_t sub_id;
+    const char **names;        // String-Pool
+    int count;
+    int nfav;
+    const char **keep;         // Favoriten ausserhalb des Ausschnitts: nur Verlauf
+    int nkeep;
+    struct sent_row *sent;
+    struct wire_buf in;
+    struct wire_buf out;
+};
+
+static struct client clients[DAEMON_MAX_CLIENTS];
+static int num_clients = 0;
+static volatile sig_atomic_t stop_requested = 0;
+
+// Vereinigung aller Abos, nach Zeiger sortiert; jede Unit einmal
+static const char **all_names = NULL;
+static unsigned char *all_fav = NULL;
+static struct unit_state *all_states = NULL;
+static struct unit_usage *all_usage = NULL;
+static struct unit_history *all_hist = NULL;
+static unsigned char *all_has_hist = NULL;
+static int all_count = 0;
+static int all_cap = 0;
+static const char **prev_names = NULL;   // Vereinigung vor dem letzten union_build()
+static int prev_cap = 0;
+static long long keep_ms = -1;           // letzte Probe der keep-Namen
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void stop_handler(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+// --------------------------------------------------
+// Clients
+// --------------------------------------------------
+static void client_drop(int idx) {
+    struct client *c = &clients[idx];
+    close(c->fd);
+    free(c->names);
+    free(c->keep);
+    free(c->sent);
+    wire_buf_free(&c->in);
+    wire_buf_free(&c->out);
+    clients[idx] = clients[--num_clients];
+    memset(&clients[num_clients], 0, sizeof(clients[num_clients]));
+}
+
+// Rueckgabe: 1 = Abo geaendert, 0 = nichts, -1 = Protokollfehler
+static int client_subscribe(struct client *c, struct wire_reader *r) {
+    uint32_t sub_id = wire_get_u32(r);
+    int count = (int)wire_get_u16(r);
+    int nfav = (int)wire_get_u16(r);
+    if (r->err || count > WIRE_MAX_NAMES || nfav > count) return -1;
+    if (nfav > DAEMON_MAX_FAVORITES) nfav = DAEMON_MAX_FAVORITES;
+
+    const char **names = malloc((size_t)(count ? count : 1) * sizeof(*names));
+    struct sent_row *sent = calloc((size_t)(count ? count : 1), sizeof(*sent));
+    const char **keep = NULL;
+    if (!names || !sent) goto fail;
+    for (int i = 0; i < count; i++) {
+        names[i] = wire_get_str(r);
+        if (!names[i]) goto fail;
+    }
+
+    // keep zaehlt mit gegen DAEMON_MAX_FAVORITES, der Rest wird nur gelesen
+    int nkeep = (int)wire_get_u16(r);
+    if (r->err || nkeep > WIRE_MAX_NAMES) goto fail;
+    keep = malloc((size_t)(nkeep ? nkeep : 1) * sizeof(*keep));
+    if (!keep) goto fail;
+    int k = 0;
+    for (int i = 0; i < nkeep; i++) {
+        const char *name = wire_get_str(r);
+        if (!name) goto fail;
+        if (nfav + k < DAEMON_MAX_FAVORITES) keep[k++] = name;
+    }
+
+    // Neues Abo = neuer Snapshot: sent ist leer, alles geht einmal raus
+    free(c->names);
+    free(c->keep);
+    free(c->sent);
+    c->names = names;
+    c->keep = keep;
+    c->sent = sent;
+    c->count = count;
+    c->nfav = nfav;
+    c->nkeep = k;
+    c->sub_id = sub_id;
+    return 1;
+
+fail:
+    free(names);
+    free(keep);
+    free(sent);
+    return -1;
+}
+
+static int client_read(struct client *c) {
+    if (wire_fill(c->fd, &c->in) < 0) return -1;
+
+    struct wire_hdr hdr;
+    struct wire_reader body;
+    size_t pos = 0;
+    int changed = 0;
+    int ret;
+    while ((ret = wire_next(&c->in, &pos, &hdr, &body)) > 0) {
+        if (hdr.type != WIRE_SUBSCRIBE) continue;
+        int r = client_subscribe(c, &body);
+        if (r < 0) return -1;
+        changed |= r;
+    }
+    if (ret < 0) return -1;
+    wire_consume(&c->in, pos);
+    return changed;
+}
+
+// --------------------------------------------------
+// Sammeln
+// --------------------------------------------------
+static int cmp_ptr(const void *a, const void *b) {
+    const char *x = *(const char *const *)a;
+    const char *y = *(const char *const *)b;
+    return (x > y) - (x < y);
+}
+
+static int union_reserve(int count) {
+    if (count <= all_cap) return 0;
+    int cap = all_cap ? all_cap : 64;
+    while (cap < count) cap *= 2;
+
+    void *p;
+    if (!(p = realloc(all_names, (size_t)cap * sizeof(*all_names)))) return -1;
+    all_names = p;
+    if (!(p = realloc(all_fav, (size_t)cap))) return -1;
+    all_fav = p;
+    if (!(p = realloc(all_states, (size_t)cap * sizeof(*all_states)))) return -1;
+    all_states = p;
+    if (!(p = realloc(all_usage, (size_t)cap * sizeof(*all_usage)))) return -1;
+    all_usage = p;
+    if (!(p = realloc(all_hist, (size_t)cap * sizeof(*all_hist)))) return -1;
+    all_hist = p;
+    if (!(p = realloc(all_has_hist, (size_t)cap))) return -1;
+    all_has_hist = p;
+    all_cap = cap;
+    return 0;
+}
+
+static int union_find(const char *name) {
+    int lo = 0, hi = all_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (all_names[mid] < name) lo = mid + 1;
+        else hi = mid;
+    }
+    return (lo < all_count && all_names[lo] == name) ? lo : -1;
+}
+
+/* Alle Abos zu einer Liste: sortieren, Doppelte zusammenlegen.
+   Eine Unit braucht CPU/Verlauf, sobald ein Client sie als Favorit zeigt
+   (all_fav 1); nur in einer keep-Liste reicht der Verlaufstakt (all_fav 2).
+   Was kein Abo mehr enthaelt, gibt stats sofort frei, nicht erst nach
+   STATS_EXPIRE_MS: sonst haelt ein Client mit wechselnden Listen fds offen. */
+static void union_build(void) {
+    int total = 0;
+    for (int i = 0; i < num_clients; i++) total += clients[i].count + clients[i].nkeep;
+    if (union_reserve(total) != 0) return;
+
+    int prev = all_count;
+    if (prev > prev_cap) {
+        const char **p = realloc(prev_names, (size_t)prev * sizeof(*p));
+        if (p) {
+            prev_names = p;
+            prev_cap = prev;
+        } else {
+            prev = 0;   // stats_expire() raeumt dann spaeter auf
+        }
+    }
+    if (prev > 0) memcpy(prev_names, all_names, (size_t)prev * sizeof(*prev_names));
+
+    int n = 0;
+    for (int i = 0; i < num_clients; i++) {
+        for (int k = 0; k < clients[i].count; k++) all_names[n++] = clients[i].names[k];
+        for (int k = 0; k < clients[i].nkeep; k++) all_names[n++] = clients[i].keep[k];
+    }
+    qsort(all_names, (size_t)n, sizeof(*all_names), cmp_ptr);
+    int u = 0;
+    for (int i = 0; i < n; i++) {
+        if (u == 0 || all_names[u - 1] != all_names[i]) all_names[u++] = all_names[i];
+    }
+    all_count = u;
+
+    memset(all_fav, 0, (size_t)all_count);
+    for (int i = 0; i < num_clients; i++) {
+        for (int k = 0; k < clients[i].nfav; k++) {
+            int j = union_find(clients[i].names[k]);
+            if (j >= 0) all_fav[j] = 1;
+        }
+    }
+    for (int i = 0; i < num_clients; i++) {
+        for (int k = 0; k < clients[i].nkeep; k++) {
+            int j = union_find(clients[i].keep[k]);
+            if (j >= 0 && !all_fav[j]) all_fav[j] = 2;
+        }
+    }
+
+    data_lock();
+    for (int i = 0; i < prev; i++) {
+        if (union_find(prev_names[i]) < 0) stats_forget(prev_names[i]);
+    }
+    data_unlock();
+}
+
+/* Ein Durchgang fuer alle Clients zusammen. Abgetastet wird nur im Takt
+   (sample): nach Signalen oder neuen Abos nur Zustaende nachholen und die
+   letzte Probe nehmen, sonst liefe CPU% ueber Bruchteile einer Sekunde. */
+static void collect(int sample) {
+    if (all_count == 0) return;
+
+    fetch_unit_states(all_names, all_count, all_states);
+
+    int keep_due = 0;
+    if (sample) {
+        data_lock();
+        stats_expire();
+        data_unlock();
+
+        long long now = now_ms();
+        if (keep_ms < 0 || now - keep_ms >= history_interval_ms()) {
+            keep_ms = now;
+            keep_due = 1;
+        }
+    }
+    for (int i = 0; i < all_count; i++) {
+        all_usage[i] = (struct unit_usage)UNIT_USAGE_UNKNOWN;
+        all_has_hist[i] = 0;
+        if (!all_fav[i]) continue;
+        if (all_fav[i] == 2) {
+            // Wie sample_hidden_favorites() im Poller: eine Probe je Verlaufstakt
+            if (keep_due) {
+                data_lock();
+                stats_sample(all_names[i], NULL);
+                data_unlock();
+            }
+            continue;
+        }
+        data_lock();
+        if (sample) stats_sample(all_names[i], &all_usage[i]);
+        else stats_last(all_names[i], &all_usage[i]);
+        all_has_hist[i] = (stats_history(all_names[i], &all_hist[i]) == 0);
+        data_unlock();
+    }
+}
+
+// --------------------------------------------------
+// Verteilen
+// --------------------------------------------------
+static int state_equal(const struct unit_state *a, const struct unit_state *b) {
+    return a->scope == b->scope && a->active == b->active && a->enabled == b->enabled &&
+           a->desc == b->desc && memcmp(&a->ports, &b->ports, sizeof(a->ports)) == 0;
+}
+
+static int usage_equal(const struct unit_usage *a, const struct unit_usage *b) {
+    return a->cpu_pct == b->cpu_pct && a->rss_kb == b->rss_kb && a->tasks == b->tasks &&
+           a->io_kbps == b->io_kbps && a->psi_cpu == b->psi_cpu &&
+           a->psi_memory == b->psi_memory && a->psi_io == b->psi_io;
+}
+
+/* Haengt ein WIRE_UPDATE mit allen Zeilen an, die sich fuer diesen Client
+   seit dem letzten Senden geaendert haben. Rueckgabe: -1 = Client zu langsam */
+static int client_update(struct client *c) {
+    struct wire_buf *out = &c->out;
+    size_t start = wire_begin(out, WIRE_UPDATE);
+    wire_put_u32(out, c->sub_id);
+    size_t nrows_at = out->len;
+    wire_put_u16(out, 0);
+
+    int nrows = 0;
+    for (int i = 0; i < c->count; i++) {
+        int j = union_find(c->names[i]);
+        if (j < 0) continue;
+        struct sent_row *s = &c->sent[i];
+        int fav = (i < c->nfav);
+
+        int flags = 0;
+        if (!s->valid || !state_equal(&s->state, &all_states[j])) flags |= WIRE_ROW_STATE;
+        if (fav && (!s->valid || !usage_equal(&s->usage, &all_usage[j]))) flags |= WIRE_ROW_USAGE;
+        if (fav && all_has_hist[j]) {
+            flags |= wire_hist_delta(&all_hist[j], s->hist_valid, s->hist_count, s->hist_seq, NULL);
+        }
+        if (!flags) continue;
+
+        wire_put_u16(out, (unsigned)i);
+        wire_put_u8(out, (unsigned)flags);
+        if (flags & WIRE_ROW_STATE) wire_put_state(out, &all_states[j]);
+        if (flags & WIRE_ROW_USAGE) wire_put_usage(out, &all_usage[j]);
+        if (flags & WIRE_ROW_HIST) {
+            wire_hist_delta(&all_hist[j], s->hist_valid, s->hist_count, s->hist_seq, out);
+            s->hist_valid = 1;
+            s->hist_count = all_hist[j].count;
+            s->hist_seq = all_hist[j].seq;
+        }
+        s->valid = 1;
+        s->state = all_states[j];
+        s->usage = all_usage[j];
+        nrows++;
+    }
+
+    if (nrows == 0) {
+        out->len = start;   // nichts Neues: nichts schicken
+    } else {
+        wire_patch_u16(out, nrows_at, (unsigned)nrows);
+        wire_end(out, start);
+    }
+    if (out->err) return -1;
+    if (wire_flush(c->fd, out) < 0) return -1;
+    return out->len > WIRE_MAX_MSG ? -1 : 0;
+}
+
+// --------------------------------------------------
+// Socket
+// --------------------------------------------------
+static int listen_on(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        if (errno != EADDRINUSE) goto fail;
+        // Liegengebliebene Datei eines abgestuerzten Daemons? Dann niemand am anderen Ende
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int alive = (probe >= 0 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+        if (probe >= 0) close(probe);
+        if (alive) {
+            fprintf(stderr, "sysdash: auf %s laeuft schon ein Daemon\n", path);
+            close(fd);
+            return -1;
+        }
+        unlink(path);
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) goto fail;
+    }
+
+    // Nur fuer den eigenen Benutzer: Clients anderer uids verbinden sich nicht (remote.c)
+    chmod(path, 0600);
+    if (listen(fd, 16) != 0) {
+        fprintf(stderr, "sysdash: %s: %s\n", path, strerror(errno));
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+    return fd;
+
+fail:
+    fprintf(stderr, "sysdash: %s: %s\n", path, strerror(errno));
+    close(fd);
+    return -1;
+}
+
+static void accept_clients(int lfd) {
+    int fd;
+    while ((fd = accept4(lfd, NULL, NULL, SOCK_CLOEXEC)) >= 0) {
+        if (num_clients >= DAEMON_MAX_CLIENTS) {
+            close(fd);
+            continue;
+        }
+        memset(&clients[num_clients], 0, sizeof(clients[num_clients]));
+        clients[num_clients].fd = fd;
+        num_clients++;
+    }
+}
+
+// --------------------------------------------------
+// Hauptschleife
+// --------------------------------------------------
+int daemon_run(void) {
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    if (remote_socket_path(path, sizeof(path)) != 0) {
+        fprintf(stderr, "sysdash: kein Socket-Pfad (%s oder XDG_RUNTIME_DIR setzen)\n", WIRE_SOCKET_ENV);
+        return 1;
+    }
+    int lfd = listen_on(path);
+    if (lfd < 0) return 1;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stop_handler;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, "sysdash: Daemon lauscht auf %s\n", path);
+
+    long long next_tick = now_ms() + DAEMON_INTERVAL_MS;
+    while (!stop_requested) {
+        struct pollfd pfds[1 + BUS_MAX_FDS + DAEMON_MAX_CLIENTS];
+        int n = 0;
+        pfds[n].fd = lfd;
+        pfds[n++].events = POLLIN;
+
+        n += bus_fill_pollfds(pfds + n, BUS_MAX_FDS);
+
+        int first_client = n;
+        for (int i = 0; i < num_clients; i++) {
+            pfds[n].fd = clients[i].fd;
+            pfds[n].events = POLLIN | (clients[i].out.len > 0 ? POLLOUT : 0);
+            pfds[n++].revents = 0;
+        }
+        for (int i = 0; i < first_client; i++) pfds[i].revents = 0;
+
+        long long now = now_ms();
+        int timeout = next_tick > now ? (int)(next_tick - now) : 0;
+        if (poll(pfds, (nfds_t)n, timeout) < 0 && errno != EINTR) break;
+
+        int dirty = 0;
+        int resubscribed = 0;
+        int sample = 0;
+
+        // Signale invalidieren nur den Cache; fetch_unit_states() holt die betroffenen
+        if (bus_process_events() > 0) dirty = 1;
+
+        // Rueckwaerts, weil client_drop() den letzten Client nachrueckt
+        for (int i = num_clients - 1; i >= 0; i--) {
+            short rev = pfds[first_client + i].revents;
+            if (!rev) continue;
+            int r = 0;
+            if (rev & (POLLIN | POLLHUP | POLLERR)) r = client_read(&clients[i]);
+            if (r >= 0 && (rev & POLLOUT)) r = wire_flush(clients[i].fd, &clients[i].out) < 0 ? -1 : r;
+            if (r < 0) {
+                client_drop(i);
+                resubscribed = 1;
+            } else if (r > 0) {
+                resubscribed = 1;
+            }
+        }
+        if (pfds[0].revents & POLLIN) accept_clients(lfd);
+
+        now = now_ms();
+        if (now >= next_tick) {
+            sample = 1;
+            next_tick = now + DAEMON_INTERVAL_MS;
+        }
+        if (resubscribed) union_build();
+        if (!dirty && !resubscribed && !sample) continue;
+
+        collect(sample);
+        int dropped = 0;
+        for (int i = num_clients - 1; i >= 0; i--) {
+            if (clients[i].count > 0 && client_update(&clients[i]) < 0) {
+                client_drop(i);
+                dropped = 1;
+            }
+        }
+        if (dropped) union_build();
+    }
+
+    while (num_clients > 0) client_drop(num_clients - 1);
+    close(lfd);
+    unlink(path);
+    return 0;
+}
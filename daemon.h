@@ -0,0 +1,14 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+/* "sysdash --daemon": sammelt fuer alle Clients gemeinsam und verteilt
+   Snapshot + Deltas ueber einen Unix-Socket (wire.h). Pro Takt wird jede
+   abonnierte Unit genau einmal abgefragt, egal wie viele Clients sie zeigen.
+   Laeuft im Vordergrund bis SIGTERM/SIGINT. Rueckgabe: Exit-Status */
+#define DAEMON_INTERVAL_MS  1000   // wie der Poller-Takt
+#define DAEMON_MAX_CLIENTS  64
+#define DAEMON_MAX_FAVORITES 256  // je Client mit CPU/Verlauf (samt keep), der Rest nur Zustand
+
+int daemon_run(void);
+
+#endif
@@ -0,0 +1,203 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+
+#include "evloop.h"
+
+// Kennungen in epoll_event.data.u32
+#define TAG_KEY    0
+#define TAG_SIGNAL 1
+#define TAG_DATA   2
+#define TAG_TIMER  16   // + Timer-Nummer
+
+static int epfd = -1;
+static int sigfd = -1;
+static int data_fds[EV_MAX_FDS];
+static int num_data_fds = 0;
+static int extra_fd_cur = -1;
+static int timer_fds[EV_MAX_TIMERS];
+static int timer_fired[EV_MAX_TIMERS];
+static int num_timers = 0;
+static int quit_seen = 0;
+
+static int epoll_add(int fd, uint32_t tag) {
+    if (epfd < 0) return 0;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = tag;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == 0 || errno == EEXIST) return 0;
+    return -1;
+}
+
+int ev_init(void) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGWINCH);
+    sigaddset(&set, SIGTERM);
+    // Kinder bekommen in spawn_cmd() wieder eine leere Maske
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+    sigfd = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_add(STDIN_FILENO, TAG_KEY);
+    if (sigfd >= 0) epoll_add(sigfd, TAG_SIGNAL);
+    return epfd >= 0 ? 0 : -1;
+}
+
+void ev_close(void) {
+    for (int i = 0; i < num_timers; i++) {
+        if (timer_fds[i] >= 0) close(timer_fds[i]);
+    }
+    num_timers = 0;
+    num_data_fds = 0;
+    extra_fd_cur = -1;
+    if (sigfd >= 0) { close(sigfd); sigfd = -1; }
+    if (epfd >= 0)  { close(epfd);  epfd = -1; }
+}
+
+int ev_add_fd(int fd) {
+    if (fd < 0 || num_data_fds >= EV_MAX_FDS) return -1;
+    for (int i = 0; i < num_data_fds; i++) {
+        if (data_fds[i] == fd) return 0;
+    }
+    if (epoll_add(fd, TAG_DATA) != 0) return -1;
+    data_fds[num_data_fds++] = fd;
+    return 0;
+}
+
+void ev_del_fd(int fd) {
+    for (int i = 0; i < num_data_fds; i++) {
+        if (data_fds[i] != fd) continue;
+        data_fds[i] = data_fds[--num_data_fds];
+        if (epfd >= 0) epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
+        return;
+    }
+}
+
+int ev_timer_new(void) {
+    if (num_timers >= EV_MAX_TIMERS) return -1;
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) return -1;
+    if (epoll_add(fd, TAG_TIMER + (uint32_t)num_timers) != 0) {
+        close(fd);
+        return -1;
+    }
+    timer_fds[num_timers] = fd;
+    timer_fired[num_timers] = 0;
+    return num_timers++;
+}
+
+void ev_timer_arm(int timer, int ms) {
+    if (timer < 0 || timer >= num_timers) return;
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if (ms > 0) {
+        its.it_value.tv_sec = ms / 1000;
+        its.it_value.tv_nsec = (long)(ms % 1000) * 1000000L;
+    }
+    timerfd_settime(timer_fds[timer], 0, &its, NULL);
+}
+
+int ev_timer_expired(int timer) {
+    if (timer < 0 || timer >= num_timers || !timer_fired[timer]) return 0;
+    timer_fired[timer] = 0;
+    return 1;
+}
+
+int ev_quit_requested(void) {
+    return quit_seen;
+}
+
+static int read_signals(void) {
+    struct signalfd_siginfo si;
+    int mask = 0;
+    while (read(sigfd, &si, sizeof(si)) == (ssize_t)sizeof(si)) {
+        if (si.ssi_signo == SIGWINCH) {
+            mask |= EV_RESIZE;
+        } else if (si.ssi_signo == SIGTERM) {
+            quit_seen = 1;
+            mask |= EV_QUIT;
+        }
+    }
+    return mask;
+}
+
+static int handle_ready(uint32_t tag) {
+    if (tag == TAG_KEY) return EV_KEY;
+    if (tag == TAG_SIGNAL) return read_signals();
+    if (tag >= TAG_TIMER && tag < TAG_TIMER + (uint32_t)num_timers) {
+        uint64_t expirations;
+        int i = (int)(tag - TAG_TIMER);
+        if (read(timer_fds[i], &expirations, sizeof(expirations)) > 0) {
+            timer_fired[i] = 1;
+            return EV_TIMER;
+        }
+        return 0;
+    }
+    return EV_DATA;   // der Aufrufer leert seine Quelle selbst
+}
+
+// Ohne epoll: dieselben Quellen ueber poll()
+static int poll_wait(int extra_fd, int timeout_ms) {
+    struct pollfd pfds[3 + EV_MAX_TIMERS + EV_MAX_FDS];
+    uint32_t tags[3 + EV_MAX_TIMERS + EV_MAX_FDS];
+    int n = 0;
+
+    pfds[n].fd = STDIN_FILENO;
+    tags[n++] = TAG_KEY;
+    if (sigfd >= 0) {
+        pfds[n].fd = sigfd;
+        tags[n++] = TAG_SIGNAL;
+    }
+    for (int i = 0; i < num_timers; i++) {
+        pfds[n].fd = timer_fds[i];
+        tags[n++] = TAG_TIMER + (uint32_t)i;
+    }
+    for (int i = 0; i < num_data_fds; i++) {
+        pfds[n].fd = data_fds[i];
+        tags[n++] = TAG_DATA;
+    }
+    if (extra_fd >= 0) {
+        pfds[n].fd = extra_fd;
+        tags[n++] = TAG_DATA;
+    }
+    for (int i = 0; i < n; i++) {
+        pfds[i].events = POLLIN;
+        pfds[i].revents = 0;
+    }
+
+    if (poll(pfds, (nfds_t)n, timeout_ms) <= 0) return 0;
+    int mask = 0;
+    for (int i = 0; i < n; i++) {
+        if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) mask |= handle_ready(tags[i]);
+    }
+    return mask;
+}
+
+int ev_wait(int extra_fd, int timeout_ms) {
+    if (epfd < 0) return poll_wait(extra_fd, timeout_ms);
+
+    // Nur die Aufruf-Quelle wechselt; ein geschlossener fd faellt in epoll von selbst heraus
+    if (extra_fd != extra_fd_cur) {
+        if (extra_fd_cur >= 0) epoll_ctl(epfd, EPOLL_CTL_DEL, extra_fd_cur, NULL);
+        extra_fd_cur = extra_fd;
+    }
+    if (extra_fd >= 0) epoll_add(extra_fd, TAG_DATA);
+
+    struct epoll_event evs[3 + EV_MAX_TIMERS + EV_MAX_FDS];
+    int n = epoll_wait(epfd, evs, (int)(sizeof(evs) / sizeof(evs[0])), timeout_ms);
+    int mask = 0;
+    for (int i = 0; i < n; i++) {
+        mask |= handle_ready(evs[i].data.u32);
+    }
+    return mask;
+}
@@ -0,0 +1,40 @@
+#ifndef EVLOOP_H
+#define EVLOOP_H
+
+/* Ereignisschleife des UI-Threads auf einer epoll-Instanz: Tastatur,
+   SIGWINCH/SIGTERM ueber signalfd, Timer ueber timerfd und beliebige
+   Datenquellen (Poller-Weckkanal, Journal, inotify). Ohne Ereignis
+   schlaeft ev_wait() ohne Timeout, im Leerlauf gibt es keine Weckrufe. */
+#define EV_KEY    0x01   // Tastatur lesbar
+#define EV_RESIZE 0x02   // SIGWINCH
+#define EV_QUIT   0x04   // SIGTERM
+#define EV_DATA   0x08   // eine Datenquelle ist lesbar
+#define EV_TIMER  0x10   // ein Timer ist abgelaufen
+
+#define EV_MAX_FDS    8
+#define EV_MAX_TIMERS 4
+
+/* Vor dem Start weiterer Threads aufrufen: blockiert SIGWINCH/SIGTERM
+   prozessweit, damit sie nur noch ueber den signalfd ankommen.
+   Ohne epoll arbeitet ev_wait() mit poll() weiter. Rueckgabe: 0 / -1 */
+int  ev_init(void);
+void ev_close(void);
+
+// Dauerhafte Datenquelle (level-triggered). Rueckgabe: 0 / -1
+int  ev_add_fd(int fd);
+void ev_del_fd(int fd);
+
+// Einmal-Timer: Handle >= 0 oder -1; ms <= 0 haelt ihn an
+int  ev_timer_new(void);
+void ev_timer_arm(int timer, int ms);
+int  ev_timer_expired(int timer);   // seit dem letzten Aufruf abgelaufen?
+
+/* Wartet auf das naechste Ereignis. extra_fd >= 0 zaehlt nur fuer diesen
+   Aufruf als Datenquelle (z.B. Journal im Follow-Modus), timeout_ms < 0
+   wartet unbegrenzt. Rueckgabe: EV_*-Bits, 0 bei Timeout */
+int  ev_wait(int extra_fd, int timeout_ms);
+
+// SIGTERM gesehen: alle Ansichten sollen zurueck, main_loop() endet
+int  ev_quit_requested(void);
+
+#endif
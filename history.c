@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "history.h"
+
+// Terminal ohne Wide-Char-ncurses: ASCII-Rampe statt Blockzeichen
+static const char spark_ramp[] = " .:-=+*#%@";
+#define SPARK_LEVELS ((int)sizeof(spark_ramp) - 2)   // ohne ' ' und NUL
+
+// Kleinster Skalenendwert je Reihe, damit Rauschen nicht bildfuellend wird
+static const float min_scale[HIST_NSERIES] = {
+    [HIST_CPU]   = 5.0f,      // %
+    [HIST_RSS]   = 1024.0f,   // 1 MB
+    [HIST_IO]    = 16.0f,     // KB/s
+    [HIST_TASKS] = 1.0f,
+};
+
+int history_interval_ms(void) {
+    static int interval_ms = 0;
+    if (interval_ms == 0) {
+        const char *env = getenv(HISTORY_INTERVAL_ENV);
+        int sec = env ? atoi(env) : 0;
+        interval_ms = (sec > 0 ? sec : HISTORY_DEFAULT_INTERVAL) * 1000;
+    }
+    return interval_ms;
+}
+
+void history_push(struct unit_history *h, const struct unit_usage *u) {
+    h->v[HIST_CPU][h->head]   = (float)u->cpu_pct;
+    h->v[HIST_RSS][h->head]   = (float)u->rss_kb;
+    h->v[HIST_IO][h->head]    = (float)u->io_kbps;
+    h->v[HIST_TASKS][h->head] = (float)u->tasks;
+
+    h->head = (h->head + 1) % HISTORY_LEN;
+    h->seq++;
+    if (h->count < HISTORY_LEN) h->count++;
+}
+
+int history_series(const struct unit_history *h, int series, float *out, int max) {
+    if (!h || series < 0 || series >= HIST_NSERIES || max <= 0) return 0;
+
+    int n = h->count < max ? h->count : max;
+    int start = (h->head - n + HISTORY_LEN) % HISTORY_LEN;
+    for (int i = 0; i < n; i++) {
+        out[i] = h->v[series][(start + i) % HISTORY_LEN];
+    }
+    return n;
+}
+
+float history_scale(int series, const float *vals, int n) {
+    float top = min_scale[series];
+    for (int i = 0; i < n; i++) {
+        if (vals[i] > top) top = vals[i];
+    }
+    return top;
+}
+
+void history_sparkline(const struct unit_history *h, int series, char *out, int width) {
+    if (width <= 0) {
+        out[0] = '\0';
+        return;
+    }
+
+    float vals[HISTORY_LEN];
+    if (width > HISTORY_LEN) width = HISTORY_LEN;
+    int n = history_series(h, series, vals, width);
+    float top = history_scale(series, vals, n);
+
+    // Rechtsbuendig: neuester Wert ganz rechts
+    int pad = width - n;
+    memset(out, ' ', (size_t)pad);
+    for (int i = 0; i < n; i++) {
+        if (vals[i] < 0) {
+            out[pad + i] = ' ';
+            continue;
+        }
+        int level = 1 + (int)(vals[i] / top * (SPARK_LEVELS - 1) + 0.5f);
+        if (level > SPARK_LEVELS) level = SPARK_LEVELS;
+        out[pad + i] = spark_ramp[level];
+    }
+    out[width] = '\0';
+}
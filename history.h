@@ -0,0 +1,39 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+
+#include "stats.h"
+
+#define HISTORY_LEN 120                  // Werte pro Reihe
+#define HISTORY_DEFAULT_INTERVAL 5       // Sekunden -> 10 Minuten Verlauf
+#define HISTORY_INTERVAL_ENV "SYSDASH_HISTORY_INTERVAL"
+
+enum history_series {
+    HIST_CPU,       // %
+    HIST_RSS,       // KB
+    HIST_IO,        // KB/s
+    HIST_TASKS,
+    HIST_NSERIES
+};
+
+/* Feste Ringpuffer je Unit (~2 KB), einmal angelegt, waechst nie.
+   Unbekannte Werte werden als -1 gespeichert. */
+struct unit_history {
+    int count;                           // gueltige Werte, <= HISTORY_LEN
+    int head;                            // naechste Schreibposition
+    unsigned long seq;                   // Eintraege insgesamt, waechst nur (Deltas)
+    float v[HIST_NSERIES][HISTORY_LEN];
+};
+
+int  history_interval_ms(void);
+void history_push(struct unit_history *h, const struct unit_usage *u);
+
+// Die letzten max Werte einer Reihe, aeltester zuerst. Rueckgabe: Anzahl
+int  history_series(const struct unit_history *h, int series, float *out, int max);
+float history_scale(int series, const float *vals, int n);
+
+// ASCII-Sparkline der letzten width Werte (out braucht width + 1 Bytes)
+void history_sparkline(const struct unit_history *h, int series, char *out, int width);
+
+#endif
@@ -0,0 +1,537 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "journal.h"
+#include "spawn.h"
+#include "sys_dashboard.h"
+
+#ifdef HAVE_LIBSYSTEMD
+#include <systemd/sd-journal.h>
+#endif
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// --------------------------------------------------
+// Ringpuffer
+// --------------------------------------------------
+int log_ring_init(struct log_ring *r, int capacity, size_t text_size) {
+    memset(r, 0, sizeof(*r));
+    if (capacity <= 0 || text_size < LOG_MSG_LEN) return -1;
+    r->entries = calloc((size_t)capacity, sizeof(*r->entries));
+    r->text = malloc(text_size);
+    if (!r->entries || !r->text) {
+        log_ring_free(r);
+        return -1;
+    }
+    r->capacity = capacity;
+    r->text_size = text_size;
+    return 0;
+}
+
+void log_ring_free(struct log_ring *r) {
+    free(r->entries);
+    free(r->text);
+    memset(r, 0, sizeof(*r));
+}
+
+void log_ring_clear(struct log_ring *r) {
+    r->head = 0;
+    r->count = 0;
+}
+
+/* Text liegt immer am Stueck: passt er nicht mehr ans Pufferende, beginnt
+   er vorne. Alles, was dabei ueberschrieben wird, fliegt aus dem Ring. */
+struct log_entry *log_ring_push(struct log_ring *r, const char *text, size_t len) {
+    if (len >= LOG_MSG_LEN) len = LOG_MSG_LEN - 1;
+
+    uint64_t start = r->text_head;
+    size_t pos = (size_t)(start % r->text_size);
+    if (pos + len + 1 > r->text_size) start += r->text_size - pos;
+    uint64_t end = start + len + 1;
+
+    while (r->count > 0) {
+        const struct log_entry *old = &r->entries[(r->head - r->count + r->capacity) % r->capacity];
+        if (r->count < r->capacity && old->off + r->text_size >= end) break;
+        r->count--;
+    }
+
+    char *dst = r->text + start % r->text_size;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)text[i];
+        // Steuerzeichen (mehrzeilige Meldungen, ESC) wuerden das Layout zerstoeren
+        dst[i] = (c < 0x20 || c == 0x7f) ? ' ' : (char)c;
+    }
+    dst[len] = '\0';
+    r->text_head = end;
+
+    struct log_entry *e = &r->entries[r->head];
+    memset(e, 0, sizeof(*e));
+    e->off = start;
+    e->len = (uint32_t)len;
+    e->priority = -1;
+    r->head = (r->head + 1) % r->capacity;
+    r->count++;
+    r->total++;
+    return e;
+}
+
+unsigned long log_ring_first(const struct log_ring *r) {
+    return r->total - (unsigned long)r->count;
+}
+
+const struct log_entry *log_ring_at(const struct log_ring *r, unsigned long seq) {
+    if (seq < log_ring_first(r) || seq >= r->total) return NULL;
+    unsigned long back = r->total - seq;   // 1 = neuester
+    return &r->entries[(r->head - (int)back + r->capacity) % r->capacity];
+}
+
+const char *log_ring_text(const struct log_ring *r, const struct log_entry *e) {
+    return r->text + e->off % r->text_size;
+}
+
+// --------------------------------------------------
+// Suche
+// --------------------------------------------------
+// Eintrag, dessen Text an der fortlaufenden Position off beginnt oder sie enthaelt
+static unsigned long seq_at_off(const struct log_ring *r, uint64_t off, unsigned long lo) {
+    unsigned long hi = r->total;   // erster Eintrag mit e->off > off
+    while (lo < hi) {
+        unsigned long mid = lo + (hi - lo) / 2;
+        if (log_ring_at(r, mid)->off <= off) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo - 1;
+}
+
+static int matches_push(struct log_matches *m, unsigned long seq) {
+    if (m->count == m->cap) {
+        size_t cap = m->cap ? m->cap * 2 : 1024;
+        unsigned long *p = realloc(m->seq, cap * sizeof(*p));
+        if (!p) return -1;
+        m->seq = p;
+        m->cap = cap;
+    }
+    m->seq[m->count++] = seq;
+    return 0;
+}
+
+int log_ring_search(const struct log_ring *r, const char *pattern, unsigned long from,
+                    struct log_matches *m) {
+    size_t plen = strlen(pattern);
+    unsigned long first = log_ring_first(r);
+    if (from < first) from = first;
+    if (plen == 0 || from >= r->total) return 0;
+
+    uint64_t cur = log_ring_at(r, from)->off;
+    uint64_t end = r->text_head;
+    unsigned long lo = from;
+    int added = 0;
+
+    /* Texte liegen nie ueber das Pufferende hinweg, ein Treffer also auch
+       nicht. Umbruch-Reste alter Zeilen fallen bei der Pruefung durch. */
+    while (cur < end) {
+        size_t pos = (size_t)(cur % r->text_size);
+        size_t seg = r->text_size - pos;
+        if (seg > end - cur) seg = (size_t)(end - cur);
+
+        const char *base = r->text + pos;
+        const char *hit = memmem(base, seg, pattern, plen);
+        if (!hit) {
+            cur += seg;
+            continue;
+        }
+
+        uint64_t off = cur + (uint64_t)(hit - base);
+        unsigned long seq = seq_at_off(r, off, lo);
+        const struct log_entry *e = log_ring_at(r, seq);
+        if (e && off + plen <= e->off + e->len) {
+            if (matches_push(m, seq) != 0) return -1;
+            added++;
+            lo = seq;
+            cur = e->off + e->len + 1;   // Rest der Zeile ueberspringen
+        } else {
+            cur = off + 1;
+        }
+    }
+    return added;
+}
+
+void log_matches_trim(struct log_matches *m, unsigned long first) {
+    while (m->start < m->count && m->seq[m->start] < first) m->start++;
+    // Erst verschieben, wenn die Haelfte verdraengt ist
+    if (m->start > 0 && m->start * 2 >= m->count) {
+        memmove(m->seq, m->seq + m->start, (m->count - m->start) * sizeof(*m->seq));
+        m->count -= m->start;
+        m->start = 0;
+    }
+}
+
+void log_matches_free(struct log_matches *m) {
+    free(m->seq);
+    memset(m, 0, sizeof(*m));
+}
+
+#ifdef HAVE_LIBSYSTEMD
+// --------------------------------------------------
+// sd-journal
+// --------------------------------------------------
+static int add_match(sd_journal *j, const char *fmt, const char *value) {
+    char m[320];
+    snprintf(m, sizeof(m), fmt, value);
+    return sd_journal_add_match(j, m, 0);
+}
+
+/* Wie journalctl -u: Meldungen der Units selbst ODER die des Managers
+   ueber die Units (Started/Stopped ...). Gleiche Felder innerhalb einer
+   Gruppe verknuepft sd-journal mit ODER, verschiedene mit UND. */
+static int add_unit_group(sd_journal *j, const struct journal_tail *t, int user,
+                          const char *field, const char *extra) {
+    if (sd_journal_add_disjunction(j) < 0) return -1;
+    for (int i = 0; i < t->nunits; i++) {
+        if (t->units[i].user == user && add_match(j, field, t->units[i].name) < 0) return -1;
+    }
+    return extra ? sd_journal_add_match(j, extra, 0) : 0;
+}
+
+static int add_unit_matches(sd_journal *j, const struct journal_tail *t) {
+    int have_system = 0, have_user = 0;
+    for (int i = 0; i < t->nunits; i++) {
+        if (t->units[i].user) have_user = 1;
+        else have_system = 1;
+    }
+
+    if (have_system &&
+        (add_unit_group(j, t, 0, "_SYSTEMD_UNIT=%s", NULL) < 0 ||
+         add_unit_group(j, t, 0, "UNIT=%s", "_PID=1") < 0)) {
+        return -1;
+    }
+
+    char uid[32];
+    snprintf(uid, sizeof(uid), "_UID=%lu", (unsigned long)getuid());
+    if (have_user &&
+        (add_unit_group(j, t, 1, "_SYSTEMD_USER_UNIT=%s", uid) < 0 ||
+         add_unit_group(j, t, 1, "USER_UNIT=%s", uid) < 0)) {
+        return -1;
+    }
+
+    // (Units ...) UND (PRIORITY=0 ODER ... ODER PRIORITY=max)
+    if (t->max_priority >= 0 && t->max_priority < 7) {
+        if (sd_journal_add_conjunction(j) < 0) return -1;
+        for (int p = 0; p <= t->max_priority; p++) {
+            char m[24];
+            snprintf(m, sizeof(m), "PRIORITY=%d", p);
+            if (sd_journal_add_match(j, m, 0) < 0) return -1;
+        }
+    }
+    return 0;
+}
+
+// Feldinhalt ohne "NAME=" als C-String. Rueckgabe: Laenge, 0 = fehlt
+static size_t get_field(sd_journal *j, const char *field, char *buf, size_t size) {
+    const void *data;
+    size_t len;
+    size_t prefix = strlen(field) + 1;
+
+    buf[0] = '\0';
+    if (sd_journal_get_data(j, field, &data, &len) < 0 || len <= prefix) return 0;
+    len -= prefix;
+    if (len >= size) len = size - 1;
+    memcpy(buf, (const char *)data + prefix, len);
+    buf[len] = '\0';
+    return len;
+}
+
+static int unit_index(const struct journal_tail *t, const char *name, int user) {
+    for (int i = 0; i < t->nunits; i++) {
+        if (t->units[i].user == user && strcmp(t->units[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// Zu welcher der verfolgten Units gehoert der aktuelle Eintrag?
+static int entry_unit(const struct journal_tail *t) {
+    static const char *const fields[] = { "_SYSTEMD_UNIT", "UNIT", "_SYSTEMD_USER_UNIT", "USER_UNIT" };
+    char name[JOURNAL_UNIT_LEN];
+
+    if (t->nunits == 1) return 0;
+    for (int f = 0; f < 4; f++) {
+        if (get_field(t->j, fields[f], name, sizeof(name))) {
+            int idx = unit_index(t, name, f >= 2);
+            if (idx >= 0) return idx;
+        }
+    }
+    return -1;
+}
+
+// Wie journalctl -o short, ohne Hostname
+static void push_entry(const struct journal_tail *t, struct log_ring *ring) {
+    sd_journal *j = t->j;
+    char ident[64], pid[16], prio[8], ts[32];
+    char msg[LOG_MSG_LEN];
+    char line[LOG_MSG_LEN];
+    uint64_t usec;
+
+    if (sd_journal_get_realtime_usec(j, &usec) < 0) usec = 0;
+    if (!get_field(j, "SYSLOG_IDENTIFIER", ident, sizeof(ident))) {
+        get_field(j, "_COMM", ident, sizeof(ident));
+    }
+    get_field(j, "_PID", pid, sizeof(pid));
+    get_field(j, "MESSAGE", msg, sizeof(msg));
+    int priority = (get_field(j, "PRIORITY", prio, sizeof(prio)) == 1 &&
+                    prio[0] >= '0' && prio[0] <= '7') ? prio[0] - '0' : -1;
+
+    ts[0] = '\0';
+    if (usec) {
+        time_t sec = (time_t)(usec / 1000000);
+        struct tm tm;
+        if (localtime_r(&sec, &tm)) strftime(ts, sizeof(ts), "%b %d %H:%M:%S", &tm);
+    }
+
+    int len = snprintf(line, sizeof(line), "%s %s%s%s%s: %s", ts,
+                       ident[0] ? ident : "?", pid[0] ? "[" : "", pid, pid[0] ? "]" : "", msg);
+    if (len < 0) return;
+    struct log_entry *e = log_ring_push(ring, line, (size_t)len);
+    e->usec = usec;
+    e->priority = (int16_t)priority;
+    e->unit = (int16_t)entry_unit(t);
+}
+
+static void save_cursor(struct journal_tail *t) {
+    char *c = NULL;
+    if (sd_journal_get_cursor(t->j, &c) >= 0 && c) {
+        snprintf(t->cursor, sizeof(t->cursor), "%s", c);
+    }
+    free(c);
+}
+
+// Nach einem Lesefehler (z.B. rotierte Datei) zurueck hinter den Cursor
+static int seek_after_cursor(struct journal_tail *t) {
+    if (!t->cursor[0] || sd_journal_seek_cursor(t->j, t->cursor) < 0) return -1;
+    if (sd_journal_next(t->j) > 0 && sd_journal_test_cursor(t->j, t->cursor) <= 0) {
+        t->have_current = 1;   // Eintrag des Cursors existiert nicht mehr
+    }
+    return 0;
+}
+
+static int read_sd(struct journal_tail *t, struct log_ring *ring) {
+    sd_journal *j = t->j;
+
+    if (!t->started) {
+        t->started = 1;
+        if (t->since_usec) {
+            if (sd_journal_seek_realtime_usec(j, t->since_usec) < 0) return -1;
+        } else {
+            if (sd_journal_seek_tail(j) < 0) return -1;
+            if (t->backlog > 0 && sd_journal_previous_skip(j, (uint64_t)t->backlog) > 0) {
+                t->have_current = 1;
+            }
+        }
+    } else {
+        sd_journal_process(j);   // fd quittieren; Position bleibt erhalten
+    }
+
+    int added = 0;
+    int retried = 0;
+    t->pending = 0;
+    while (added < JOURNAL_READ_BATCH) {
+        if (t->have_current) {
+            t->have_current = 0;
+        } else {
+            int r = sd_journal_next(j);
+            if (r < 0 && !retried) {
+                retried = 1;
+                if (seek_after_cursor(t) == 0) continue;
+            }
+            if (r <= 0) break;
+        }
+        push_entry(t, ring);
+        added++;
+    }
+    if (added == JOURNAL_READ_BATCH) t->pending = 1;
+    if (added > 0) save_cursor(t);
+    return added;
+}
+#endif
+
+// --------------------------------------------------
+// Fallback: journalctl --show-cursor / --after-cursor
+// --------------------------------------------------
+/* Bei mehreren Units traegt -o with-unit den Unit-Namen statt des
+   Identifiers -> daran zuordnen. */
+static int line_unit(const struct journal_tail *t, const char *line) {
+    if (t->nunits == 1) return 0;
+    for (int i = 0; i < t->nunits; i++) {
+        const char *p = strstr(line, t->units[i].name);
+        size_t n = strlen(t->units[i].name);
+        if (p && p > line && p[-1] == ' ' && (p[n] == '[' || p[n] == ':')) return i;
+    }
+    return -1;
+}
+
+static int read_journalctl(struct journal_tail *t, struct log_ring *ring) {
+    long long now = now_ms();
+    if (t->started && now < t->next_ms) return 0;
+    t->started = 1;
+    t->next_ms = now + JOURNAL_FALLBACK_POLL_MS;
+
+    const char **argv = malloc(((size_t)t->nunits * 2 + 16) * sizeof(*argv));
+    if (!argv) return -1;
+
+    char n_lines[16];
+    char prio[8];
+    char since[32];
+    char after[LOG_CURSOR_LEN + 32];
+    int a = 0;
+    argv[a++] = "journalctl";
+    for (int i = 0; i < t->nunits; i++) {
+        argv[a++] = t->units[i].user ? "--user-unit" : "-u";
+        argv[a++] = t->units[i].name;
+    }
+    argv[a++] = "--no-pager";
+    argv[a++] = "-q";
+    argv[a++] = "-o";
+    argv[a++] = t->nunits > 1 ? "with-unit" : "short";
+    argv[a++] = "--show-cursor";
+    if (t->max_priority >= 0 && t->max_priority < 7) {
+        snprintf(prio, sizeof(prio), "%d", t->max_priority);
+        argv[a++] = "-p";
+        argv[a++] = prio;
+    }
+    if (t->cursor[0]) {
+        snprintf(after, sizeof(after), "--after-cursor=%s", t->cursor);
+        argv[a++] = after;
+    } else {
+        // Ab Zeitpunkt: mehr als der Ring fasst wuerde ohnehin verdraengt
+        snprintf(n_lines, sizeof(n_lines), "%d", t->since_usec ? ring->capacity : t->backlog);
+        argv[a++] = "-n";
+        argv[a++] = n_lines;
+        if (t->since_usec) {
+            snprintf(since, sizeof(since), "--since=@%llu",
+                     (unsigned long long)(t->since_usec / 1000000));
+            argv[a++] = since;
+        }
+    }
+    argv[a] = NULL;
+
+    char *out = NULL;
+    int ret = spawn_cmd(argv, SPAWN_CAPTURE | SPAWN_QUIET, CMD_TIMEOUT_MS, &out, NULL);
+    free(argv);
+    if (ret < 0 || !out) {
+        free(out);
+        return -1;
+    }
+
+    int added = 0;
+    char *save = NULL;
+    for (char *line = strtok_r(out, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        if (strncmp(line, "-- cursor: ", 11) == 0) {
+            snprintf(t->cursor, sizeof(t->cursor), "%s", line + 11);
+            continue;
+        }
+        struct log_entry *e = log_ring_push(ring, line, strlen(line));
+        e->unit = (int16_t)line_unit(t, line);
+        added++;
+    }
+    free(out);
+    return added;
+}
+
+// sd-journal oeffnen; klappt das nicht, bleibt t->j NULL (journalctl)
+static void open_sd(struct journal_tail *t) {
+#ifdef HAVE_LIBSYSTEMD
+    int flags = SD_JOURNAL_LOCAL_ONLY;
+    for (int i = 0; i < t->nunits; i++) {
+        flags |= t->units[i].user ? SD_JOURNAL_CURRENT_USER : SD_JOURNAL_SYSTEM;
+    }
+
+    sd_journal *j = NULL;
+    if (sd_journal_open(&j, flags) >= 0) {
+        if (add_unit_matches(j, t) == 0 && sd_journal_get_fd(j) >= 0) {
+            sd_journal_set_data_threshold(j, LOG_MSG_LEN);
+            t->j = j;
+        } else {
+            sd_journal_close(j);
+        }
+    }
+#endif
+    (void)t;
+}
+
+// --------------------------------------------------
+// Oeffentliche Funktionen
+// --------------------------------------------------
+int journal_tail_open(struct journal_tail *t, const char *unit, const char *scope, int backlog) {
+    return journal_tail_open_units(t, &unit, &scope, 1, backlog);
+}
+
+int journal_tail_open_units(struct journal_tail *t, const char *const *units,
+                            const char *const *scopes, int n, int backlog) {
+    memset(t, 0, sizeof(*t));
+    if (n <= 0 || n > INT16_MAX) return -1;
+    t->units = calloc((size_t)n, sizeof(*t->units));
+    if (!t->units) return -1;
+    for (int i = 0; i < n; i++) {
+        if (!units[i] || !units[i][0]) continue;
+        struct journal_unit *u = &t->units[t->nunits++];
+        snprintf(u->name, sizeof(u->name), "%s", units[i]);
+        u->user = scopes[i] && strcmp(scopes[i], "user") == 0;
+    }
+    if (t->nunits == 0) {
+        journal_tail_close(t);
+        return -1;
+    }
+    t->backlog = backlog;
+    t->max_priority = -1;
+    open_sd(t);
+    return 0;
+}
+
+int journal_tail_set_filter(struct journal_tail *t, int max_priority, uint64_t since_usec) {
+#ifdef HAVE_LIBSYSTEMD
+    if (t->j) sd_journal_close(t->j);
+#endif
+    t->j = NULL;
+    t->max_priority = max_priority;
+    t->since_usec = since_usec;
+    t->started = 0;
+    t->have_current = 0;
+    t->pending = 0;
+    t->cursor[0] = '\0';
+    t->next_ms = 0;
+    open_sd(t);
+    return 0;
+}
+
+void journal_tail_close(struct journal_tail *t) {
+#ifdef HAVE_LIBSYSTEMD
+    if (t->j) sd_journal_close(t->j);
+#endif
+    t->j = NULL;
+    free(t->units);
+    t->units = NULL;
+    t->nunits = 0;
+}
+
+int journal_tail_fd(const struct journal_tail *t) {
+#ifdef HAVE_LIBSYSTEMD
+    if (t->j) return sd_journal_get_fd(t->j);
+#endif
+    (void)t;
+    return -1;
+}
+
+int journal_tail_read(struct journal_tail *t, struct log_ring *ring) {
+    if (!ring->entries || !ring->text) return -1;
+#ifdef HAVE_LIBSYSTEMD
+    if (t->j) return read_sd(t, ring);
+#endif
+    return read_journalctl(t, ring);
+}
@@ -0,0 +1,109 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+
+#define LOG_MSG_LEN 512                 // formatierte Zeile inkl. Zeitstempel
+#define LOG_CURSOR_LEN 256
+#define JOURNAL_READ_BATCH 4096         // Eintraege pro journal_tail_read()
+#define JOURNAL_FALLBACK_POLL_MS 2000   // journalctl hoechstens so oft
+
+// Ein Journal-Eintrag; der Text liegt im Textpuffer des Rings
+struct log_entry {
+    uint64_t usec;                      // CLOCK_REALTIME, 0 = unbekannt
+    uint64_t off;                       // fortlaufende Position im Textpuffer
+    uint32_t len;                       // ohne NUL
+    int16_t priority;                   // 0 (emerg) .. 7 (debug), -1 = unbekannt
+    int16_t unit;                       // Index der Unit im journal_tail
+};
+
+/* Begrenzt nach Eintraegen UND Bytes: Eintrags-Array und Textpuffer
+   werden einmal angelegt, der aelteste Eintrag wird ueberschrieben.
+   Eintraege werden ueber ihre laufende Nummer (seq) angesprochen;
+   gueltig ist log_ring_first(r) .. r->total - 1. */
+struct log_ring {
+    struct log_entry *entries;
+    int capacity;
+    int head;                           // naechste Schreibposition
+    int count;
+    unsigned long total;                // seit dem Anlegen geschrieben
+    char *text;
+    size_t text_size;
+    uint64_t text_head;                 // fortlaufend, nie zurueckgesetzt
+};
+
+int  log_ring_init(struct log_ring *r, int capacity, size_t text_size);
+void log_ring_free(struct log_ring *r);
+void log_ring_clear(struct log_ring *r);
+
+// Kopiert text (Steuerzeichen -> ' '); usec/priority/unit setzt der Aufrufer
+struct log_entry *log_ring_push(struct log_ring *r, const char *text, size_t len);
+
+unsigned long log_ring_first(const struct log_ring *r);
+const struct log_entry *log_ring_at(const struct log_ring *r, unsigned long seq);
+const char *log_ring_text(const struct log_ring *r, const struct log_entry *e);
+
+/* Treffer einer Suche im Ring: laufende Nummern, aufsteigend.
+   Gueltig ist seq[start] .. seq[count - 1]; davor wurde verdraengt. */
+struct log_matches {
+    unsigned long *seq;
+    size_t start;
+    size_t count;
+    size_t cap;
+};
+
+/* Sucht pattern (Gross/klein beachtet) in allen Zeilen ab from und haengt
+   deren seq an m an. Ein memmem ueber den zusammenhaengenden Textpuffer
+   statt einem Aufruf pro Zeile. Rueckgabe: neue Treffer, -1 Fehler */
+int  log_ring_search(const struct log_ring *r, const char *pattern, unsigned long from,
+                     struct log_matches *m);
+void log_matches_trim(struct log_matches *m, unsigned long first);
+void log_matches_free(struct log_matches *m);
+
+struct sd_journal;
+
+#define JOURNAL_UNIT_LEN 256
+
+struct journal_unit {
+    char name[JOURNAL_UNIT_LEN];
+    int user;                           // User-Unit (_SYSTEMD_USER_UNIT)
+};
+
+/* Verfolgt das Journal einer oder mehrerer Units ab einer Position
+   (Cursor), bei mehreren zeitlich gemischt in einem Strom.
+   Mit HAVE_LIBSYSTEMD ueber ein sd-journal (ODER-verknuepfte Matches auf
+   _SYSTEMD_UNIT bzw. _SYSTEMD_USER_UNIT); ohne, oder wenn das Journal
+   nicht lesbar ist, per journalctl --after-cursor.
+   log_entry.unit ist der Index in units, -1 wenn nicht zuordenbar. */
+struct journal_tail {
+    struct sd_journal *j;               // NULL = journalctl
+    struct journal_unit *units;
+    int nunits;
+    int backlog;                        // Zeilen beim ersten Lesen
+    int started;
+    int have_current;                   // sd-journal steht schon auf einem ungelesenen Eintrag
+    int pending;                        // Batch voll, es liegt noch mehr an
+    char cursor[LOG_CURSOR_LEN];        // zuletzt gelesener Eintrag
+    long long next_ms;                  // journalctl: naechster Aufruf
+    int max_priority;                   // Filter: nur 0..max_priority, -1 = alle
+    uint64_t since_usec;                // Filter: ab Zeitpunkt statt Rueckblick, 0 = aus
+};
+
+int  journal_tail_open(struct journal_tail *t, const char *unit, const char *scope, int backlog);
+int  journal_tail_open_units(struct journal_tail *t, const char *const *units,
+                             const char *const *scopes, int n, int backlog);
+void journal_tail_close(struct journal_tail *t);
+
+/* Filter im Journal selbst (Match auf PRIORITY, Start per Zeitstempel).
+   Beginnt von vorn: der Aufrufer leert seinen Ring. */
+int  journal_tail_set_filter(struct journal_tail *t, int max_priority, uint64_t since_usec);
+
+/* fd fuer poll(): wird lesbar, sobald neue Eintraege da sind.
+   -1 bei journalctl -> Aufrufer pollt mit Timeout. */
+int  journal_tail_fd(const struct journal_tail *t);
+
+/* Haengt neue Eintraege an den Ring an (hoechstens JOURNAL_READ_BATCH,
+   danach ist t->pending gesetzt). Rueckgabe: Anzahl neuer Eintraege, -1 Fehler */
+int  journal_tail_read(struct journal_tail *t, struct log_ring *ring);
+
+#endif
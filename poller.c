@@ -0,0 +1,512 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "poller.h"
+#include "bus.h"
+#include "strpool.h"
+#include "remote.h"
+
+/* Takt fuer CPU/RSS der Favoriten. Zustaende kommen dabei aus dem Cache
+   (Signale bzw. TTL), abgefragt wird nur, was veraltet ist. */
+#define POLLER_INTERVAL_MS 1000
+
+// --------------------------------------------------
+// Daten-Lock (Cache, my_services; der Bus hat sein eigenes)
+// --------------------------------------------------
+static pthread_mutex_t data_mutex;
+static pthread_once_t  data_once = PTHREAD_ONCE_INIT;
+
+static void data_mutex_init(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&data_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void data_lock(void) {
+    pthread_once(&data_once, data_mutex_init);
+    pthread_mutex_lock(&data_mutex);
+}
+
+void data_unlock(void) {
+    pthread_mutex_unlock(&data_mutex);
+}
+
+// --------------------------------------------------
+// Snapshot-Uebergabe: lock-freier Triple-Buffer
+// --------------------------------------------------
+/* Der Schreiber fuellt bufs[back_idx] und tauscht ihn atomar gegen den
+   mittleren Puffer. Der Leser tauscht seinen front_idx nur, wenn der
+   mittlere Puffer als neu markiert ist. Keiner wartet je auf den anderen. */
+#define SNAP_INDEX 0x3
+#define SNAP_DIRTY 0x4
+
+static atomic_int running = 0;
+static void collect_and_publish(void);
+
+static struct snapshot bufs[3];
+static atomic_int middle_idx = 1;
+static int front_idx = 0;   // nur UI-Thread
+static int back_idx  = 2;   // nur Schreiber
+static unsigned long snap_seq = 0;
+
+const struct snapshot *poller_snapshot(void) {
+    if (!atomic_load(&running)) {
+        collect_and_publish(); // kein Thread: synchron im UI
+    }
+    if (atomic_load(&middle_idx) & SNAP_DIRTY) {
+        front_idx = atomic_exchange(&middle_idx, front_idx) & SNAP_INDEX;
+    }
+    return &bufs[front_idx];
+}
+
+static const struct snapshot_row *snapshot_row(const struct snapshot *snap, int hint,
+                                               const char *name) {
+    if (!snap || !name) return NULL;
+
+    // Namen kommen aus dem String-Pool: meist genuegt der Zeigervergleich
+    if (hint >= 0 && hint < snap->count &&
+        (snap->rows[hint].name == name || strcmp(snap->rows[hint].name, name) == 0)) {
+        return &snap->rows[hint];
+    }
+    for (int i = 0; i < snap->count; i++) {
+        if (snap->rows[i].name == name || strcmp(snap->rows[i].name, name) == 0) {
+            return &snap->rows[i];
+        }
+    }
+    return NULL;
+}
+
+const struct unit_state *snapshot_state(const struct snapshot *snap, int hint, const char *name) {
+    const struct snapshot_row *row = snapshot_row(snap, hint, name);
+    return (row && row->state.scope != UNIT_SCOPE_UNKNOWN) ? &row->state : NULL;
+}
+
+const struct unit_usage *snapshot_usage(const struct snapshot *snap, int hint, const char *name) {
+    const struct snapshot_row *row = snapshot_row(snap, hint, name);
+    return row ? &row->usage : NULL;
+}
+
+const struct unit_history *snapshot_history(const struct snapshot *snap, int hint, const char *name) {
+    const struct snapshot_row *row = snapshot_row(snap, hint, name);
+    if (!row) return NULL;
+
+    int i = (int)(row - snap->rows);
+    if (i >= snap->view_offset || snap->hist[i].count == 0) return NULL;
+    return &snap->hist[i];
+}
+
+// Verlaufs-Kopien nur fuer die Favoriten (je ~2 KB)
+static int snapshot_reserve_hist(struct snapshot *snap, int count) {
+    if (count <= snap->hist_capacity) return 0;
+
+    int cap = snap->hist_capacity ? snap->hist_capacity : 16;
+    while (cap < count) cap *= 2;
+    struct unit_history *hist = realloc(snap->hist, (size_t)cap * sizeof(*hist));
+    if (!hist) return -1;
+
+    snap->hist = hist;
+    snap->hist_capacity = cap;
+    return 0;
+}
+
+static int snapshot_reserve(struct snapshot *snap, int count) {
+    if (count <= snap->capacity) return 0;
+
+    int cap = snap->capacity ? snap->capacity : 16;
+    while (cap < count) cap *= 2;
+    struct snapshot_row *rows = realloc(snap->rows, (size_t)cap * sizeof(*rows));
+    if (!rows) return -1;
+
+    snap->rows = rows;
+    snap->capacity = cap;
+    return 0;
+}
+
+// --------------------------------------------------
+// Watch-Liste (vom UI gesetzt) und Weckrufe
+// --------------------------------------------------
+static pthread_mutex_t watch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static const char **watch_names = NULL;    // String-Pool
+static int watch_count = 0;
+static int watch_cap   = 0;
+static int fav_first   = 0;                // sichtbare Favoriten (+ Rand)
+static int fav_count   = 0;
+
+static int worker_pipe[2] = { -1, -1 };   // UI -> Worker
+static int ui_pipe[2]     = { -1, -1 };   // Worker -> UI
+
+static pthread_t worker;
+
+static void pipe_notify(int fd) {
+    if (fd < 0) return;
+    char c = 1;
+    ssize_t ret = write(fd, &c, 1); // EAGAIN = schon geweckt
+    (void)ret;
+}
+
+static int pipe_drain(int fd) {
+    if (fd < 0) return 0;
+    char buf[64];
+    int any = 0;
+    while (read(fd, buf, sizeof(buf)) > 0) any = 1;
+    return any;
+}
+
+int poller_wakeup_fd(void) {
+    return ui_pipe[0];
+}
+
+int poller_drain_wakeup(void) {
+    return pipe_drain(ui_pipe[0]);
+}
+
+void poller_wake(void) {
+    if (atomic_load(&running)) {
+        pipe_notify(worker_pipe[1]);
+    }
+}
+
+/* Setzt die zusaetzlich zu den Favoriten beobachteten Units
+   (z.B. sichtbare Zeilen im Browse-View). Unveraenderte Listen sind ein No-op. */
+void poller_watch(const char **names, int count) {
+    if (count < 0) count = 0;
+
+    pthread_mutex_lock(&watch_mutex);
+    int same = (count == watch_count);
+    for (int i = 0; same && i < count; i++) {
+        same = (watch_names[i] == names[i] || strcmp(watch_names[i], names[i]) == 0);
+    }
+    if (!same && count > watch_cap) {
+        int cap = watch_cap ? watch_cap : 64;
+        while (cap < count) cap *= 2;
+        void *p = realloc(watch_names, (size_t)cap * sizeof(*watch_names));
+        if (p) {
+            watch_names = p;
+            watch_cap = cap;
+        } else {
+            count = watch_cap;
+        }
+    }
+    if (!same) {
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            const char *name = str_intern(names[i]);
+            if (name) watch_names[n++] = name;
+        }
+        watch_count = n;
+    }
+    pthread_mutex_unlock(&watch_mutex);
+
+    if (!same) poller_wake();
+}
+
+/* Ausschnitt der Favoriten, den das Dashboard gerade zeigt. Nur diese
+   landen im Snapshot und werden jede Runde abgetastet; die uebrigen nur
+   im Verlaufstakt (sample_hidden_favorites, mit Daemon dort). */
+void poller_view_favorites(int first, int count) {
+    if (first < 0) first = 0;
+    if (count < 0) count = 0;
+
+    pthread_mutex_lock(&watch_mutex);
+    int same = (first == fav_first && count == fav_count);
+    fav_first = first;
+    fav_count = count;
+    pthread_mutex_unlock(&watch_mutex);
+
+    if (!same) poller_wake();
+}
+
+// --------------------------------------------------
+// Sammeln
+// --------------------------------------------------
+static const char **collect_names = NULL;
+static struct unit_state *collect_states = NULL;
+static int collect_cap = 0;
+
+static unsigned long long last_digest = 0;
+
+// Favoriten ausserhalb des Ausschnitts, nur im Verlaufstakt abgetastet
+static const char **hidden_names = NULL;
+static struct unit_state *hidden_states = NULL;
+static int hidden_cap = 0;
+static long long hidden_ms = -1;
+
+// Daemon-Socket aufgelegt (POLLHUP/POLLERR), nur Worker
+static int remote_hangup = 0;
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static unsigned long long digest_bytes(unsigned long long h, const void *p, size_t len) {
+    const unsigned char *b = p;
+    for (size_t i = 0; i < len; i++) {
+        h ^= b[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* Fingerabdruck dessen, was die Ansichten aus einem Snapshot zeigen.
+   Namen und Beschreibungen sind Pool-Zeiger, der Verlauf aendert sich
+   genau dann, wenn ein Wert dazukommt (count/seq). */
+static unsigned long long snapshot_digest(const struct snapshot *snap) {
+    unsigned long long h = 14695981039346656037ULL;
+    h = digest_bytes(h, &snap->fav_first, sizeof(snap->fav_first));
+    h = digest_bytes(h, &snap->view_offset, sizeof(snap->view_offset));
+    for (int i = 0; i < snap->count; i++) {
+        const struct snapshot_row *r = &snap->rows[i];
+        h = digest_bytes(h, &r->name, sizeof(r->name));
+        h = digest_bytes(h, &r->state.scope, 1);
+        h = digest_bytes(h, &r->state.active, 1);
+        h = digest_bytes(h, &r->state.enabled, 1);
+        h = digest_bytes(h, &r->state.desc, sizeof(r->state.desc));
+        h = digest_bytes(h, r->state.ports.port, sizeof(r->state.ports.port));
+        h = digest_bytes(h, &r->state.ports.n, 1);
+        h = digest_bytes(h, &r->state.ports.n_unix, 1);
+        h = digest_bytes(h, &r->usage.cpu_pct, sizeof(r->usage.cpu_pct));
+        h = digest_bytes(h, &r->usage.rss_kb, sizeof(r->usage.rss_kb));
+        h = digest_bytes(h, &r->usage.tasks, sizeof(r->usage.tasks));
+        h = digest_bytes(h, &r->usage.io_kbps, sizeof(r->usage.io_kbps));
+        if (i < snap->view_offset) {
+            h = digest_bytes(h, &snap->hist[i].count, sizeof(snap->hist[i].count));
+            h = digest_bytes(h, &snap->hist[i].seq, sizeof(snap->hist[i].seq));
+        }
+    }
+    return h;
+}
+
+/* Laeuft ein Daemon: nur das Abo nachfuehren und seine Deltas uebernehmen.
+   Die nicht sichtbaren Favoriten gehen als keep-Liste mit, damit der Daemon
+   ihren Verlauf nicht verwirft. Rueckgabe: -1 = Verbindung weg */
+static int collect_remote(struct snapshot *back, int n, int nhidden) {
+    if (remote_subscribe(collect_names, n, back->view_offset, hidden_names, nhidden) != 0) return -1;
+    if (remote_receive() < 0) return -1;
+
+    for (int i = 0; i < n; i++) {
+        struct unit_history *hist = (i < back->view_offset) ? &back->hist[i] : NULL;
+        if (!remote_row(i, &back->rows[i].state, &back->rows[i].usage, hist) && hist) {
+            hist->count = 0;
+        }
+    }
+    return 0;
+}
+
+// Favoriten ausserhalb von [first, first + nfav) nach hidden_names. Rueckgabe: Anzahl
+static int hidden_favorites(int first, int nfav) {
+    data_lock();
+    int k = 0;
+    if (num_my_services - nfav > hidden_cap) {
+        int cap = num_my_services;
+        const char **names = realloc(hidden_names, (size_t)cap * sizeof(*names));
+        if (names) hidden_names = names;
+        struct unit_state *states = realloc(hidden_states, (size_t)cap * sizeof(*states));
+        if (states) hidden_states = states;
+        if (names && states) hidden_cap = cap;
+    }
+    for (int i = 0; i < num_my_services && k < hidden_cap; i++) {
+        if (i >= first && i < first + nfav) continue;
+        hidden_names[k++] = my_services[i];
+    }
+    data_unlock();
+    return k;
+}
+
+/* Nicht sichtbare Favoriten: Zustand (meist aus dem Cache) und eine Probe
+   je Verlaufstakt, damit ihr Verlauf beim Zurueckscrollen lueckenlos ist.
+   CPU% ist dann der Schnitt ueber den ganzen Takt. */
+static void sample_hidden_favorites(int k) {
+    long long now = now_ms();
+    if (hidden_ms >= 0 && now - hidden_ms < history_interval_ms()) return;
+    hidden_ms = now;
+    if (k == 0) return;
+
+    fetch_unit_states(hidden_names, k, hidden_states);
+    for (int i = 0; i < k; i++) {
+        data_lock();
+        stats_sample(hidden_names[i], NULL);
+        data_unlock();
+    }
+}
+
+/* Favoriten + Watch-Liste abfragen und als neuen Snapshot veroeffentlichen.
+   Laeuft im Worker (oder synchron, falls kein Thread laeuft).
+   Die Locks halten nur fuers Kopieren der Namen: Abfragen (Bus, systemctl,
+   Daemon) laufen ohne, damit das UI nie auf einen Roundtrip wartet. */
+static void collect_and_publish(void) {
+    struct snapshot *back = &bufs[back_idx];
+
+    data_lock();
+    pthread_mutex_lock(&watch_mutex);
+
+    // Die Favoriten-Liste kann seit poller_view_favorites() kuerzer geworden sein
+    int first = fav_first < num_my_services ? fav_first : num_my_services;
+    int nfav = fav_count < num_my_services - first ? fav_count : num_my_services - first;
+
+    int total = nfav + watch_count;
+    if (snapshot_reserve(back, total) != 0 ||
+        snapshot_reserve_hist(back, nfav) != 0) {
+        pthread_mutex_unlock(&watch_mutex);
+        data_unlock();
+        return;
+    }
+    int n = 0;
+    for (int i = 0; i < nfav; i++) {
+        back->rows[n++].name = my_services[first + i];
+    }
+    back->fav_first = first;
+    back->view_offset = n;
+    for (int i = 0; i < watch_count; i++) {
+        back->rows[n++].name = watch_names[i];
+    }
+    pthread_mutex_unlock(&watch_mutex);
+    data_unlock();
+
+    if (n > collect_cap) {
+        const char **names = realloc(collect_names, (size_t)n * sizeof(*names));
+        if (names) collect_names = names;
+        struct unit_state *states = realloc(collect_states, (size_t)n * sizeof(*states));
+        if (states) collect_states = states;
+        if (!names || !states) return;
+        collect_cap = n;
+    }
+    for (int i = 0; i < n; i++) {
+        collect_names[i] = back->rows[i].name;
+    }
+
+    int nhidden = hidden_favorites(first, nfav);
+
+    int remote = remote_active() && !remote_hangup && collect_remote(back, n, nhidden) == 0;
+    if (remote_active() && !remote) {
+        // Daemon beendet: ab hier wieder selbst sammeln
+        remote_close();
+        remote_hangup = 0;
+        bus_subscribe();
+    }
+
+    if (!remote) {
+        fetch_unit_states(collect_names, n, collect_states);
+
+        data_lock();
+        stats_expire();
+        data_unlock();
+
+        // CPU/RSS/Verlauf nur fuer Favoriten; Quelle kennt stats aus der Zustands-Abfrage
+        for (int i = 0; i < n; i++) {
+            back->rows[i].state = collect_states[i];
+            struct unit_usage *u = &back->rows[i].usage;
+            *u = (struct unit_usage)UNIT_USAGE_UNKNOWN;
+            if (i < back->view_offset) {
+                data_lock();
+                stats_sample(back->rows[i].name, u);
+                if (stats_history(back->rows[i].name, &back->hist[i]) != 0) back->hist[i].count = 0;
+                data_unlock();
+            }
+        }
+        sample_hidden_favorites(nhidden);
+    }
+
+    back->count = n;
+
+    // Nichts Sichtbares geaendert: UI nicht wecken, Puffer beim naechsten Mal wiederverwenden
+    unsigned long long digest = snapshot_digest(back);
+    if (snap_seq > 0 && digest == last_digest) return;
+    last_digest = digest;
+
+    back->seq = ++snap_seq;
+    back_idx = atomic_exchange(&middle_idx, back_idx | SNAP_DIRTY) & SNAP_INDEX;
+    pipe_notify(ui_pipe[1]);
+}
+
+// --------------------------------------------------
+// Worker-Thread
+// --------------------------------------------------
+/* Wartet auf Weckruf, systemd-Signal oder Intervall.
+   Rueckgabe: 1 = neu sammeln, 0 = nur Bus-Verkehr */
+static int wait_for_work(void) {
+    struct pollfd pfds[2 + BUS_MAX_FDS];
+    pfds[0].fd = worker_pipe[0];
+    pfds[0].events = POLLIN;
+    pfds[0].revents = 0;
+
+    /* Mit Daemon wecken uns seine Deltas. Der Takt bleibt trotzdem: ein
+       haengender Daemon schickt nichts, und ein noch nicht ganz gesendetes
+       Abo muss erneut raus. */
+    int remote = remote_active();
+    int n = 1;
+    if (remote) {
+        pfds[n].fd = remote_fd();
+        pfds[n].events = POLLIN;
+        pfds[n++].revents = 0;
+    }
+
+    n += bus_fill_pollfds(pfds + n, BUS_MAX_FDS);
+
+    int ret = poll(pfds, (nfds_t)n, POLLER_INTERVAL_MS);
+    if (ret < 0) return errno == EINTR ? 0 : 1;
+    if (ret == 0) return 1; // Takt: neue Probe
+    if (remote && (pfds[1].revents & (POLLHUP | POLLERR | POLLNVAL))) {
+        remote_hangup = 1;
+        pipe_drain(worker_pipe[0]);
+        return 1;
+    }
+    if (remote && pfds[1].revents) {
+        pipe_drain(worker_pipe[0]);
+        return 1;
+    }
+
+    return pipe_drain(worker_pipe[0]);
+}
+
+static void *poller_main(void *arg) {
+    (void)arg;
+    int do_collect = 1;
+
+    while (atomic_load(&running)) {
+        int events = bus_process_events();
+
+        if (do_collect || events > 0) {
+            collect_and_publish();
+        }
+        do_collect = wait_for_work();
+    }
+    return NULL;
+}
+
+void poller_start(void) {
+    if (atomic_load(&running)) return;
+
+    if (ui_pipe[0] < 0 && pipe2(ui_pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        ui_pipe[0] = ui_pipe[1] = -1;
+    }
+    if (worker_pipe[0] < 0 && pipe2(worker_pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        worker_pipe[0] = worker_pipe[1] = -1;
+        return; // ohne Weckkanal kein Thread -> synchroner Betrieb
+    }
+
+    atomic_store(&running, 1);
+    if (pthread_create(&worker, NULL, poller_main, NULL) != 0) {
+        atomic_store(&running, 0);
+    }
+}
+
+void poller_stop(void) {
+    if (!atomic_load(&running)) return;
+
+    atomic_store(&running, 0);
+    pipe_notify(worker_pipe[1]);
+    pthread_join(worker, NULL);
+}
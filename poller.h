@@ -0,0 +1,53 @@
+#ifndef POLLER_H
+#define POLLER_H
+
+#include "sys_dashboard.h"
+#include "stats.h"
+#include "history.h"
+#include "unitstate.h"
+
+struct snapshot_row {
+    const char *name;            // String-Pool
+    struct unit_state state;     // scope UNIT_SCOPE_UNKNOWN = noch nicht geladen
+    struct unit_usage usage;     // nur Favoriten, sonst unbekannt (< 0)
+};
+
+/* Unveraenderlicher Stand fuer den UI-Thread.
+   rows[0..view_offset) = my_services[fav_first..] (Ausschnitt aus poller_view_favorites()),
+   rows[view_offset..count) = poller_watch()-Liste */
+struct snapshot {
+    unsigned long seq;
+    int count;
+    int fav_first;
+    int view_offset;
+    int capacity;
+    struct snapshot_row *rows;
+    struct unit_history *hist;   // hist[i] gehoert zu rows[i], nur Favoriten
+    int hist_capacity;
+};
+
+/* Hintergrund-Thread fuer alle systemd-Abfragen der Listenansichten.
+   Der UI-Thread liest nur noch Snapshots und blockiert nie auf systemd.
+   Mit laufendem "sysdash --daemon" (remote.h) kommen die Zeilen von dort. */
+void poller_start(void);
+void poller_stop(void);
+void poller_wake(void);
+void poller_watch(const char **names, int count);
+// Nur diese Favoriten (Index in my_services) jede Runde, der Rest nur im Verlaufstakt
+void poller_view_favorites(int first, int count);
+
+const struct snapshot *poller_snapshot(void);
+// NULL, solange die Unit noch nicht abgefragt ist
+const struct unit_state *snapshot_state(const struct snapshot *snap, int hint, const char *name);
+const struct unit_usage *snapshot_usage(const struct snapshot *snap, int hint, const char *name);
+const struct unit_history *snapshot_history(const struct snapshot *snap, int hint, const char *name);
+
+// Wird lesbar, sobald ein neuer Snapshot bereitliegt
+int  poller_wakeup_fd(void);
+int  poller_drain_wakeup(void);
+
+// Schuetzt Cache und my_services (rekursiv); nie ueber Bus-Aufrufe halten
+void data_lock(void);
+void data_unlock(void);
+
+#endif
@@ -0,0 +1,380 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <limits.h>
+#include <pthread.h>
+
+#include "ports.h"
+#include "cgroup.h"
+
+#define TCP_LISTEN 0x0A
+#define TCP_CLOSE  0x07   // ungebundener/lauschender UDP-Socket
+#define UNIX_ACCEPTCON 0x10000   // __SO_ACCEPTCON: Unix-Socket lauscht
+
+// --------------------------------------------------
+// Socket-Tabelle (sortiert nach Inode)
+// --------------------------------------------------
+/* ports_mutex schuetzt die aktuelle Tabelle und den PID-Cache. Eine neue
+   Tabelle wird ohne Lock eingelesen und nur noch eingehaengt, damit kein
+   Aufrufer hinter dem Einlesen von /proc/net wartet. */
+static pthread_mutex_t ports_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int building = 0;         // ein Thread liest gerade ein, die anderen nehmen die alte
+
+struct sock_table {
+    struct listen_sock *socks;
+    int n;
+    int cap;
+};
+
+static struct listen_sock *socks = NULL;
+static int n_socks = 0;
+static long long built_ms = -1;
+
+// PID -> Socket-Indizes, offene Adressierung, pro Einlesen geleert
+struct pid_slot {
+    long pid;          // 0 = frei
+    int first;         // Start in pid_refs
+    int count;
+};
+static struct pid_slot *pid_table = NULL;
+static int pid_table_size = 0;   // Zweierpotenz
+static int pid_used = 0;
+static int *pid_refs = NULL;
+static int n_refs = 0;
+static int cap_refs = 0;
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int cmp_inode(const void *a, const void *b) {
+    unsigned long ia = ((const struct listen_sock *)a)->inode;
+    unsigned long ib = ((const struct listen_sock *)b)->inode;
+    return (ia > ib) - (ia < ib);
+}
+
+static struct listen_sock *find_inode(unsigned long inode) {
+    struct listen_sock key = { .inode = inode };
+    return bsearch(&key, socks, (size_t)n_socks, sizeof(*socks), cmp_inode);
+}
+
+/* Adresse so wie der Kernel sie ausgibt: Worte im Host-Format, daher
+   direkt in s_addr / s6_addr32 uebernehmen. */
+static void format_addr(const char *hex, int ipv6, char *out, size_t outsize) {
+    if (!ipv6) {
+        struct in_addr a;
+        a.s_addr = (in_addr_t)strtoul(hex, NULL, 16);
+        inet_ntop(AF_INET, &a, out, (socklen_t)outsize);
+        return;
+    }
+
+    struct in6_addr a6;
+    for (int i = 0; i < 4; i++) {
+        char word[9];
+        memcpy(word, hex + i * 8, 8);
+        word[8] = '\0';
+        a6.s6_addr32[i] = (uint32_t)strtoul(word, NULL, 16);
+    }
+    inet_ntop(AF_INET6, &a6, out, (socklen_t)outsize);
+}
+
+static struct listen_sock *new_sock(struct sock_table *t) {
+    if (t->n == t->cap) {
+        int cap = t->cap ? t->cap * 2 : 128;
+        struct listen_sock *p = realloc(t->socks, (size_t)cap * sizeof(*p));
+        if (!p) return NULL;
+        t->socks = p;
+        t->cap = cap;
+    }
+    return &t->socks[t->n++];
+}
+
+static void parse_proc_net(struct sock_table *t, const char *path, int proto, int ipv6) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return;
+
+    char line[512];
+    if (!fgets(line, sizeof(line), fp)) { // Kopfzeile
+        fclose(fp);
+        return;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        char local[64], remote[64];
+        unsigned int state;
+        unsigned long inode;
+        // sl local rem st tx:rx tr:when retrnsmt uid timeout inode
+        if (sscanf(line, " %*d: %63s %63s %x %*s %*s %*s %*u %*u %lu",
+                   local, remote, &state, &inode) != 4) {
+            continue;
+        }
+        if (inode == 0) continue;
+
+        char *lport = strchr(local, ':');
+        char *rport = strchr(remote, ':');
+        if (!lport || !rport) continue;
+        *lport++ = '\0';
+
+        if (proto == PROTO_TCP && state != TCP_LISTEN) continue;
+        if (proto == PROTO_UDP && (state != TCP_CLOSE || strtoul(rport + 1, NULL, 16) != 0))
+            continue;
+
+        struct listen_sock *s = new_sock(t);
+        if (!s) break;
+        s->inode = inode;
+        s->proto = proto;
+        s->ipv6  = ipv6;
+        s->port  = (unsigned short)strtoul(lport, NULL, 16);
+        format_addr(local, ipv6, s->addr, sizeof(s->addr));
+    }
+    fclose(fp);
+}
+
+// Num RefCount Protocol Flags Type St Inode [Path]
+static void parse_proc_net_unix(struct sock_table *t) {
+    FILE *fp = fopen("/proc/net/unix", "r");
+    if (!fp) return;
+
+    char line[512];
+    if (!fgets(line, sizeof(line), fp)) {
+        fclose(fp);
+        return;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        unsigned long flags, inode;
+        char path[LISTEN_ADDR_LEN] = "";
+        if (sscanf(line, "%*s %*x %*x %lx %*x %*x %lu %107s", &flags, &inode, path) < 2) {
+            continue;
+        }
+        if (!(flags & UNIX_ACCEPTCON) || inode == 0) continue;
+
+        struct listen_sock *s = new_sock(t);
+        if (!s) break;
+        s->inode = inode;
+        s->proto = PROTO_UNIX;
+        s->ipv6  = 0;
+        s->port  = 0;
+        snprintf(s->addr, sizeof(s->addr), "%s", path[0] ? path : "(anonym)");
+    }
+    fclose(fp);
+}
+
+void port_index_refresh(int max_age_ms) {
+    long long now = now_ms();
+    pthread_mutex_lock(&ports_mutex);
+    int stale = !building && (built_ms < 0 || now - built_ms >= max_age_ms);
+    if (stale) building = 1;
+    pthread_mutex_unlock(&ports_mutex);
+    if (!stale) return;
+
+    struct sock_table t = { NULL, 0, 0 };
+    parse_proc_net(&t, "/proc/net/tcp",  PROTO_TCP, 0);
+    parse_proc_net(&t, "/proc/net/tcp6", PROTO_TCP, 1);
+    parse_proc_net(&t, "/proc/net/udp",  PROTO_UDP, 0);
+    parse_proc_net(&t, "/proc/net/udp6", PROTO_UDP, 1);
+    parse_proc_net_unix(&t);
+    qsort(t.socks, (size_t)t.n, sizeof(*t.socks), cmp_inode);
+
+    // Einhaengen; der PID-Cache zeigt in die alte Tabelle und faellt mit
+    pthread_mutex_lock(&ports_mutex);
+    struct listen_sock *old = socks;
+    socks = t.socks;
+    n_socks = t.n;
+    if (pid_table) memset(pid_table, 0, (size_t)pid_table_size * sizeof(*pid_table));
+    pid_used = 0;
+    n_refs = 0;
+    built_ms = now;
+    building = 0;
+    pthread_mutex_unlock(&ports_mutex);
+    free(old);
+}
+
+// --------------------------------------------------
+// PID -> Sockets
+// --------------------------------------------------
+static struct pid_slot *slot_for(long pid) {
+    unsigned long h = (unsigned long)pid * 2654435761UL;
+    int mask = pid_table_size - 1;
+    for (int i = (int)(h & (unsigned long)mask); ; i = (i + 1) & mask) {
+        if (pid_table[i].pid == pid || pid_table[i].pid == 0) return &pid_table[i];
+    }
+}
+
+static int pid_table_grow(void) {
+    int old_size = pid_table_size;
+    struct pid_slot *old = pid_table;
+
+    pid_table_size = old_size ? old_size * 2 : 64;
+    pid_table = calloc((size_t)pid_table_size, sizeof(*pid_table));
+    if (!pid_table) {
+        pid_table = old;
+        pid_table_size = old_size;
+        return -1;
+    }
+    for (int i = 0; i < old_size; i++) {
+        if (old[i].pid != 0) *slot_for(old[i].pid) = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+static void add_ref(int idx) {
+    if (n_refs == cap_refs) {
+        int cap = cap_refs ? cap_refs * 2 : 128;
+        int *p = realloc(pid_refs, (size_t)cap * sizeof(*p));
+        if (!p) return;
+        pid_refs = p;
+        cap_refs = cap;
+    }
+    pid_refs[n_refs++] = idx;
+}
+
+// Einmal pro Einlesen: /proc/<pid>/fd nach "socket:[inode]" durchsuchen
+static struct pid_slot *scan_pid(long pid) {
+    if ((pid_used + 1) * 2 > pid_table_size && pid_table_grow() != 0) return NULL;
+
+    struct pid_slot *slot = slot_for(pid);
+    if (slot->pid == pid) return slot;
+
+    slot->pid = pid;
+    slot->first = n_refs;
+    slot->count = 0;
+    pid_used++;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%ld/fd", pid);
+    DIR *dir = opendir(path);
+    if (!dir) return slot;
+
+    int dfd = dirfd(dir);
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+
+        char link[64];
+        ssize_t n = readlinkat(dfd, entry->d_name, link, sizeof(link) - 1);
+        if (n <= 8 || strncmp(link, "socket:[", 8) != 0) continue;
+        link[n] = '\0';
+
+        struct listen_sock *s = find_inode(strtoul(link + 8, NULL, 10));
+        if (s) {
+            add_ref((int)(s - socks));
+            slot->count = n_refs - slot->first;
+        }
+    }
+    closedir(dir);
+    return slot;
+}
+
+int port_index_pid(long pid, struct listen_sock *out, int max) {
+    if (pid <= 0) return 0;
+
+    pthread_mutex_lock(&ports_mutex);
+    struct pid_slot *slot = built_ms >= 0 ? scan_pid(pid) : NULL;
+    int n = 0;
+    for (int i = 0; slot && i < slot->count && n < max; i++) {
+        out[n++] = socks[pid_refs[slot->first + i]];
+    }
+    pthread_mutex_unlock(&ports_mutex);
+    return n;
+}
+
+// --------------------------------------------------
+// Cgroup -> Sockets
+// --------------------------------------------------
+struct cg_result {
+    const struct listen_sock **out;
+    int max;
+    int n;
+};
+
+static void add_unique(struct cg_result *res, const struct listen_sock *s) {
+    for (int i = 0; i < res->n; i++) {
+        if (res->out[i] == s) return; // Prefork-Worker teilen sich den Socket
+    }
+    if (res->n < res->max) res->out[res->n++] = s;
+}
+
+static void add_pid(struct cg_result *res, long pid) {
+    struct pid_slot *slot = scan_pid(pid);
+    if (!slot) return;
+    for (int i = 0; i < slot->count; i++) {
+        add_unique(res, &socks[pid_refs[slot->first + i]]);
+    }
+}
+
+static void add_pid_cb(long pid, void *arg) {
+    add_pid(arg, pid);
+}
+
+static int cmp_sock(const void *a, const void *b) {
+    const struct listen_sock *sa = *(const struct listen_sock *const *)a;
+    const struct listen_sock *sb = *(const struct listen_sock *const *)b;
+    if (sa->proto != sb->proto) return sa->proto - sb->proto;
+    if (sa->port != sb->port) return (int)sa->port - (int)sb->port;
+    return strcmp(sa->addr, sb->addr);
+}
+
+int port_index_cgroup(const char *cgroup, long main_pid,
+                      struct listen_sock *out, int max) {
+    if (!out || max <= 0) return 0;
+    const struct listen_sock **found = malloc((size_t)max * sizeof(*found));
+    if (!found) return 0;
+
+    pthread_mutex_lock(&ports_mutex);
+    struct cg_result res = { found, max, 0 };
+    if (built_ms >= 0) {
+        int walked = -1;
+        char dir[PATH_MAX];
+        if (cgroup_resolve(cgroup, dir, sizeof(dir)) > 0) {
+            walked = cgroup_walk_pids(dir, add_pid_cb, &res);
+        }
+        if (walked != 0 && main_pid > 0) {
+            add_pid(&res, main_pid);
+        }
+    }
+    qsort(found, (size_t)res.n, sizeof(*found), cmp_sock);
+    // Kopien: die Tabelle kann nach dem Unlock ersetzt werden
+    for (int i = 0; i < res.n; i++) out[i] = *found[i];
+    pthread_mutex_unlock(&ports_mutex);
+
+    free(found);
+    return res.n;
+}
+
+void port_collect(const struct listen_sock *list, int n, struct unit_ports *out) {
+    memset(out, 0, sizeof(*out));
+    // Liste ist sortiert: erster Inet-Socket = kleinster TCP-Port
+    for (int i = 0; i < n; i++) {
+        if (list[i].proto == PROTO_UNIX) {
+            if (out->n_unix < 255) out->n_unix++;
+            continue;
+        }
+        int seen = 0;
+        for (int k = 0; k < i && !seen; k++) {
+            seen = (list[k].proto != PROTO_UNIX && list[k].port == list[i].port);
+        }
+        if (seen) continue;
+        if (out->n < UNIT_PORTS_MAX) out->port[out->n] = list[i].port;
+        if (out->n < 255) out->n++;
+    }
+}
+
+void port_format_compact(const struct unit_ports *p, char *buf, size_t bufsize) {
+    if (p->n > 1)
+        snprintf(buf, bufsize, "%d+%d", p->port[0], p->n - 1);
+    else if (p->n == 1)
+        snprintf(buf, bufsize, "%d", p->port[0]);
+    else if (p->n_unix > 0)
+        snprintf(buf, bufsize, "unix");
+    else
+        snprintf(buf, bufsize, "-");
+}
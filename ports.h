@@ -0,0 +1,50 @@
+#ifndef PORTS_H
+#define PORTS_H
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define PROTO_TCP  0
+#define PROTO_UDP  1
+#define PROTO_UNIX 2
+
+#define LISTEN_ADDR_LEN 108          // reicht fuer IPv6 und sun_path
+
+// Lauschender Socket aus /proc/net/{tcp,tcp6,udp,udp6,unix}
+struct listen_sock {
+    unsigned long inode;
+    int proto;                       // PROTO_TCP / PROTO_UDP / PROTO_UNIX
+    int ipv6;
+    unsigned short port;             // 0 bei PROTO_UNIX
+    char addr[LISTEN_ADDR_LEN];      // Bind-Adresse bzw. Socket-Pfad
+};
+
+/* Port-Index: /proc/net/{tcp,udp,unix} wird hoechstens alle max_age_ms neu eingelesen,
+   PID -> Sockets wird pro Einlesen einmal per /proc/<pid>/fd aufgeloest.
+   Threadsicher mit eigenem Lock; nie unter data_lock() aufrufen.
+   Ergebnisse sind Kopien, da der Index beim naechsten Einlesen ersetzt wird. */
+void port_index_refresh(int max_age_ms);
+int  port_index_pid(long pid, struct listen_sock *out, int max);
+
+/* Alle Sockets einer Unit: jede PID aus cgroup.procs der Cgroup und ihrer
+   Unter-Cgroups, ohne Duplikate, sortiert (TCP, UDP, Unix; dann Port).
+   Ohne lesbare Cgroup wird nur main_pid betrachtet. */
+int  port_index_cgroup(const char *cgroup, long main_pid,
+                       struct listen_sock *out, int max);
+
+// Ports einer Unit als Zahlen, fuer Cache und Snapshot
+#define UNIT_PORTS_MAX 4
+
+struct unit_ports {
+    unsigned short port[UNIT_PORTS_MAX];  // verschiedene Inet-Ports, kleinster TCP-Port zuerst
+    unsigned char n;                      // Anzahl verschiedener Inet-Ports (auch > UNIT_PORTS_MAX)
+    unsigned char n_unix;                 // Unix-Sockets, bei 255 gekappt
+};
+
+// Aus einer sortierten Liste von port_index_cgroup(); gleicher Port auf v4/v6, TCP/UDP zaehlt einmal
+void port_collect(const struct listen_sock *socks, int n, struct unit_ports *out);
+
+// Kompakt fuer die PORT-Spalte: "-", "8080", "8080+2", "unix"
+void port_format_compact(const struct unit_ports *ports, char *buf, size_t bufsize);
+
+#endif
@@ -0,0 +1,235 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "remote.h"
+#include "wire.h"
+#include "strpool.h"
+
+// Letzter Stand je Zeile des aktuellen Abos
+struct remote_row {
+    const char *name;              // String-Pool
+    struct unit_state state;
+    struct unit_usage usage;
+    struct unit_history *hist;     // erst beim ersten Verlauf angelegt
+};
+
+static int sock = -1;
+static uint32_t sub_id = 0;
+static struct remote_row *rows = NULL;
+static int row_count = 0;
+static int row_nfav = 0;
+static const char **keep_names = NULL;   // zuletzt geschickte keep-Liste
+static int keep_count = 0;
+static struct wire_buf inbuf;
+static struct wire_buf outbuf;
+
+// --------------------------------------------------
+// Verbindung
+// --------------------------------------------------
+int remote_socket_path(char *out, size_t size) {
+    const char *env = getenv(WIRE_SOCKET_ENV);
+    if (env && env[0]) {
+        snprintf(out, size, "%s", env);
+        return 0;
+    }
+    if (geteuid() == 0) {
+        snprintf(out, size, "%s", WIRE_SOCKET_SYS);
+        return 0;
+    }
+    const char *run = getenv("XDG_RUNTIME_DIR");
+    if (!run || !run[0]) return -1;
+    snprintf(out, size, "%s/sysdash.sock", run);
+    return 0;
+}
+
+/* Nur ein Daemon desselben Benutzers sieht dessen User-Units: bei einem
+   fremden (z.B. root auf /run/sysdash.sock) stuenden sie als not-found da */
+static int peer_is_self(int fd) {
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) return 0;
+    return cred.uid == geteuid();
+}
+
+static int connect_path(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || !peer_is_self(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int remote_connect(void) {
+    if (sock >= 0) return 0;
+
+    // Nur der eigene Daemon; laeuft er unter anderer uid, lokal sammeln
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    if (remote_socket_path(path, sizeof(path)) == 0) sock = connect_path(path);
+    return sock >= 0 ? 0 : -1;
+}
+
+int remote_active(void) {
+    return sock >= 0;
+}
+
+int remote_fd(void) {
+    return sock;
+}
+
+void remote_close(void) {
+    if (sock >= 0) close(sock);
+    sock = -1;
+    for (int i = 0; i < row_count; i++) free(rows[i].hist);
+    free(rows);
+    rows = NULL;
+    row_count = row_nfav = 0;
+    free(keep_names);
+    keep_names = NULL;
+    keep_count = 0;
+    wire_buf_free(&inbuf);
+    wire_buf_free(&outbuf);
+}
+
+// --------------------------------------------------
+// Abo
+// --------------------------------------------------
+static void row_reset(struct remote_row *r, const char *name) {
+    memset(r, 0, sizeof(*r));
+    r->name = name;
+    r->state.desc = "";
+    r->usage = (struct unit_usage)UNIT_USAGE_UNKNOWN;
+}
+
+int remote_subscribe(const char **names, int count, int nfav, const char **keep, int nkeep) {
+    if (sock < 0) return -1;
+    if (count > WIRE_MAX_NAMES) count = WIRE_MAX_NAMES;
+    if (nfav > count) nfav = count;
+    if (nkeep > WIRE_MAX_NAMES) nkeep = WIRE_MAX_NAMES;
+
+    int same = (count == row_count && nfav == row_nfav && nkeep == keep_count);
+    for (int i = 0; same && i < count; i++) same = (rows[i].name == names[i]);
+    for (int i = 0; same && i < nkeep; i++) same = (keep_names[i] == keep[i]);
+    if (same) return wire_flush(sock, &outbuf) < 0 ? -1 : 0;
+
+    struct remote_row *next = calloc((size_t)(count ? count : 1), sizeof(*next));
+    const char **next_keep = malloc((size_t)(nkeep ? nkeep : 1) * sizeof(*next_keep));
+    if (!next || !next_keep) {
+        free(next);
+        free(next_keep);
+        return 0;   // beim naechsten Mal wieder versuchen
+    }
+    if (nkeep > 0) memcpy(next_keep, keep, (size_t)nkeep * sizeof(*keep));
+
+    // Bekannte Zeilen behalten, bis die Antwort auf das neue Abo da ist
+    for (int i = 0; i < count; i++) {
+        row_reset(&next[i], names[i]);
+        for (int j = 0; j < row_count; j++) {
+            if (rows[j].name != names[i]) continue;
+            next[i] = rows[j];
+            rows[j].hist = NULL;
+            rows[j].name = NULL;
+            break;
+        }
+        if (i >= nfav && next[i].hist) {
+            free(next[i].hist);
+            next[i].hist = NULL;
+        }
+    }
+    for (int j = 0; j < row_count; j++) free(rows[j].hist);
+    free(rows);
+    rows = next;
+    row_count = count;
+    row_nfav = nfav;
+    free(keep_names);
+    keep_names = next_keep;
+    keep_count = nkeep;
+
+    size_t start = wire_begin(&outbuf, WIRE_SUBSCRIBE);
+    wire_put_u32(&outbuf, ++sub_id);
+    wire_put_u16(&outbuf, (unsigned)count);
+    wire_put_u16(&outbuf, (unsigned)nfav);
+    for (int i = 0; i < count; i++) wire_put_str(&outbuf, names[i]);
+    wire_put_u16(&outbuf, (unsigned)nkeep);
+    for (int i = 0; i < nkeep; i++) wire_put_str(&outbuf, keep[i]);
+    wire_end(&outbuf, start);
+    if (outbuf.err) return -1;
+
+    return wire_flush(sock, &outbuf) < 0 ? -1 : 0;
+}
+
+// --------------------------------------------------
+// Empfang
+// --------------------------------------------------
+static int apply_update(struct wire_reader *r) {
+    // Antworten auf ein ueberholtes Abo: Indizes passen nicht mehr
+    if (wire_get_u32(r) != sub_id) return 0;
+
+    int nrows = (int)wire_get_u16(r);
+    int changed = 0;
+    for (int k = 0; k < nrows && !r->err; k++) {
+        int i = (int)wire_get_u16(r);
+        int flags = (int)wire_get_u8(r);
+        if (i >= row_count) return -1;
+
+        struct remote_row *row = &rows[i];
+        if (flags & WIRE_ROW_STATE) wire_get_state(r, &row->state);
+        if (flags & WIRE_ROW_USAGE) wire_get_usage(r, &row->usage);
+        if (flags & WIRE_ROW_HIST) {
+            if (!row->hist) {
+                row->hist = calloc(1, sizeof(*row->hist));
+                if (!row->hist) return -1;
+            }
+            wire_get_hist(r, flags, row->hist);
+        }
+        changed++;
+    }
+    return r->err ? -1 : changed;
+}
+
+int remote_receive(void) {
+    if (sock < 0) return -1;
+    if (wire_flush(sock, &outbuf) < 0 || wire_fill(sock, &inbuf) < 0) return -1;
+
+    struct wire_hdr hdr;
+    struct wire_reader body;
+    size_t pos = 0;
+    int changed = 0;
+    int ret;
+    while ((ret = wire_next(&inbuf, &pos, &hdr, &body)) > 0) {
+        if (hdr.type != WIRE_UPDATE) continue;
+        int n = apply_update(&body);
+        if (n < 0) return -1;
+        changed += n;
+    }
+    if (ret < 0) return -1;
+    wire_consume(&inbuf, pos);
+    return changed;
+}
+
+int remote_row(int i, struct unit_state *st, struct unit_usage *usage, struct unit_history *hist) {
+    if (i < 0 || i >= row_count) {
+        memset(st, 0, sizeof(*st));
+        st->desc = "";
+        *usage = (struct unit_usage)UNIT_USAGE_UNKNOWN;
+        return 0;
+    }
+    *st = rows[i].state;
+    *usage = rows[i].usage;
+    if (!hist || !rows[i].hist || rows[i].hist->count == 0) return 0;
+    memcpy(hist, rows[i].hist, sizeof(*hist));
+    return 1;
+}
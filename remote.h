@@ -0,0 +1,38 @@
+#ifndef REMOTE_H
+#define REMOTE_H
+
+#include <stddef.h>
+
+#include "stats.h"
+#include "history.h"
+#include "unitstate.h"
+
+/* Client-Seite von "sysdash --daemon" (wire.h). Laeuft ein Daemon,
+   liefert er Zustaende, CPU/RSS und Verlauf fuer die Listen; der Poller
+   sammelt dann nichts mehr selbst, sondern abonniert nur seine Zeilen.
+   Nur aus dem Poller-Thread (bzw. vor poller_start()). */
+
+// Verbindet mit $SYSDASH_SOCKET, sonst /run/sysdash.sock (root) bzw. $XDG_RUNTIME_DIR/sysdash.sock.
+// Nur zu einem Daemon derselben uid. Rueckgabe: 0 = Daemon da, -1 = lokal sammeln
+int  remote_connect(void);
+int  remote_active(void);
+int  remote_fd(void);
+void remote_close(void);
+
+/* Abo: names[0..count), die ersten nfav mit CPU/RSS/Verlauf; keep[0..nkeep)
+   nur Verlauf weiterfuehren, ohne Zeilen. Gleiche Listen = kein Verkehr.
+   Rueckgabe: 0 / -1 (Verbindung weg) */
+int  remote_subscribe(const char **names, int count, int nfav, const char **keep, int nkeep);
+
+// Liest alles Anstehende. Rueckgabe: Anzahl geaenderter Zeilen, -1 = Verbindung weg
+int  remote_receive(void);
+
+/* Stand der Zeile i des aktuellen Abos. st->scope bleibt UNIT_SCOPE_UNKNOWN,
+   solange der Daemon noch nichts geschickt hat; hist darf NULL sein.
+   Rueckgabe: 1 = Verlauf vorhanden, sonst 0 */
+int  remote_row(int i, struct unit_state *st, struct unit_usage *usage, struct unit_history *hist);
+
+// Socket-Pfad, an dem "sysdash --daemon" lauscht
+int  remote_socket_path(char *out, size_t size);
+
+#endif
@@ -0,0 +1,285 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "spawn.h"
+
+extern char **environ;
+
+#define SPAWN_READ_CHUNK 4096
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int remaining_ms(long long deadline) {
+    if (deadline <= 0) return -1; // unbegrenzt
+    long long left = deadline - now_ms();
+    return left > 0 ? (int)left : 0;
+}
+
+// --------------------------------------------------
+// stdout lesen (wachsender Puffer, Deadline)
+// --------------------------------------------------
+/* Rueckgabe: 0 = EOF, SPAWN_TIMEOUT, SPAWN_ERROR */
+static int read_all(int fd, long long deadline, char **buf, size_t *len) {
+    size_t cap = SPAWN_READ_CHUNK;
+    size_t used = 0;
+    char *data = malloc(cap);
+    if (!data) return SPAWN_ERROR;
+
+    for (;;) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN, .revents = 0 };
+        int r = poll(&pfd, 1, remaining_ms(deadline));
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            free(data);
+            return SPAWN_ERROR;
+        }
+        if (r == 0) {
+            *buf = data;
+            *len = used;
+            data[used] = '\0';
+            return SPAWN_TIMEOUT;
+        }
+
+        if (cap - used < SPAWN_READ_CHUNK + 1) {
+            char *p = realloc(data, cap * 2);
+            if (!p) {
+                free(data);
+                return SPAWN_ERROR;
+            }
+            data = p;
+            cap *= 2;
+        }
+
+        ssize_t n = read(fd, data + used, cap - used - 1);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            free(data);
+            return SPAWN_ERROR;
+        }
+        if (n == 0) break; // EOF
+        used += (size_t)n;
+    }
+
+    data[used] = '\0';
+    *buf = data;
+    *len = used;
+    return 0;
+}
+
+// --------------------------------------------------
+// Warten mit Deadline
+// --------------------------------------------------
+/* waitpid hat keinen Timeout -> WNOHANG mit wachsendem Intervall
+   (1ms .. 50ms). Nach EOF auf stdout ist das Kind meist schon fertig. */
+static int wait_child(pid_t pid, long long deadline, int *status) {
+    long sleep_us = 1000;
+
+    for (;;) {
+        pid_t r = waitpid(pid, status, deadline > 0 ? WNOHANG : 0);
+        if (r == pid) return 0;
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return SPAWN_ERROR;
+        }
+        if (remaining_ms(deadline) == 0) return SPAWN_TIMEOUT;
+
+        struct timespec ts = { 0, sleep_us * 1000 };
+        nanosleep(&ts, NULL);
+        if (sleep_us < 50000) sleep_us *= 2;
+    }
+}
+
+static void kill_child(pid_t pid, int own_group) {
+    kill(own_group ? -pid : pid, SIGKILL);
+    while (waitpid(pid, NULL, 0) < 0 && errno == EINTR)
+        ;
+}
+
+// --------------------------------------------------
+// spawn_cmd
+// --------------------------------------------------
+int spawn_cmd(const char *const argv[], int flags, int timeout_ms,
+              char **output, size_t *output_len) {
+    if (!argv || !argv[0]) return SPAWN_ERROR;
+    if (output) *output = NULL;
+    if (output_len) *output_len = 0;
+
+    int capture     = (flags & SPAWN_CAPTURE) && output;
+    int interactive = (flags & SPAWN_INTERACTIVE) != 0;
+    int pipefd[2]   = { -1, -1 };
+
+    if (capture && pipe2(pipefd, O_CLOEXEC) != 0) return SPAWN_ERROR;
+
+    posix_spawn_file_actions_t fa;
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_init(&fa);
+    posix_spawnattr_init(&attr);
+
+    if (!interactive) {
+        posix_spawn_file_actions_addopen(&fa, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    }
+    if (capture) {
+        posix_spawn_file_actions_adddup2(&fa, pipefd[1], STDOUT_FILENO);
+    } else if (flags & SPAWN_QUIET) {
+        posix_spawn_file_actions_addopen(&fa, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+    if (flags & SPAWN_QUIET) {
+        posix_spawn_file_actions_addopen(&fa, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+
+    // Kind startet mit Standard-Signalen. Abfragen (CAPTURE) laufen in eigener
+    // Prozessgruppe, damit ein Timeout auch Enkel trifft; Aktionen bleiben im
+    // Vordergrund, sonst koennte sudo nicht ueber /dev/tty fragen.
+    int own_group = capture && !interactive;
+    sigset_t all, empty;
+    sigfillset(&all);
+    sigemptyset(&empty);
+    short attr_flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+    if (own_group) {
+        attr_flags |= POSIX_SPAWN_SETPGROUP;
+        posix_spawnattr_setpgroup(&attr, 0);
+    }
+    posix_spawnattr_setsigmask(&attr, &empty);
+    posix_spawnattr_setsigdefault(&attr, &all);
+    posix_spawnattr_setflags(&attr, attr_flags);
+
+    // Wie system(): waehrend interaktiver Kinder SIGINT/SIGQUIT ignorieren
+    struct sigaction ign, old_int, old_quit;
+    if (interactive) {
+        memset(&ign, 0, sizeof(ign));
+        ign.sa_handler = SIG_IGN;
+        sigaction(SIGINT, &ign, &old_int);
+        sigaction(SIGQUIT, &ign, &old_quit);
+    }
+
+    pid_t pid;
+    int err = posix_spawnp(&pid, argv[0], &fa, &attr, (char *const *)argv, environ);
+
+    posix_spawn_file_actions_destroy(&fa);
+    posix_spawnattr_destroy(&attr);
+    if (capture) close(pipefd[1]);
+
+    int ret = SPAWN_ERROR;
+    if (err != 0) {
+        if (capture) close(pipefd[0]);
+        goto out;
+    }
+
+    long long deadline = timeout_ms > 0 ? now_ms() + timeout_ms : 0;
+
+    if (capture) {
+        char *buf = NULL;
+        size_t len = 0;
+        int r = read_all(pipefd[0], deadline, &buf, &len);
+        close(pipefd[0]);
+        if (r != 0) {
+            free(buf);
+            kill_child(pid, own_group);
+            ret = r;
+            goto out;
+        }
+        *output = buf;
+        if (output_len) *output_len = len;
+    }
+
+    int status = 0;
+    int r = wait_child(pid, deadline, &status);
+    if (r != 0) {
+        if (r == SPAWN_TIMEOUT) kill_child(pid, own_group);
+        if (capture) {
+            free(*output);
+            *output = NULL;
+            if (output_len) *output_len = 0;
+        }
+        ret = r;
+        goto out;
+    }
+
+    if (WIFEXITED(status))        ret = WEXITSTATUS(status);
+    else if (WIFSIGNALED(status)) ret = SPAWN_SIGNALED;
+
+out:
+    if (interactive) {
+        sigaction(SIGINT, &old_int, NULL);
+        sigaction(SIGQUIT, &old_quit, NULL);
+    }
+    return ret;
+}
+
+// --------------------------------------------------
+// spawn_detached
+// --------------------------------------------------
+/* Zwischen fork und exec nur async-signal-sichere Aufrufe: der Elternprozess
+   hat Threads. Scheitert exec, schreibt der Enkel errno in die Pipe; bei
+   Erfolg schliesst O_CLOEXEC sie und der Elternprozess liest EOF. */
+int spawn_detached(const char *const argv[]) {
+    if (!argv || !argv[0]) return SPAWN_ERROR;
+
+    int errpipe[2];
+    if (pipe2(errpipe, O_CLOEXEC) != 0) return SPAWN_ERROR;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(errpipe[0]);
+        close(errpipe[1]);
+        return SPAWN_ERROR;
+    }
+    if (pid == 0) {
+        close(errpipe[0]);
+        setsid();
+        pid_t grandchild = fork();
+        if (grandchild == 0) {
+            // Wie spawn_cmd(): leere Maske, Standard-Signale
+            sigset_t empty;
+            sigemptyset(&empty);
+            sigprocmask(SIG_SETMASK, &empty, NULL);
+            struct sigaction dfl;
+            memset(&dfl, 0, sizeof(dfl));
+            dfl.sa_handler = SIG_DFL;
+            for (int sig = 1; sig < NSIG; sig++) sigaction(sig, &dfl, NULL);
+
+            int fd = open("/dev/null", O_RDWR);
+            if (fd >= 0) {
+                dup2(fd, STDIN_FILENO);
+                dup2(fd, STDOUT_FILENO);
+                dup2(fd, STDERR_FILENO);
+                if (fd > STDERR_FILENO) close(fd);
+            }
+            execvp(argv[0], (char *const *)argv);
+            int e = errno;
+            ssize_t w = write(errpipe[1], &e, sizeof(e));
+            (void)w;
+            _exit(127);
+        }
+        _exit(grandchild < 0 ? 1 : 0);
+    }
+
+    close(errpipe[1]);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+        ;
+
+    int e = 0;
+    ssize_t n;
+    while ((n = read(errpipe[0], &e, sizeof(e))) < 0 && errno == EINTR)
+        ;
+    close(errpipe[0]);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || n > 0) return SPAWN_ERROR;
+    return 0;
+}
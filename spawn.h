@@ -0,0 +1,30 @@
+#ifndef SPAWN_H
+#define SPAWN_H
+
+#include <stddef.h>
+
+// Flags fuer spawn_cmd()
+#define SPAWN_CAPTURE     0x1   // stdout in *output einsammeln
+#define SPAWN_QUIET       0x2   // stderr (und nicht eingesammeltes stdout) nach /dev/null
+#define SPAWN_INTERACTIVE 0x4   // Terminal erben, SIGINT/SIGQUIT wie system() behandeln
+
+// Rueckgabewerte < 0
+#define SPAWN_ERROR    (-1)     // Start fehlgeschlagen (z.B. Programm fehlt)
+#define SPAWN_TIMEOUT  (-2)     // Deadline ueberschritten, Kind wurde gekillt
+#define SPAWN_SIGNALED (-3)     // Kind durch Signal beendet
+
+/* Startet argv[0] per posix_spawnp, ohne Shell.
+   timeout_ms <= 0: keine Deadline (nur fuer interaktive Aufrufe).
+   Mit SPAWN_CAPTURE wird stdout in einen wachsenden Puffer gelesen;
+   *output ist danach NUL-terminiert und muss mit free() freigegeben werden.
+   Rueckgabe: Exit-Status (0..255) oder SPAWN_* < 0 */
+int spawn_cmd(const char *const argv[], int flags, int timeout_ms,
+              char **output, size_t *output_len);
+
+/* Startet argv[0] losgeloest (z.B. xdg-open): Doppel-fork, eigene Session,
+   stdin/stdout/stderr auf /dev/null. Kein Warten und keine Deadline, den
+   Enkel raeumt init ab. Gewartet wird nur, bis exec geklappt hat.
+   Rueckgabe: 0 oder SPAWN_ERROR (Programm fehlt, fork fehlgeschlagen) */
+int spawn_detached(const char *const argv[]);
+
+#endif
@@ -0,0 +1,348 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include <time.h>
+
+#include "stats.h"
+#include "cgroup.h"
+#include "history.h"
+#include "sys_dashboard.h"
+
+// Woher der CPU-Zaehler stammt; Wechsel = kein gueltiges Delta
+#define SRC_NONE    0
+#define SRC_CPUSTAT 1   // cgroup v2 cpu.stat usage_usec
+#define SRC_PIDS    2   // Summe utime+stime aller PIDs
+
+// Ohne laufende Unit (keine Cgroup) hoechstens so oft neu oeffnen
+#define STATS_REOPEN_MS 5000
+
+/* So lange weder abgetastet noch per stats_track() angefasst: Eintrag samt
+   offenen Cgroup-fds und Verlauf weg (bei 1s-Runden also 60 Runden) */
+#define STATS_EXPIRE_MS 60000
+
+/* Proben kommen nie exakt im Verlaufstakt (Poller-Runden, Abfragedauer):
+   so viel frueher zaehlt noch als faellig */
+#define STATS_HIST_SLACK_MS 500
+
+struct stats_entry {
+    char *name;                  // NULL = frei
+    char cgroup[MAX_CGROUP];
+    long main_pid;
+    struct cgroup_handle cg;     // offene v2-Dateien
+    long long reopen_ms;         // letzter Oeffnungsversuch, < 0 = sofort
+    int src;
+    unsigned long long prev_usec;
+    unsigned long long prev_io;  // rbytes+wbytes
+    int prev_io_valid;
+    long long prev_ms;           // < 0 = keine vorige Probe
+    struct unit_usage usage;
+    struct unit_history *hist;   // erst bei der ersten Probe angelegt
+    long long hist_ms;           // letzter Eintrag in hist
+    long long used_ms;           // letzte Probe bzw. stats_track()
+};
+
+static struct stats_entry *table = NULL;
+static size_t table_size = 0;    // Zweierpotenz
+static size_t table_used = 0;
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// --------------------------------------------------
+// Tabelle Unit-Name -> Eintrag
+// --------------------------------------------------
+static unsigned long hash_name(const char *s) {
+    unsigned long h = 2166136261UL;
+    for (; *s; s++) {
+        h ^= (unsigned char)*s;
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static struct stats_entry *slot_in(struct stats_entry *t, size_t size, const char *name) {
+    size_t mask = size - 1;
+    for (size_t i = hash_name(name) & mask; ; i = (i + 1) & mask) {
+        if (!t[i].name || strcmp(t[i].name, name) == 0) return &t[i];
+    }
+}
+
+static struct stats_entry *find_entry(const char *name) {
+    if (table_used == 0) return NULL;
+    struct stats_entry *e = slot_in(table, table_size, name);
+    return e->name ? e : NULL;
+}
+
+static int table_grow(void) {
+    size_t size = table_size ? table_size * 2 : 64;
+    struct stats_entry *t = calloc(size, sizeof(*t));
+    if (!t) return -1;
+
+    for (size_t i = 0; i < table_size; i++) {
+        if (table[i].name) *slot_in(t, size, table[i].name) = table[i];
+    }
+    free(table);
+    table = t;
+    table_size = size;
+    return 0;
+}
+
+/* Entfernt Slot i samt offenen fds und Verlauf. Lineares Sondieren:
+   spaetere Eintraege derselben Kette ruecken nach, damit keine Suche
+   an der neuen Luecke abbricht. */
+static void table_remove(size_t i) {
+    cgroup_close(&table[i].cg);
+    free(table[i].hist);
+    free(table[i].name);
+    memset(&table[i], 0, sizeof(table[i]));
+    table_used--;
+
+    size_t mask = table_size - 1;
+    for (size_t j = (i + 1) & mask; table[j].name; j = (j + 1) & mask) {
+        size_t home = hash_name(table[j].name) & mask;
+        // Bleibt, wenn sein Stammplatz zyklisch in (i, j] liegt
+        int stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (stays) continue;
+        table[i] = table[j];
+        memset(&table[j], 0, sizeof(table[j]));
+        i = j;
+    }
+}
+
+// --------------------------------------------------
+// Zaehler lesen
+// --------------------------------------------------
+struct pid_sum {
+    unsigned long long ticks;
+    long rss_pages;
+    int n;
+};
+
+static void add_pid_usage(long pid, void *arg) {
+    struct pid_sum *sum = arg;
+    char path[64];
+    char buf[512];
+
+    snprintf(path, sizeof(path), "/proc/%ld/stat", pid);
+    FILE *fp = fopen(path, "r");
+    if (!fp) return;
+    size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    buf[n] = '\0';
+
+    // comm kann Leerzeichen und Klammern enthalten -> ab der letzten ')'
+    char *p = strrchr(buf, ')');
+    unsigned long utime, stime;
+    if (!p || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                     &utime, &stime) != 2) {
+        return;
+    }
+
+    snprintf(path, sizeof(path), "/proc/%ld/statm", pid);
+    fp = fopen(path, "r");
+    long size_pages = 0, rss_pages = 0;
+    if (fp) {
+        if (fscanf(fp, "%ld %ld", &size_pages, &rss_pages) != 2) rss_pages = 0;
+        fclose(fp);
+    }
+
+    sum->ticks += utime + stime;
+    sum->rss_pages += rss_pages;
+    sum->n++;
+}
+
+/* Zaehler einer Unit. cgroup v2: alles aus den offenen fds (pread, keine
+   Allokation). Fehlende Controller bzw. v1: ueber alle PIDs der Cgroup,
+   ohne Cgroup nur MainPID. */
+static int read_usage(struct stats_entry *e, long long now, int *src,
+                      unsigned long long *usec, int *io_valid,
+                      unsigned long long *io, struct unit_usage *u) {
+    *src = SRC_NONE;
+    *io_valid = 0;
+    u->rss_kb = u->tasks = -1;
+    u->psi_cpu = u->psi_memory = u->psi_io = -1;
+
+    if (e->cg.kind < 0 && e->cgroup[0] &&
+        (e->reopen_ms < 0 || now - e->reopen_ms >= STATS_REOPEN_MS)) {
+        e->reopen_ms = now;
+        cgroup_open(&e->cg, e->cgroup);
+    }
+
+    struct cgroup_stats st;
+    if (cgroup_read(&e->cg, &st) == 0) {
+        *src = SRC_CPUSTAT;
+        *usec = st.cpu_usage_usec;
+        if (st.valid & (1u << CG_MEMORY_CURRENT)) u->rss_kb = (long)(st.memory_current / 1024);
+        if (st.valid & (1u << CG_PIDS_CURRENT))   u->tasks = (long)st.pids_current;
+        if (st.valid & (1u << CG_IO_STAT)) {
+            *io = st.io_rbytes + st.io_wbytes;
+            *io_valid = 1;
+        }
+        if (st.valid & (1u << CG_CPU_PRESSURE))    u->psi_cpu = st.cpu_some_avg10;
+        if (st.valid & (1u << CG_MEMORY_PRESSURE)) u->psi_memory = st.memory_some_avg10;
+        if (st.valid & (1u << CG_IO_PRESSURE))     u->psi_io = st.io_some_avg10;
+
+        if (u->rss_kb >= 0 && u->tasks >= 0) return 0;
+    }
+
+    // v1/hybrid oder fehlender Controller: ueber die Prozesse
+    char dir[PATH_MAX];
+    struct pid_sum sum = { 0, 0, 0 };
+    if (cgroup_resolve(e->cgroup, dir, sizeof(dir)) < 0 ||
+        cgroup_walk_pids(dir, add_pid_usage, &sum) != 0) {
+        if (e->main_pid > 0) add_pid_usage(e->main_pid, &sum);
+    }
+    if (sum.n == 0) return *src != SRC_NONE ? 0 : -1;
+
+    if (*src == SRC_NONE) {
+        *usec = sum.ticks * 1000000ULL / (unsigned long long)sysconf(_SC_CLK_TCK);
+        *src = SRC_PIDS;
+    }
+    if (u->rss_kb < 0) u->rss_kb = sum.rss_pages * (sysconf(_SC_PAGESIZE) / 1024);
+    if (u->tasks < 0)  u->tasks = sum.n;
+    return 0;
+}
+
+/* Verlauf im eingestellten Takt fortschreiben (nicht bei jeder Probe).
+   Der Ringpuffer wird einmal angelegt und waechst danach nie.
+   Ausgefallene Takte (Unit eine Weile nicht abgetastet) werden als
+   unbekannt eingetragen, damit der Verlauf keine Zeit verschluckt. */
+static void record_history(struct stats_entry *e, long long now) {
+    long long interval = history_interval_ms();
+    long long due = interval > STATS_HIST_SLACK_MS ? interval - STATS_HIST_SLACK_MS : interval;
+    if (e->hist && now - e->hist_ms < due) return;
+    if (!e->hist) {
+        e->hist = calloc(1, sizeof(*e->hist));
+        if (!e->hist) return;
+    } else {
+        long long missed = (now - e->hist_ms + interval - due) / interval - 1;
+        if (missed > HISTORY_LEN) missed = HISTORY_LEN;
+        struct unit_usage gap = UNIT_USAGE_UNKNOWN;
+        for (long long i = 0; i < missed; i++) history_push(e->hist, &gap);
+    }
+    history_push(e->hist, &e->usage);
+    e->hist_ms = now;
+}
+
+// --------------------------------------------------
+// Oeffentliche Funktionen
+// --------------------------------------------------
+/* Merkt sich Cgroup und MainPID einer Unit (aus der Summary-Abfrage).
+   Geaenderte Quelle -> naechste Probe beginnt ein neues Delta. */
+void stats_track(const char *unit, const char *cgroup, long main_pid) {
+    if (!unit || !unit[0]) return;
+    if (!cgroup) cgroup = "";
+
+    struct stats_entry *e = find_entry(unit);
+    if (!e) {
+        if ((table_used + 1) * 2 > table_size && table_grow() != 0) return;
+        e = slot_in(table, table_size, unit);
+        e->name = strdup(unit);
+        if (!e->name) return;
+        table_used++;
+        cgroup_handle_init(&e->cg);
+        e->reopen_ms = -1;
+        e->prev_ms = -1;
+        e->usage = (struct unit_usage)UNIT_USAGE_UNKNOWN;
+    }
+    e->used_ms = now_ms();
+
+    if (strcmp(e->cgroup, cgroup) != 0) {
+        snprintf(e->cgroup, sizeof(e->cgroup), "%s", cgroup);
+        cgroup_close(&e->cg);
+        e->reopen_ms = -1;
+        e->prev_ms = -1;
+    }
+    if (e->main_pid != main_pid) {
+        e->main_pid = main_pid;
+        if (e->src == SRC_PIDS) e->prev_ms = -1;
+    }
+}
+
+/* Neue Probe. CPU% ist erst ab der zweiten Probe bekannt.
+   Rueckgabe: 0, oder -1 wenn die Unit unbekannt ist bzw. nicht laeuft */
+int stats_sample(const char *unit, struct unit_usage *out) {
+    struct stats_entry *e = unit ? find_entry(unit) : NULL;
+    if (!e) return -1;
+
+    int src, io_valid;
+    unsigned long long usec = 0, io = 0;
+    struct unit_usage u = UNIT_USAGE_UNKNOWN;
+    long long now = now_ms();
+    e->used_ms = now;
+
+    if (read_usage(e, now, &src, &usec, &io_valid, &io, &u) != 0) {
+        e->prev_ms = -1;
+        e->usage = (struct unit_usage)UNIT_USAGE_UNKNOWN;
+        record_history(e, now); // Luecke im Verlauf
+        if (out) *out = e->usage;
+        return -1;
+    }
+
+    if (e->prev_ms >= 0 && now > e->prev_ms) {
+        double dt_ms = (double)(now - e->prev_ms);
+        if (e->src == src) {
+            // Beendete Prozesse fallen aus der PID-Summe -> nie negativ
+            unsigned long long delta = usec > e->prev_usec ? usec - e->prev_usec : 0;
+            u.cpu_pct = (double)delta / (dt_ms * 1000.0) * 100.0;
+        }
+        if (io_valid && e->prev_io_valid) {
+            unsigned long long delta = io > e->prev_io ? io - e->prev_io : 0;
+            u.io_kbps = (double)delta / 1024.0 / (dt_ms / 1000.0);
+        }
+    }
+    e->usage = u;
+    e->src = src;
+    e->prev_usec = usec;
+    e->prev_io = io;
+    e->prev_io_valid = io_valid;
+    e->prev_ms = now;
+    record_history(e, now);
+
+    if (out) *out = e->usage;
+    return 0;
+}
+
+int stats_last(const char *unit, struct unit_usage *out) {
+    struct stats_entry *e = unit ? find_entry(unit) : NULL;
+    if (!e || !out) return -1;
+    *out = e->usage;
+    return 0;
+}
+
+// Eintrag sofort freigeben, z.B. wenn kein Client die Unit mehr abonniert
+void stats_forget(const char *unit) {
+    struct stats_entry *e = unit ? find_entry(unit) : NULL;
+    if (e) table_remove((size_t)(e - table));
+}
+
+/* Kopie des Verlaufs (fuer den Snapshot). Rueckgabe: -1 ohne Verlauf */
+int stats_history(const char *unit, struct unit_history *out) {
+    struct stats_entry *e = unit ? find_entry(unit) : NULL;
+    if (!e || !e->hist || !out) return -1;
+    memcpy(out, e->hist, sizeof(*out));
+    return 0;
+}
+
+/* Raeumt Eintraege ab, die STATS_EXPIRE_MS lang niemand benutzt hat
+   (Browse-Zeilen, entfernte Favoriten). Einmal pro Sammelrunde aufrufen.
+   Rueckgabe: Anzahl entfernter Eintraege */
+int stats_expire(void) {
+    long long now = now_ms();
+    int removed = 0;
+    for (size_t i = 0; i < table_size; ) {
+        if (!table[i].name || now - table[i].used_ms < STATS_EXPIRE_MS) {
+            i++;
+            continue;
+        }
+        table_remove(i);   // Slot i neu pruefen: dorthin kann ein Eintrag nachgerueckt sein
+        removed++;
+    }
+    return removed;
+}
@@ -0,0 +1,32 @@
+#ifndef STATS_H
+#define STATS_H
+
+// Ergebnis einer Probe; < 0 = (noch) unbekannt
+struct unit_usage {
+    double cpu_pct;      // seit der vorigen Probe, 100% = ein Kern
+    long   rss_kb;
+    long   tasks;        // pids.current bzw. Anzahl Prozesse
+    double io_kbps;      // gelesen+geschrieben seit der vorigen Probe (nur v2)
+    double psi_cpu;      // PSI "some avg10" in % (nur v2)
+    double psi_memory;
+    double psi_io;
+};
+
+#define UNIT_USAGE_UNKNOWN { -1, -1, -1, -1, -1, -1, -1 }
+
+/* Ressourcen-Sampling pro Unit. Haelt pro Unit den letzten CPU-Zaehler
+   (cgroup v2 ueber offene fds, sonst utime+stime aller PIDs der Cgroup)
+   samt Zeitstempel und rechnet bei jeder Probe das Delta.
+   Nicht thread-safe: nur unter data_lock() benutzen. */
+void stats_track(const char *unit, const char *cgroup, long main_pid);
+int  stats_sample(const char *unit, struct unit_usage *out);
+int  stats_last(const char *unit, struct unit_usage *out);
+
+struct unit_history;
+int  stats_history(const char *unit, struct unit_history *out);
+
+// Eintraege ohne Probe/stats_track() seit einer Minute freigeben (fds, Verlauf)
+int  stats_expire(void);
+void stats_forget(const char *unit);
+
+#endif
@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "strpool.h"
+
+#define POOL_CHUNK_SIZE (64 * 1024)
+
+struct pool_chunk {
+    struct pool_chunk *next;
+    size_t used;
+    size_t size;
+    char data[];
+};
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct pool_chunk *chunks = NULL;      // aktueller Block zuerst
+
+// Offene Adressierung ueber die Texte, Zweierpotenz
+static const char **slots = NULL;
+static size_t slots_size = 0;
+static size_t slots_used = 0;
+
+static unsigned long hash_text(const char *s, size_t len) {
+    unsigned long h = 2166136261UL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static const char **find_slot(const char **tab, size_t size, const char *s, size_t len) {
+    size_t mask = size - 1;
+    for (size_t i = hash_text(s, len) & mask; ; i = (i + 1) & mask) {
+        if (!tab[i] || (strncmp(tab[i], s, len) == 0 && tab[i][len] == '\0')) return &tab[i];
+    }
+}
+
+static int grow_slots(void) {
+    size_t size = slots_size ? slots_size * 2 : 1024;
+    const char **tab = calloc(size, sizeof(*tab));
+    if (!tab) return -1;
+
+    for (size_t i = 0; i < slots_size; i++) {
+        if (slots[i]) *find_slot(tab, size, slots[i], strlen(slots[i])) = slots[i];
+    }
+    free(slots);
+    slots = tab;
+    slots_size = size;
+    return 0;
+}
+
+// Platz fuer len + 1 Bytes; lange Texte bekommen einen eigenen Block
+static char *pool_alloc(size_t len) {
+    if (!chunks || chunks->size - chunks->used < len + 1) {
+        size_t size = len + 1 > POOL_CHUNK_SIZE ? len + 1 : POOL_CHUNK_SIZE;
+        struct pool_chunk *c = malloc(sizeof(*c) + size);
+        if (!c) return NULL;
+        c->used = 0;
+        c->size = size;
+        // Ein angebrochener Block bleibt vorn, solange der neue nur einen Text traegt
+        if (chunks && size > POOL_CHUNK_SIZE) {
+            c->next = chunks->next;
+            chunks->next = c;
+        } else {
+            c->next = chunks;
+            chunks = c;
+        }
+        c->used = len + 1;
+        return c->data;
+    }
+    char *p = chunks->data + chunks->used;
+    chunks->used += len + 1;
+    return p;
+}
+
+const char *str_intern(const char *s) {
+    if (!s) return NULL;
+
+    size_t len = strlen(s);
+    pthread_mutex_lock(&pool_mutex);
+    const char *res = NULL;
+    if ((slots_used + 1) * 2 <= slots_size || grow_slots() == 0) {
+        const char **slot = find_slot(slots, slots_size, s, len);
+        if (*slot) {
+            res = *slot;
+        } else {
+            char *p = pool_alloc(len);
+            if (p) {
+                memcpy(p, s, len);
+                p[len] = '\0';
+                *slot = p;
+                slots_used++;
+                res = p;
+            }
+        }
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return res;
+}
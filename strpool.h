@@ -0,0 +1,10 @@
+#ifndef STRPOOL_H
+#define STRPOOL_H
+
+/* Prozessweiter String-Pool fuer Unit-Namen, Zustaende und Beschreibungen.
+   Jeder Text liegt genau einmal in grossen Bloecken; der Zeiger bleibt bis
+   Prozessende gueltig und dient als Handle: gleicher Text <=> gleicher
+   Zeiger. Nichts wird einzeln freigegeben. Threadsicher. */
+const char *str_intern(const char *s);
+
+#endif
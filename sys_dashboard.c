@@ -7,26 +7,34 @@
 #include <signal.h>
 #include <sys/wait.h>
 #include <sys/types.h>
-#include <dirent.h>
 #include <errno.h>
+#include <poll.h>
+#include <sys/stat.h>
 #include <ncurses.h>
 
 #include "sys_dashboard.h"
 #include "ui.h"
 #include "utils.h"
+#include "bus.h"
+#include "poller.h"
+#include "spawn.h"
+#include "ports.h"
+#include "stats.h"
+#include "catalog.h"
+#include "strpool.h"
+#include "unitstate.h"
+#include "evloop.h"
+#include "unitwatch.h"
+#include "remote.h"
+#include "daemon.h"
 
 // Globale Variablen
-char my_services[MAX_SERVICES][MAX_LINE];
+const char **my_services = NULL;
 int  num_my_services = 0;
+static int cap_my_services = 0;
 
-char all_services[MAX_SERVICES][MAX_LINE];
-int  num_all_services = 0;
-
-// Cache-Definition
-char summary_cache[MAX_SERVICES][MAX_LINE];
-int  cache_valid[MAX_SERVICES];
-time_t cache_timestamp[MAX_SERVICES];
-#define CACHE_TTL_SECONDS 5
+#define CACHE_TTL_SECONDS 5   // nur ohne abonnierte systemd-Signale
+#define PORTS_TTL_SECONDS 2   // Ports kommen aus /proc/net, dafuer gibt es kein Signal
 
 const char *DEFAULT_SERVICES[DEFAULT_SERVICES_COUNT] = {
     "trainee_trainer-gunicorn.service",
@@ -36,13 +44,6 @@ const char *DEFAULT_SERVICES[DEFAULT_SERVICES_COUNT] = {
 
 const char *sudo_flag = "";
 
-// Resize signal handler
-volatile sig_atomic_t need_resize = 0;
-void resize_handler(int sig) {
-    (void)sig;
-    need_resize = 1;
-}
-
 // --------------------------------------------------
 // Helper - ROBUST
 // --------------------------------------------------
@@ -54,43 +55,77 @@ void init_sudo_flag(void) {
         sudo_flag = "sudo ";
 }
 
-/* Safely execute command and capture output.
-   Reads in chunks to avoid buffer overflow.
-   Returns 0 on success, -1 on popen failure. */
-int execute_cmd(const char *cmd, char *output, size_t max_output) {
+/* Fuehrt argv ohne Shell aus und liefert stdout (ohne letztes '\n').
+   Laenger als max_output wird abgeschnitten, haengende Kinder nach
+   CMD_TIMEOUT_MS gekillt.
+   Returns 0 on success, -1 on spawn failure or timeout. */
+int execute_argv(const char *const argv[], char *output, size_t max_output) {
     if (!output || max_output == 0) return -1;
-
-    FILE *fp = popen(cmd, "r");
-    if (!fp) return -1;
-
-    size_t total = 0;
     output[0] = '\0';
 
-    char buf[256];
-    while (fgets(buf, sizeof(buf), fp) != NULL) {
-        size_t n = strlen(buf);
-        if (total + n >= max_output - 1) break;
-        memcpy(output + total, buf, n + 1);
-        total += n;
-    }
+    char *buf = NULL;
+    size_t len = 0;
+    int ret = spawn_cmd(argv, SPAWN_CAPTURE | SPAWN_QUIET, CMD_TIMEOUT_MS, &buf, &len);
+    if (ret < 0 && ret != SPAWN_SIGNALED) return -1;
 
-    if (total > 0 && output[total - 1] == '\n') {
-        output[--total] = '\0';
+    if (buf) {
+        if (len > 0 && buf[len - 1] == '\n') buf[--len] = '\0';
+        snprintf(output, max_output, "%s", buf);
+        free(buf);
     }
-    (void)pclose(fp);
     return 0;
 }
 
-int exec_simple(const char *cmd) {
-    int ret = system(cmd);
-    if (WIFEXITED(ret)) {
-        return WEXITSTATUS(ret);
-    }
-    return -1;
+/* Wie execute_argv, aber ohne Ausgabe. Rueckgabe: Exit-Status oder -1 */
+int exec_simple(const char *const argv[], int timeout_ms) {
+    int ret = spawn_cmd(argv, SPAWN_QUIET, timeout_ms, NULL, NULL);
+    return ret >= 0 ? ret : -1;
+}
+
+/* "systemctl [--user] <args...>": scope "system" ohne Flag, sonst --user.
+   argv braucht Platz fuer nargs + 4 Eintraege. */
+static int systemctl_argv(const char **argv, int with_sudo, const char *scope,
+                          const char *const args[], int nargs) {
+    int n = 0;
+    if (with_sudo && sudo_flag[0] != '\0') argv[n++] = "sudo";
+    argv[n++] = "systemctl";
+    if (!scope || strcmp(scope, "system") != 0) argv[n++] = "--user";
+    for (int i = 0; i < nargs; i++) argv[n++] = args[i];
+    argv[n] = NULL;
+    return n;
+}
+
+// systemctl [--user] show -p <prop> --value <svc>
+int systemctl_value(const char *scope, const char *svc, const char *prop,
+                    char *out, size_t outsize) {
+    const char *args[] = { "show", "-p", prop, "--value", "--", svc };
+    const char *argv[10];
+    systemctl_argv(argv, 0, scope, args, 6);
+    return execute_argv(argv, out, outsize);
+}
+
+// systemctl [--user] <verb> <svc>, z.B. is-active / is-enabled
+int systemctl_query(const char *scope, const char *verb, const char *svc,
+                    char *out, size_t outsize) {
+    const char *args[] = { verb, "--", svc };
+    const char *argv[8];
+    systemctl_argv(argv, 0, scope, args, 3);
+    return execute_argv(argv, out, outsize);
+}
+
+/* [sudo] systemctl [--user] <verb> <svc> fuer Aktionen (start, stop, ...).
+   sudo fragt ggf. ueber /dev/tty nach dem Passwort.
+   Rueckgabe: Exit-Status, -1 bei Startfehler oder Timeout */
+int systemctl_action(const char *scope, const char *verb, const char *svc) {
+    const char *args[] = { verb, "--", svc };
+    const char *argv[8];
+    systemctl_argv(argv, 1, scope, args, 3);
+    return exec_simple(argv, ACTION_TIMEOUT_MS);
 }
 
 void check_systemctl(void) {
-    if (exec_simple("which systemctl >/dev/null 2>&1") != 0) {
+    const char *argv[] = { "systemctl", "--version", NULL };
+    if (exec_simple(argv, CMD_TIMEOUT_MS) != 0) {
         printf("%sFehler:%s 'systemctl' wurde nicht gefunden. Laeuft hier kein systemd?\n",
                "\033[31m", "\033[0m");
         exit(1);
@@ -107,36 +142,176 @@ void press_enter_cli(void) {
 // Cache Management
 // --------------------------------------------------
 
-void invalidate_cache(void) {
-    for (int i = 0; i < MAX_SERVICES; i++) {
-        cache_valid[i] = 0;
+/* Zustands-Cache: Unit-Name -> struct unit_state.
+   Ein Eintrag fuer jede Unit, die das UI anfasst (Favoriten, Browse-Zeilen,
+   Detailseite). Offene Adressierung als Struct-of-Arrays: beim Sondieren
+   wird nur das Namens-Array angefasst, Zustaende liegen dicht dahinter.
+   Gueltig, solange gen == state_gen ist und - ohne abonnierte
+   systemd-Signale - juenger als CACHE_TTL_SECONDS. invalidate_cache()
+   zaehlt nur state_gen hoch, einzelne Eintraege bekommen gen = 0.
+   Die Ports eines gueltigen Eintrags werden nach PORTS_TTL_SECONDS aus
+   Cgroup/MainPID neu bestimmt, ohne systemd erneut zu fragen.
+   Zugriff unter data_lock(); abgefragt wird ohne (siehe query_gen()). */
+struct state_table {
+    size_t size;                 // Zweierpotenz
+    size_t used;
+    const char **name;           // String-Pool, NULL = frei
+    struct unit_state *state;
+    time_t *stamp;
+    unsigned *gen;
+    const char **cgroup;         // String-Pool, fuer die Ports
+    long *main_pid;
+    time_t *port_stamp;
+};
+static struct state_table states = { 0 };
+static unsigned state_gen = 1;
+static unsigned event_seq = 0;   // zaehlt Invalidierungen einzelner Units
+
+static unsigned long hash_name(const char *s) {
+    unsigned long h = 2166136261UL;
+    for (; *s; s++) {
+        h ^= (unsigned char)*s;
+        h *= 16777619UL;
     }
+    return h;
 }
 
-void invalidate_service_cache(const char *svc) {
-    for (int i = 0; i < num_my_services; i++) {
-        if (strcmp(my_services[i], svc) == 0) {
-            cache_valid[i] = 0;
-            break;
-        }
+static size_t state_slot(const struct state_table *t, const char *name) {
+    size_t mask = t->size - 1;
+    for (size_t i = hash_name(name) & mask; ; i = (i + 1) & mask) {
+        if (!t->name[i] || t->name[i] == name || strcmp(t->name[i], name) == 0) return i;
     }
-    // Also invalidate all_services with same name
-    for (int i = 0; i < num_all_services; i++) {
-        if (strcmp(all_services[i], svc) == 0) {
-            // We use negative indices for all_services to avoid collision
-            cache_valid[MAX_SERVICES - 1 - i] = 0;
-            break;
-        }
+}
+
+static void state_table_free(struct state_table *t) {
+    free(t->name);
+    free(t->state);
+    free(t->stamp);
+    free(t->gen);
+    free(t->cgroup);
+    free(t->main_pid);
+    free(t->port_stamp);
+    memset(t, 0, sizeof(*t));
+}
+
+static int state_table_grow(void) {
+    struct state_table t = { 0 };
+    t.size = states.size ? states.size * 2 : 256;
+    t.name  = calloc(t.size, sizeof(*t.name));
+    t.state = calloc(t.size, sizeof(*t.state));
+    t.stamp = calloc(t.size, sizeof(*t.stamp));
+    t.gen   = calloc(t.size, sizeof(*t.gen));
+    t.cgroup     = calloc(t.size, sizeof(*t.cgroup));
+    t.main_pid   = calloc(t.size, sizeof(*t.main_pid));
+    t.port_stamp = calloc(t.size, sizeof(*t.port_stamp));
+    if (!t.name || !t.state || !t.stamp || !t.gen ||
+        !t.cgroup || !t.main_pid || !t.port_stamp) {
+        state_table_free(&t);
+        return -1;
     }
+
+    for (size_t i = 0; i < states.size; i++) {
+        if (!states.name[i]) continue;
+        size_t k = state_slot(&t, states.name[i]);
+        t.name[k]  = states.name[i];
+        t.state[k] = states.state[i];
+        t.stamp[k] = states.stamp[i];
+        t.gen[k]   = states.gen[i];
+        t.cgroup[k]     = states.cgroup[i];
+        t.main_pid[k]   = states.main_pid[i];
+        t.port_stamp[k] = states.port_stamp[i];
+    }
+    t.used = states.used;
+    state_table_free(&states);
+    states = t;
+    return 0;
+}
+
+// Slot der Unit oder -1
+static long state_find(const char *svc) {
+    if (states.used == 0) return -1;
+    size_t i = state_slot(&states, svc);
+    return states.name[i] ? (long)i : -1;
+}
+
+static int state_fresh(size_t i) {
+    return states.gen[i] == state_gen &&
+           (bus_events_active() || time(NULL) - states.stamp[i] < CACHE_TTL_SECONDS);
+}
+
+/* Generation fuer das Ergebnis einer Abfrage, die ohne data_lock() lief
+   (gen/seq vor der Abfrage gemerkt). Kam waehrenddessen eine
+   Invalidierung, gilt es nur fuer diese Runde und wird neu geholt. */
+static unsigned query_gen(unsigned gen, unsigned seq) {
+    return (gen == state_gen && seq == event_seq) ? gen : 0;
+}
+
+void invalidate_cache(void) {
+    data_lock();
+    if (++state_gen == 0) state_gen = 1;
+    data_unlock();
+    poller_wake();
+}
+
+void invalidate_service_cache(const char *svc) {
+    data_lock();
+    long i = state_find(svc);
+    if (i >= 0) states.gen[i] = 0;
+    event_seq++;
+    data_unlock();
+    poller_wake();
+}
+
+/* Gezielte Invalidierung durch systemd-Signale (bus.c).
+   min_age > 0: nur Eintraege invalidieren, die aelter als min_age Sekunden sind
+   (betrifft laufende Abfragen also nie).
+   Rueckgabe: 1 wenn ein gueltiger Eintrag betroffen war */
+int invalidate_service_cache_event(const char *svc, int min_age) {
+    int hit = 0;
+    data_lock();
+    if (min_age <= 0) event_seq++;
+    long i = state_find(svc);
+    if (i >= 0 && states.gen[i] == state_gen &&
+        (min_age <= 0 || time(NULL) - states.stamp[i] >= min_age)) {
+        states.gen[i] = 0;
+        hit = 1;
+    }
+    data_unlock();
+    return hit;
 }
 
 // --------------------------------------------------
 // Config Laden/Speichern
 // --------------------------------------------------
 
+int add_my_service(const char *svc) {
+    for (int i = 0; i < num_my_services; i++) {
+        if (strcmp(my_services[i], svc) == 0) return 1;
+    }
+    if (num_my_services == cap_my_services) {
+        int cap = cap_my_services ? cap_my_services * 2 : 64;
+        const char **p = realloc(my_services, (size_t)cap * sizeof(*p));
+        if (!p) return -1;
+        my_services = p;
+        cap_my_services = cap;
+    }
+    const char *name = str_intern(svc);
+    if (!name) return -1;
+    my_services[num_my_services++] = name;
+    return 0;
+}
+
+void remove_my_service(int idx) {
+    if (idx < 0 || idx >= num_my_services) return;
+    memmove(&my_services[idx], &my_services[idx + 1],
+            (size_t)(num_my_services - idx - 1) * sizeof(*my_services));
+    num_my_services--;
+}
+
 void load_services(const char *home) {
     char config_path[MAX_LINE];
     snprintf(config_path, sizeof(config_path), CONFIG_FILE, home);
+    data_lock();
     num_my_services = 0;
 
     FILE *fp = fopen(config_path, "r");
@@ -145,36 +320,81 @@ void load_services(const char *home) {
         while (fgets(line, sizeof(line), fp)) {
             line[strcspn(line, "\n")] = '\0';
             if (line[0] == '\0' || line[0] == '#') continue;
-            if (num_my_services < MAX_SERVICES) {
-                strncpy(my_services[num_my_services], line, MAX_LINE - 1);
-                my_services[num_my_services][MAX_LINE - 1] = '\0';
-                num_my_services++;
-            }
+            add_my_service(line);
         }
         fclose(fp);
     } else {
         // Defaults
-        for (int i = 0; i < DEFAULT_SERVICES_COUNT && num_my_services < MAX_SERVICES; i++) {
-            strncpy(my_services[num_my_services], DEFAULT_SERVICES[i], MAX_LINE - 1);
-            my_services[num_my_services][MAX_LINE - 1] = '\0';
-            num_my_services++;
+        for (int i = 0; i < DEFAULT_SERVICES_COUNT; i++) {
+            add_my_service(DEFAULT_SERVICES[i]);
         }
         save_services(home);
     }
+    data_unlock();
     invalidate_cache();
 }
 
+/* Gleicht my_services mit der Config-Datei ab (nach inotify, unitwatch.c).
+   Die Reihenfolge kommt aus der Datei; bekannte Favoriten behalten Pool-
+   Zeiger, Zustands-Cache und Verlauf, abgefragt werden nur neue.
+   Rueckgabe: 1 = geaendert, 0 = gleich, -1 = Datei nicht lesbar */
+int sync_services(const char *home) {
+    char config_path[MAX_LINE];
+    snprintf(config_path, sizeof(config_path), CONFIG_FILE, home);
+    FILE *fp = fopen(config_path, "r");
+    if (!fp) return -1;
+
+    const char **names = NULL;
+    int n = 0, cap = 0;
+    char line[MAX_LINE];
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+        const char *name = str_intern(line);
+        if (!name) continue;
+
+        int dup = 0;
+        for (int i = 0; i < n && !dup; i++) dup = (names[i] == name);
+        if (dup) continue;
+        if (n == cap) {
+            int ncap = cap ? cap * 2 : 64;
+            const char **p = realloc(names, (size_t)ncap * sizeof(*p));
+            if (!p) break;
+            names = p;
+            cap = ncap;
+        }
+        names[n++] = name;
+    }
+    fclose(fp);
+
+    data_lock();
+    int same = (n == num_my_services);
+    for (int i = 0; same && i < n; i++) same = (names[i] == my_services[i]);
+    if (!same) {
+        const char **old = my_services;
+        my_services = names;
+        num_my_services = n;
+        cap_my_services = cap;
+        names = old;
+    }
+    data_unlock();
+    free(names);
+
+    if (same) return 0;
+    poller_wake();
+    return 1;
+}
+
 void save_services(const char *home) {
     char config_path[MAX_LINE];
     snprintf(config_path, sizeof(config_path), CONFIG_FILE, home);
 
+    // mkdir -p ohne Shell: ~/.config und ~/.config/sys-dashboard
     char dir_path[MAX_LINE];
+    snprintf(dir_path, sizeof(dir_path), "%s/.config", home);
+    mkdir(dir_path, 0755);
     snprintf(dir_path, sizeof(dir_path), "%s/.config/sys-dashboard", home);
-    char mkdir_cmd[MAX_LINE + 32];
-    int len = snprintf(mkdir_cmd, sizeof(mkdir_cmd), "mkdir -p \"%s\"", dir_path);
-    if (len > 0 && (size_t)len < sizeof(mkdir_cmd)) {
-        system(mkdir_cmd);
-    }
+    mkdir(dir_path, 0755);
 
     FILE *fp = fopen(config_path, "w");
     if (!fp) {
@@ -231,158 +451,574 @@ void enabled_color(const char *s, char *buf, size_t bufsize) {
 }
 
 // --------------------------------------------------
-// Scope Detection - OPTIMIZED: single systemctl show call
+// Scope-Cache: Unit-Name -> system/user/none
 // --------------------------------------------------
-/* Old: 2x list-unit-files (slow, parses full table)
-   New: 1x systemctl show LoadState (fast, single value)
-   - LoadState = "loaded" => found (try system first)
-   - If not found system-wide, try --user
-   - We also check if the pid is valid to determine scope */
+/* Lebt fuer den ganzen Prozess (offene Adressierung, FNV-1a).
+   Geleert nur bei Reloading/UnitFilesChanged (bus.c) oder wenn sich
+   eines der Unit-Verzeichnisse aendert. Zugriff unter data_lock(). */
+#define SCOPE_DIR_CHECK_SECONDS 2
+
+static const char *const scope_names[] = { "system", "user", "none" };
+
+struct scope_entry {
+    const char *name;  // String-Pool, NULL = frei
+    int scope;         // Index in scope_names
+};
+static struct scope_entry *scope_map = NULL;
+static size_t scope_map_size = 0;   // Zweierpotenz
+static size_t scope_map_used = 0;
+
+static struct scope_entry *scope_slot(struct scope_entry *map, size_t size, const char *name) {
+    size_t mask = size - 1;
+    for (size_t i = hash_name(name) & mask; ; i = (i + 1) & mask) {
+        if (!map[i].name || strcmp(map[i].name, name) == 0) return &map[i];
+    }
+}
+
+static void scope_map_clear(void) {
+    for (size_t i = 0; i < scope_map_size; i++) {
+        scope_map[i].name = NULL;
+    }
+    scope_map_used = 0;
+}
+
+static int scope_map_grow(void) {
+    size_t size = scope_map_size ? scope_map_size * 2 : 256;
+    struct scope_entry *map = calloc(size, sizeof(*map));
+    if (!map) return -1;
+
+    for (size_t i = 0; i < scope_map_size; i++) {
+        if (scope_map[i].name) *scope_slot(map, size, scope_map[i].name) = scope_map[i];
+    }
+    free(scope_map);
+    scope_map = map;
+    scope_map_size = size;
+    return 0;
+}
+
+/* Ohne inotify: Aenderungen an den Unit-Verzeichnissen (neue/geloeschte
+   Unit-Dateien) ueber die mtime erkennen, hoechstens alle SCOPE_DIR_CHECK_SECONDS */
+static void scope_check_unit_dirs(void) {
+    if (unitwatch_active()) return; // Deltas kommen ueber inotify (unit_file_changed)
+
+    static const char *const sys_dirs[] = {
+        "/etc/systemd/system", "/run/systemd/system",
+        "/usr/lib/systemd/system", "/lib/systemd/system",
+        "/etc/systemd/user", "/run/systemd/user", "/usr/lib/systemd/user",
+    };
+    static time_t last_check = 0;
+    static long long last_sum = -1;
+
+    time_t now = time(NULL);
+    if (now - last_check < SCOPE_DIR_CHECK_SECONDS) return;
+    last_check = now;
+
+    long long sum = 0;
+    struct stat st;
+    for (size_t i = 0; i < sizeof(sys_dirs) / sizeof(sys_dirs[0]); i++) {
+        if (stat(sys_dirs[i], &st) == 0) sum += st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    }
+    const char *home = getenv("HOME");
+    static const char *const user_dirs[] = { "%s/.config/systemd/user", "%s/.local/share/systemd/user" };
+    for (size_t i = 0; home && i < sizeof(user_dirs) / sizeof(user_dirs[0]); i++) {
+        char user_dir[MAX_LINE];
+        snprintf(user_dir, sizeof(user_dir), user_dirs[i], home);
+        if (stat(user_dir, &st) == 0) sum += st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    }
+
+    if (last_sum >= 0 && sum != last_sum) scope_map_clear();
+    last_sum = sum;
+}
+
+static const char *scope_map_lookup(const char *svc) {
+    scope_check_unit_dirs();
+    if (scope_map_used == 0) return NULL;
+
+    struct scope_entry *e = scope_slot(scope_map, scope_map_size, svc);
+    return e->name ? scope_names[e->scope] : NULL;
+}
+
+// Loeschen mit Rueckwaerts-Verschieben, damit Sondierketten ohne Grabsteine bleiben
+static void scope_map_forget(const char *svc) {
+    if (scope_map_used == 0) return;
+    size_t mask = scope_map_size - 1;
+    struct scope_entry *e = scope_slot(scope_map, scope_map_size, svc);
+    if (!e->name) return;
+
+    size_t i = (size_t)(e - scope_map);
+    for (size_t j = (i + 1) & mask; scope_map[j].name; j = (j + 1) & mask) {
+        size_t home = hash_name(scope_map[j].name) & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            scope_map[i] = scope_map[j];
+            i = j;
+        }
+    }
+    scope_map[i].name = NULL;
+    scope_map_used--;
+}
+
+static void scope_map_store(const char *svc, const char *scope) {
+    int idx = 2;
+    if (strcmp(scope, "system") == 0) idx = 0;
+    else if (strcmp(scope, "user") == 0) idx = 1;
+    else if (strcmp(scope, "none") != 0) return; // leere/kaputte Abfrage nicht merken
+
+    if ((scope_map_used + 1) * 2 > scope_map_size && scope_map_grow() != 0) return;
+
+    struct scope_entry *e = scope_slot(scope_map, scope_map_size, svc);
+    if (!e->name) {
+        e->name = str_intern(svc);
+        if (!e->name) return;
+        scope_map_used++;
+    }
+    e->scope = idx;
+}
+
+/* Reloading/UnitFilesChanged (bus.c): Scopes und alle Summaries sind
+   potentiell veraltet. Rueckgabe: Anzahl invalidierter Summaries */
+int invalidate_scope_cache_event(void) {
+    catalog_invalidate();
+    data_lock();
+    scope_map_clear();
+    int hit = 0;
+    for (size_t i = 0; i < states.size; i++) {
+        if (states.name[i] && states.gen[i] == state_gen) hit++;
+    }
+    if (++state_gen == 0) state_gen = 1;
+    data_unlock();
+    return hit;
+}
+
+/* inotify (unitwatch.c): Unit-Datei angelegt oder geloescht. Nur diese
+   Unit verliert Scope und Zustand, der Rest der Caches bleibt. */
+void unit_file_changed(const char *svc) {
+    data_lock();
+    scope_map_forget(svc);
+    data_unlock();
+    invalidate_service_cache(svc);
+}
+
+// --------------------------------------------------
+// Scope Detection - Scope-Cache, sonst sd-bus bzw. systemctl show
+// --------------------------------------------------
+/* Nur bei einem Miss im Scope-Cache:
+   - sd-bus: LoadState auf System- und User-Bus lesen
+   - sonst 1x systemctl show LoadState pro Scope (system zuerst) */
 char *detect_scope(const char *svc) {
-    static char scope_buf[16];
-    char cmd[MAX_LINE];
+    static __thread char scope_buf[16];
     char out[64];
 
-    out[0] = '\0';
+    data_lock();
+    const char *cached = scope_map_lookup(svc);
+    if (cached) {
+        snprintf(scope_buf, sizeof(scope_buf), "%s", cached);
+        data_unlock();
+        return scope_buf;
+    }
 
-    /* Test system scope - use show LoadState (much faster than list-unit-files) */
-    snprintf(cmd, sizeof(cmd),
-             "systemctl show -p LoadState --value \"%s\" 2>/dev/null", svc);
-    execute_cmd(cmd, out, sizeof(out));
+    data_unlock();
 
-    if (strcmp(out, "loaded") == 0) {
-        strcpy(scope_buf, "system");
+    /* sd-bus zuerst: zwei Property-Reads statt zwei forks */
+    if (bus_detect_scope(svc, scope_buf, sizeof(scope_buf)) == 0) {
+        data_lock();
+        scope_map_store(svc, scope_buf);
+        data_unlock();
         return scope_buf;
     }
 
-    /* Test user scope */
     out[0] = '\0';
-    snprintf(cmd, sizeof(cmd),
-             "systemctl --user show -p LoadState --value \"%s\" 2>/dev/null", svc);
-    execute_cmd(cmd, out, sizeof(out));
+
+    /* Test system scope - use show LoadState (much faster than list-unit-files) */
+    systemctl_value("system", svc, "LoadState", out, sizeof(out));
 
     if (strcmp(out, "loaded") == 0) {
-        strcpy(scope_buf, "user");
-        return scope_buf;
+        strcpy(scope_buf, "system");
+    } else {
+        /* Test user scope */
+        out[0] = '\0';
+        systemctl_value("user", svc, "LoadState", out, sizeof(out));
+        strcpy(scope_buf, strcmp(out, "loaded") == 0 ? "user" : "none");
     }
 
-    strcpy(scope_buf, "none");
+    data_lock();
+    scope_map_store(svc, scope_buf);
+    data_unlock();
     return scope_buf;
 }
 
 // --------------------------------------------------
-// Port Detection - OPTIMIZED: use ss instead of netstat
+// Port Detection - /proc/net + Cgroup statt ss
 // --------------------------------------------------
+#define UNIT_MAX_SOCKETS 256
+
+/* Ports einer Unit: alle Sockets aller Prozesse ihrer Cgroup aus dem
+   /proc/net-Index (hoechstens einmal pro Runde eingelesen).
+   Liest /proc: nie unter data_lock() aufrufen. */
+static void ports_for_cgroup(const char *cgroup, long main_pid, struct unit_ports *ports) {
+    struct listen_sock found[UNIT_MAX_SOCKETS];
+
+    port_index_refresh(PORT_INDEX_MAX_AGE_MS);
+    int n = port_index_cgroup(cgroup, main_pid, found, UNIT_MAX_SOCKETS);
+    port_collect(found, n, ports);
+}
+
+static void ports_for_unit(const struct unit_info *info, struct unit_ports *ports) {
+    ports_for_cgroup(info->cgroup, info->main_pid, ports);
+}
+
 char *guess_port(const char *svc, const char *scope) {
-    static char port_buf[16];
+    static __thread char port_buf[16];
     strcpy(port_buf, "-");
 
     if (strcmp(scope, "none") == 0) {
         return port_buf;
     }
 
-    const char *user_flag = (strcmp(scope, "system") == 0 ? "" : "--user");
+    struct unit_info info;
+    if (query_unit_info(svc, &info) == 0) {
+        struct unit_ports ports;
+        ports_for_unit(&info, &ports);
+        port_format_compact(&ports, port_buf, sizeof(port_buf));
+    }
+    return port_buf;
+}
 
-    // MainPID holen
-    char cmd[MAX_LINE];
-    char pid_str[32] = {0};
+/* Vollstaendige Socket-Liste einer Unit (Detailseite). Cgroup/MainPID
+   bringt der Aufrufer aus seiner eigenen Abfrage mit, hier keine weitere */
+int get_unit_sockets(const char *cgroup, long main_pid, struct listen_sock *out, int max) {
+    if (!cgroup || !out || max <= 0) return 0;
+    if (max > UNIT_MAX_SOCKETS) max = UNIT_MAX_SOCKETS;
 
-    snprintf(cmd, sizeof(cmd),
-             "systemctl %s show -p MainPID --value \"%s\" 2>/dev/null",
-             user_flag, svc);
-    if (execute_cmd(cmd, pid_str, sizeof(pid_str)) != 0) {
-        return port_buf;
+    port_index_refresh(PORT_INDEX_MAX_AGE_MS);
+    return port_index_cgroup(cgroup, main_pid, out, max);
+}
+
+// --------------------------------------------------
+// Service-Summary - CACHED
+// --------------------------------------------------
+
+#define SHOW_PROPS "LoadState,ActiveState,SubState,UnitFileState,Description,MainPID,ControlGroup," \
+                   "FragmentPath,ActiveEnterTimestamp"
+
+/* Ein "systemctl show -p ... u1 u2 ..." fuer alle Units mit todo[i].
+   systemctl gibt einen Block pro Unit in Argument-Reihenfolge aus,
+   getrennt durch Leerzeilen. */
+static int show_units_scope(const char *scope, const char **svcs, int count,
+                            struct unit_info *infos, const int *todo) {
+    int n_todo = 0;
+    for (int i = 0; i < count; i++) {
+        if (todo[i]) n_todo++;
+    }
+    if (n_todo == 0) return 0;
+
+    const char **args = malloc((size_t)(n_todo + 4) * sizeof(*args));
+    const char **argv = malloc((size_t)(n_todo + 8) * sizeof(*argv));
+    if (!args || !argv) {
+        free(args);
+        free(argv);
+        return -1;
     }
 
-    long pid = atol(pid_str);
-    if (pid <= 0) {
-        return port_buf;
+    int nargs = 0;
+    args[nargs++] = "show";
+    args[nargs++] = "-p";
+    args[nargs++] = SHOW_PROPS;
+    args[nargs++] = "--";
+    for (int i = 0; i < count; i++) {
+        if (todo[i]) args[nargs++] = svcs[i];
+    }
+    systemctl_argv(argv, 0, scope, args, nargs);
+
+    // Ausgabe waechst mit der Anzahl Units, kein festes Limit
+    char *out = NULL;
+    int ret = spawn_cmd(argv, SPAWN_CAPTURE | SPAWN_QUIET, CMD_TIMEOUT_MS, &out, NULL);
+    free(args);
+    free(argv);
+    if (ret < 0 || !out) {
+        free(out);
+        return -1;
     }
 
-    // Use ss instead of netstat (faster, modern)
-    char ss_out[64] = {0};
-    snprintf(cmd, sizeof(cmd),
-             "ss -tlnp 2>/dev/null | awk '$0 ~ \"pid=%ld,?\" {split($4,a,\":\"); print a[length(a)]; exit}'",
-             pid);
+    // Bloecke der Reihe nach den todo-Units zuordnen
+    int cur = 0;
+    while (cur < count && !todo[cur]) cur++;
 
-    if (execute_cmd(cmd, ss_out, sizeof(ss_out)) == 0 && strlen(ss_out) > 0) {
-        int ok = 1;
-        for (size_t i = 0; i < strlen(ss_out); i++) {
-            if (!isdigit((unsigned char)ss_out[i])) {
-                ok = 0;
-                break;
-            }
+    char *line = out;
+    while (line && cur < count) {
+        char *next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+
+        if (line[0] == '\0') {
+            // Leerzeile = naechste Unit
+            cur++;
+            while (cur < count && !todo[cur]) cur++;
+            line = next;
+            continue;
         }
-        if (ok && strlen(ss_out) < sizeof(port_buf)) {
-            strcpy(port_buf, ss_out);
+
+        struct unit_info *info = &infos[cur];
+        char *eq = strchr(line, '=');
+        if (!eq) {
+            line = next;
+            continue;
         }
+        *eq = '\0';
+        const char *key = line;
+        const char *val = eq + 1;
+
+        if (strcmp(key, "LoadState") == 0)
+            snprintf(info->load_state, sizeof(info->load_state), "%s", val);
+        else if (strcmp(key, "ActiveState") == 0)
+            snprintf(info->active, sizeof(info->active), "%s", val);
+        else if (strcmp(key, "SubState") == 0)
+            snprintf(info->sub_state, sizeof(info->sub_state), "%s", val);
+        else if (strcmp(key, "UnitFileState") == 0)
+            snprintf(info->enabled, sizeof(info->enabled), "%s", val);
+        else if (strcmp(key, "Description") == 0)
+            snprintf(info->desc, sizeof(info->desc), "%s", val);
+        else if (strcmp(key, "MainPID") == 0)
+            info->main_pid = atol(val);
+        else if (strcmp(key, "ControlGroup") == 0)
+            snprintf(info->cgroup, sizeof(info->cgroup), "%s", val);
+        else if (strcmp(key, "FragmentPath") == 0)
+            snprintf(info->fragment, sizeof(info->fragment), "%s", val);
+        else if (strcmp(key, "ActiveEnterTimestamp") == 0)
+            snprintf(info->active_since, sizeof(info->active_since), "%s", val);
+
+        line = next;
     }
 
-    return port_buf;
+    free(out);
+    return 0;
 }
 
-// --------------------------------------------------
-// Service-Summary - CACHED
-// --------------------------------------------------
+/* Fallback ohne sd-bus: system-weit ein systemctl-Aufruf fuer alle Units,
+   nur fuer dort nicht geladene Units ein zweiter mit --user. */
+static int show_units_cmd(const char **svcs, int count, struct unit_info *infos) {
+    if (count <= 0) return -1;
 
-/* Returns cached summary if valid (TTL < 5s), otherwise queries systemd.
-   Uses negative index scheme: for my_services use idx 0..N-1,
-   for all_services during browse we use a separate cache path. */
-void get_service_summary(const char *svc, char *summary, size_t bufsize) {
-    // Check cache by matching against my_services
-    for (int i = 0; i < num_my_services; i++) {
-        if (strcmp(my_services[i], svc) == 0 && cache_valid[i]) {
-            time_t now = time(NULL);
-            if (now - cache_timestamp[i] < CACHE_TTL_SECONDS) {
-                strncpy(summary, summary_cache[i], bufsize - 1);
-                summary[bufsize - 1] = '\0';
-                return; // cache hit
+    int *todo = malloc((size_t)count * sizeof(int));
+    if (!todo) return -1;
+
+    memset(infos, 0, (size_t)count * sizeof(*infos));
+    for (int i = 0; i < count; i++) todo[i] = 1;
+
+    int remaining = 0;
+    if (show_units_scope("system", svcs, count, infos, todo) == 0) {
+        for (int i = 0; i < count; i++) {
+            if (strcmp(infos[i].load_state, "loaded") == 0) {
+                strcpy(infos[i].scope, "system");
+                todo[i] = 0;
+            } else {
+                memset(&infos[i], 0, sizeof(infos[i]));
+                remaining++;
             }
         }
+    } else {
+        remaining = count;
     }
 
-    // Cache miss — query systemd
-    char scope_str[16];
-    strcpy(scope_str, detect_scope(svc));
-    char active[32] = {0}, enabled[32] = {0}, desc[MAX_DESC] = {0}, port[16] = {0};
-    char cmd[MAX_LINE];
-
-    if (strcmp(scope_str, "system") == 0) {
-        snprintf(cmd, sizeof(cmd), "systemctl is-active \"%s\" 2>/dev/null", svc);
-        execute_cmd(cmd, active, sizeof(active));
-        snprintf(cmd, sizeof(cmd), "systemctl is-enabled \"%s\" 2>/dev/null", svc);
-        execute_cmd(cmd, enabled, sizeof(enabled));
-        snprintf(cmd, sizeof(cmd), "systemctl show -p Description --value \"%s\" 2>/dev/null", svc);
-        execute_cmd(cmd, desc, sizeof(desc));
-    } else if (strcmp(scope_str, "user") == 0) {
-        snprintf(cmd, sizeof(cmd), "systemctl --user is-active \"%s\" 2>/dev/null", svc);
-        execute_cmd(cmd, active, sizeof(active));
-        snprintf(cmd, sizeof(cmd), "systemctl --user is-enabled \"%s\" 2>/dev/null", svc);
-        execute_cmd(cmd, enabled, sizeof(enabled));
-        snprintf(cmd, sizeof(cmd), "systemctl --user show -p Description --value \"%s\" 2>/dev/null", svc);
-        execute_cmd(cmd, desc, sizeof(desc));
-    } else {
-        strcpy(active, "not-found");
-        strcpy(enabled, "not-found");
-        strcpy(desc, "(Service nicht gefunden – weder system- noch user-weit)");
+    if (remaining > 0) {
+        show_units_scope("user", svcs, count, infos, todo);
+        for (int i = 0; i < count; i++) {
+            if (!todo[i]) continue;
+            if (strcmp(infos[i].load_state, "loaded") == 0) {
+                strcpy(infos[i].scope, "user");
+            } else {
+                memset(&infos[i], 0, sizeof(infos[i]));
+                strcpy(infos[i].scope, "none");
+            }
+        }
     }
 
-    if (strlen(desc) == 0) strcpy(desc, "(keine Beschreibung)");
-    strcpy(port, guess_port(svc, scope_str));
+    free(todo);
+    return 0;
+}
 
-    snprintf(summary, bufsize, "%s|%s|%s|%s|%s",
-             scope_str, active, enabled, desc, port);
+/* Einzelne Unit am Cache vorbei: sd-bus (ein GetAll pro Interface),
+   sonst ein systemctl show mit allen Properties */
+int query_unit_info(const char *svc, struct unit_info *info) {
+    if (bus_get_unit_info(svc, info) == 0) return 0;
+    return show_units_cmd(&svc, 1, info);
+}
 
-    // Update cache for matching my_services entry
-    for (int i = 0; i < num_my_services; i++) {
-        if (strcmp(my_services[i], svc) == 0) {
-            strncpy(summary_cache[i], summary, MAX_LINE - 1);
-            summary_cache[i][MAX_LINE - 1] = '\0';
-            cache_valid[i] = 1;
-            cache_timestamp[i] = time(NULL);
-            break;
+/* Setzt die Abfrage einmal in den typisierten Zustand um und merkt sich
+   nebenbei Scope sowie Cgroup/MainPID (Sampling) der Unit.
+   Die Ports setzt der Aufrufer (ports_for_unit() ausserhalb von data_lock) */
+static void state_from_info(const char *svc, const struct unit_info *info,
+                            struct unit_state *st) {
+    st->scope   = (unsigned char)unit_scope_parse(info->scope);
+    st->active  = (unsigned char)unit_active_parse(info->active);
+    st->enabled = (unsigned char)unit_enabled_parse(info->enabled);
+
+    const char *desc = info->desc;
+    if (st->scope == UNIT_SCOPE_NONE) {
+        st->active  = UNIT_ACTIVE_NOT_FOUND;
+        st->enabled = UNIT_ENABLED_NOT_FOUND;
+        desc = "(Service nicht gefunden – weder system- noch user-weit)";
+    } else if (desc[0] == '\0') {
+        desc = "(keine Beschreibung)";
+    }
+    st->desc = str_intern(desc);
+    if (!st->desc) st->desc = "";
+
+    data_lock();
+    scope_map_store(svc, info->scope);
+    stats_track(svc, info->cgroup, info->main_pid);
+    data_unlock();
+}
+
+// Faellige Port-Aktualisierung, erledigt nach data_unlock() (cache_refresh_ports)
+struct ports_job {
+    int due;
+    const char *cgroup;          // String-Pool, wie im Cache-Eintrag
+    long main_pid;
+};
+
+/* Mit abonnierten systemd-Signalen gibt es keine TTL:
+   Eintraege bleiben gueltig, bis ein Signal sie invalidiert.
+   Die Ports haben ihre eigene, da sich Sockets ohne Signal aendern;
+   gescannt wird aber nicht hier unter data_lock, sondern ueber job. */
+static int cache_lookup(const char *svc, struct unit_state *st, struct ports_job *job) {
+    job->due = 0;
+    long i = state_find(svc);
+    if (i < 0 || !state_fresh((size_t)i)) return 0;
+
+    // Haelt den stats-Eintrag am Leben bzw. legt ihn nach stats_expire() neu an
+    stats_track(svc, states.cgroup[i] ? states.cgroup[i] : "", states.main_pid[i]);
+
+    time_t now = time(NULL);
+    if (now - states.port_stamp[i] >= PORTS_TTL_SECONDS) {
+        job->due = 1;
+        job->cgroup = states.cgroup[i];
+        job->main_pid = states.main_pid[i];
+        states.port_stamp[i] = now;   // kein zweiter Thread scannt dasselbe
+    }
+    if (st) *st = states.state[i];
+    return 1; // cache hit
+}
+
+/* Ports ohne data_lock neu bestimmen und eintragen, solange der Eintrag
+   noch dieselbe Cgroup/MainPID hat */
+static void cache_refresh_ports(const char *svc, const struct ports_job *job, struct unit_state *st) {
+    struct unit_ports ports;
+    ports_for_cgroup(job->cgroup ? job->cgroup : "", job->main_pid, &ports);
+
+    data_lock();
+    long i = state_find(svc);
+    if (i >= 0 && states.cgroup[i] == job->cgroup && states.main_pid[i] == job->main_pid) {
+        states.state[i].ports = ports;
+    }
+    data_unlock();
+    if (st) st->ports = ports;
+}
+
+static void cache_store(const char *svc, const struct unit_state *st,
+                        const struct unit_info *info, unsigned gen) {
+    if ((states.used + 1) * 2 > states.size && state_table_grow() != 0) return;
+
+    size_t i = state_slot(&states, svc);
+    if (!states.name[i]) {
+        states.name[i] = str_intern(svc);
+        if (!states.name[i]) return;
+        states.used++;
+    }
+    states.state[i] = *st;
+    states.stamp[i] = time(NULL);
+    states.gen[i]   = gen;
+    states.cgroup[i]     = str_intern(info->cgroup);
+    states.main_pid[i]   = info->main_pid;
+    states.port_stamp[i] = states.stamp[i];
+}
+
+/* Zustand aus dem Cache, sonst eine Abfrage (sd-bus, systemctl nur
+   als Fallback). Gilt fuer jede Unit, nicht nur fuer Favoriten. */
+void get_unit_state(const char *svc, struct unit_state *st) {
+    struct ports_job job;
+    data_lock();
+    int hit = cache_lookup(svc, st, &job);
+    unsigned gen = state_gen, seq = event_seq;
+    data_unlock();
+    if (hit) {
+        if (job.due) cache_refresh_ports(svc, &job, st);
+        return;
+    }
+
+    // Cache miss — zuerst sd-bus (ein GetAll pro Interface, kein fork), ohne data_lock
+    struct unit_info info;
+    struct unit_ports ports;
+    query_unit_info(svc, &info);
+    ports_for_unit(&info, &ports);
+
+    data_lock();
+    state_from_info(svc, &info, st);
+    st->ports = ports;
+    cache_store(svc, st, &info, query_gen(gen, seq));
+    data_unlock();
+}
+
+/* Fragt viele Units auf einmal ab: ein pipelined D-Bus-Batch oder ein
+   einziger systemctl-show-Aufruf pro Scope. Frische Cache-Eintraege
+   werden nicht erneut abgefragt. Mit out != NULL landet jeder Zustand
+   zusaetzlich in out[i]; nicht abfragbare bleiben UNIT_SCOPE_UNKNOWN.
+   data_lock() nur fuer Cache-Lookup und Einsortieren, nicht waehrend
+   der Abfrage selbst (Bus-Roundtrip bzw. systemctl) und der Port-Scans.
+   Rueckgabe: Anzahl tatsaechlich abgefragter Units */
+int fetch_unit_states(const char **svcs, int count, struct unit_state *out) {
+    if (!svcs || count <= 0) return 0;
+
+    const char **stale = malloc((size_t)count * sizeof(*stale));
+    int *stale_idx = malloc((size_t)count * sizeof(*stale_idx));
+    struct ports_job *jobs = malloc((size_t)count * sizeof(*jobs));
+    if (!stale || !stale_idx || !jobs) {
+        free(stale);
+        free(stale_idx);
+        free(jobs);
+        return 0;
+    }
+
+    data_lock();
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (!cache_lookup(svcs[i], out ? &out[i] : NULL, &jobs[i])) {
+            stale_idx[n] = i;
+            stale[n++] = svcs[i];
+        }
+    }
+    unsigned gen = state_gen, seq = event_seq;
+    data_unlock();
+
+    for (int i = 0; i < count; i++) {
+        if (jobs[i].due) cache_refresh_ports(svcs[i], &jobs[i], out ? &out[i] : NULL);
+    }
+
+    struct unit_info *infos = n ? calloc((size_t)n, sizeof(*infos)) : NULL;
+    struct unit_ports *ports = n ? calloc((size_t)n, sizeof(*ports)) : NULL;
+    int ok = infos && ports && (bus_get_unit_infos(stale, n, infos) == 0 ||
+                                show_units_cmd(stale, n, infos) == 0);
+    for (int k = 0; ok && k < n; k++) ports_for_unit(&infos[k], &ports[k]);
+
+    data_lock();
+    if (ok) {
+        unsigned store_gen = query_gen(gen, seq);
+        for (int k = 0; k < n; k++) {
+            struct unit_state st;
+            state_from_info(stale[k], &infos[k], &st);
+            st.ports = ports[k];
+            cache_store(stale[k], &st, &infos[k], store_gen);
+            if (out) out[stale_idx[k]] = st;
         }
+    } else if (out) {
+        for (int k = 0; k < n; k++) memset(&out[stale_idx[k]], 0, sizeof(out[0]));
     }
+    data_unlock();
+
+    free(ports);
+    free(infos);
+    free(jobs);
+    free(stale_idx);
+    free(stale);
+    return n;
 }
 
 /* Helper: safe snprintf for command building */
@@ -395,53 +1031,21 @@ int execute_cmd_fmt(char *buf, size_t bufsize, const char *fmt, const char *arg)
 // --------------------------------------------------
 // Alle Services einsammeln
 // --------------------------------------------------
+/* Aus dem Unit-Katalog (ListUnits/ListUnitFiles bzw. systemctl list-units),
+   nicht mehr aus den Verzeichnissen: so sind auch Units unter /usr/lib,
+   generierte und transiente dabei. Die Scopes landen gleich im Scope-Cache. */
 void build_all_services_list(const char *home) {
-    num_all_services = 0;
-
-    DIR *dir = opendir("/etc/systemd/system");
-    if (dir) {
-        struct dirent *entry;
-        while ((entry = readdir(dir)) != NULL && num_all_services < MAX_SERVICES) {
-            size_t dlen = strlen(entry->d_name);
-            if (dlen > 8 && strcmp(entry->d_name + dlen - 8, ".service") == 0) {
-                strncpy(all_services[num_all_services], entry->d_name, MAX_LINE - 1);
-                all_services[num_all_services][MAX_LINE - 1] = '\0';
-                num_all_services++;
-            }
-        }
-        closedir(dir);
-    }
-
-    // User services: also look for symlinks and directories (wants.requires)
-    char search_dirs[3][MAX_LINE];
-    snprintf(search_dirs[0], sizeof(search_dirs[0]), "%s/.config/systemd/user", home);
-    snprintf(search_dirs[1], sizeof(search_dirs[1]), "%s/.config/systemd/user/*.wants", home);
-    snprintf(search_dirs[2], sizeof(search_dirs[2]), "%s/.config/systemd/user/*.requires", home);
-
-    for (int d = 0; d < 3; d++) {
-        dir = opendir(search_dirs[d]);
-        if (!dir) continue;
-        struct dirent *entry;
-        while ((entry = readdir(dir)) != NULL && num_all_services < MAX_SERVICES) {
-            size_t dlen = strlen(entry->d_name);
-            if (dlen > 8 && strcmp(entry->d_name + dlen - 8, ".service") == 0) {
-                // Deduplicate
-                int exists = 0;
-                for (int i = 0; i < num_all_services; i++) {
-                    if (strcmp(all_services[i], entry->d_name) == 0) {
-                        exists = 1;
-                        break;
-                    }
-                }
-                if (!exists) {
-                    strncpy(all_services[num_all_services], entry->d_name, MAX_LINE - 1);
-                    all_services[num_all_services][MAX_LINE - 1] = '\0';
-                    num_all_services++;
-                }
-            }
-        }
-        closedir(dir);
+    (void)home;
+    // Mit inotify kommen neue/geloeschte Unit-Dateien als Deltas (unitwatch.c)
+    if (catalog_count() > 0 && unitwatch_active() && !catalog_stale()) return;
+    int n = catalog_refresh();
+
+    data_lock();
+    for (int i = 0; i < n; i++) {
+        const struct catalog_unit *u = catalog_get(i);
+        scope_map_store(u->name, unit_scope_name(u->scope));
     }
+    data_unlock();
 }
 
 // --------------------------------------------------
@@ -449,7 +1053,7 @@ void build_all_services_list(const char *home) {
 // --------------------------------------------------
 
 static void print_header(const char *title) {
-    system("clear");
+    printf("\033[H\033[2J"); // clear ohne Shell
     printf("%s=====================================================%s\n",
            HEADER_COLOR, RESET_COLOR);
     printf("%s        Systemd Dashboard – Eigene Services          %s\n",
@@ -501,14 +1105,11 @@ void add_service_interactive(const char *home) {
         printf("%sErkannt als %s-Service.%s\n", OK_COLOR, scope, RESET_COLOR);
     }
 
-    if (num_my_services < MAX_SERVICES) {
-        strncpy(my_services[num_my_services], svc, MAX_LINE - 1);
-        my_services[num_my_services][MAX_LINE - 1] = '\0';
-        num_my_services++;
+    if (add_my_service(svc) == 0) {
         save_services(home);
         printf("%sService zu Favoriten hinzugefuegt.%s\n", OK_COLOR, RESET_COLOR);
     } else {
-        printf("%sMaximale Anzahl Services erreicht.%s\n", ERR_COLOR, RESET_COLOR);
+        printf("%sKein Speicher mehr fuer weitere Services.%s\n", ERR_COLOR, RESET_COLOR);
     }
     press_enter_cli();
 }
@@ -544,15 +1145,10 @@ void remove_service_interactive(const char *home) {
     }
 
     idx--; // 0-based
-    char removed[MAX_LINE];
-    strncpy(removed, my_services[idx], MAX_LINE - 1);
-    removed[MAX_LINE - 1] = '\0';
-    invalidate_service_cache(my_services[idx]);
+    const char *removed = my_services[idx];   // String-Pool, bleibt gueltig
+    invalidate_service_cache(removed);
 
-    for (int i = idx; i < num_my_services - 1; ++i) {
-        memmove(my_services[i], my_services[i + 1], MAX_LINE);
-    }
-    num_my_services--;
+    remove_my_service(idx);
     save_services(home);
 
     printf("%sService entfernt:%s %s\n", OK_COLOR, RESET_COLOR, removed);
@@ -560,108 +1156,118 @@ void remove_service_interactive(const char *home) {
 }
 
 // --------------------------------------------------
-// Main Loop - with refresh throttle and resize handling
+// Main Loop - ereignisgesteuert (evloop.c), Resize in wait_events_ui()
 // --------------------------------------------------
+
+#define DASH_FRAME_MS 50      // hoechstens 20 Bilder/s, z.B. bei Tastenwiederholung
+
+static long long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Favoriten koennen in Unteransichten hinzugekommen oder entfernt worden sein
+static int clamp_selected(int selected) {
+    if (num_my_services <= 0) return 0;
+    return selected < num_my_services ? selected : num_my_services - 1;
+}
+
 void main_loop(const char *home) {
     init_ui();
 
-    // Register SIGWINCH handler
-    signal(SIGWINCH, resize_handler);
-
     int selected = 0;
     int focus_on_list = 1;
-    int needs_render = 1; // initial render
-    int render_count = 0; // throttle counter
+    int needs_render = 0;
+    int quit = 0;
+    int frame_timer = ev_timer_new();   // -1: dann ohne Bildratenbremse
 
     render_dashboard_ui(selected, focus_on_list);
-
-    while (1) {
-        // Handle terminal resize
-        if (need_resize) {
-            need_resize = 0;
-            endwin();
-            refresh();
-            doupdate();
-            needs_render = 1;
-        }
-
-        // Bounds checks
-        if (num_my_services <= 0) {
-            selected = 0;
-        } else if (selected >= num_my_services) {
-            selected = num_my_services - 1;
-        }
-
-        // Throttle: only render every 10th tick if nothing changed
-        render_count++;
-        if (render_count >= 10) {
-            render_count = 0;
-            needs_render = 1;
-        }
-
-        int ch = getch();
-
-        if (ch == -1 || ch == ERR) {
-            // No input - only render if throttle triggered
-            if (needs_render) {
-                render_dashboard_ui(selected, focus_on_list);
-                needs_render = 0;
-            }
-            continue;
-        }
-
-        // Key handling
-        if (ch == 'q' || ch == 'Q') {
-            end_ui();
-            printf("\n%sBye%s\n", DIM_COLOR, RESET_COLOR);
-            exit(0);
-        } else if (ch == '\t') {
-            focus_on_list = !focus_on_list;
-            needs_render = 1;
-        } else if (focus_on_list && num_my_services > 0 && (ch == KEY_UP || ch == 'k')) {
-            selected = (selected > 0) ? selected - 1 : num_my_services - 1;
-            needs_render = 1;
-        } else if (focus_on_list && num_my_services > 0 && (ch == KEY_DOWN || ch == 'j')) {
-            selected = (selected < num_my_services - 1) ? selected + 1 : 0;
-            needs_render = 1;
-        } else if ((ch == '\n' || ch == KEY_ENTER) && focus_on_list && num_my_services > 0) {
-            service_detail_page_ui(my_services[selected]);
-            needs_render = 1;
-            render_count = 0;
-        } else if (ch == 'a' || ch == 'A') {
-            add_service_ui(home);
-            invalidate_cache();
-            needs_render = 1;
-        } else if (ch == 'r') {
-            remove_service_ui(home);
-            invalidate_cache();
-            needs_render = 1;
-        } else if (ch == 'R') {
-            load_services(home);
-            needs_render = 1;
-        } else if (ch == 'B' || ch == 'b') {
-            browse_all_services_ui(home);
-            invalidate_cache(); // cache may be stale after browse
-            needs_render = 1;
-        } else if (ch == 'o' || ch == 'O') {
-            if (focus_on_list && num_my_services > 0) {
-                const char *svc = my_services[selected];
-                char *scope = detect_scope(svc);
-                char *port  = guess_port(svc, scope);
-                if (port && strcmp(port, "-") != 0 && strlen(port) > 0) {
-                    open_in_browser_ui(port);
+    long long last_draw = now_ms();
+
+    while (!quit && !ev_quit_requested()) {
+        // Schlaeft ohne Timeout bis Taste, Signal, neuer Snapshot oder Bild-Timer
+        int ev = wait_events_ui(-1, -1);
+        if (ev & (EV_DATA | EV_RESIZE)) needs_render = 1;
+        if (ev_timer_expired(frame_timer)) needs_render = 1;
+
+        // Alle anstehenden Tasten, dann hoechstens ein Bild
+        int ch;
+        while (!quit && (ch = read_key_ui()) != ERR) {
+            selected = clamp_selected(selected);
+            if (ch == 'q' || ch == 'Q') {
+                quit = 1;
+                break;
+            } else if (ch == '\t') {
+                focus_on_list = !focus_on_list;
+                needs_render = 1;
+            } else if (focus_on_list && num_my_services > 0 && (ch == KEY_UP || ch == 'k')) {
+                selected = (selected > 0) ? selected - 1 : num_my_services - 1;
+                needs_render = 1;
+            } else if (focus_on_list && num_my_services > 0 && (ch == KEY_DOWN || ch == 'j')) {
+                selected = (selected < num_my_services - 1) ? selected + 1 : 0;
+                needs_render = 1;
+            } else if (focus_on_list && (ch == KEY_PPAGE || ch == KEY_NPAGE || ch == KEY_HOME || ch == KEY_END)) {
+                selected = list_page_key(ch, selected, num_my_services, dashboard_page_rows());
+                needs_render = 1;
+            } else if ((ch == '\n' || ch == KEY_ENTER) && focus_on_list && num_my_services > 0) {
+                service_detail_page_ui(my_services[selected]);
+                invalidate_dashboard_ui();
+                needs_render = 1;
+            } else if (ch == 'a' || ch == 'A') {
+                add_service_ui(home);
+                invalidate_dashboard_ui();
+                invalidate_cache();
+                needs_render = 1;
+            } else if (ch == 'r') {
+                remove_service_ui(home);
+                invalidate_dashboard_ui();
+                invalidate_cache();
+                needs_render = 1;
+            } else if (ch == 'R') {
+                load_services(home);
+                needs_render = 1;
+            } else if (ch == 'm' && focus_on_list && num_my_services > 0) {
+                toggle_log_mark_ui(my_services[selected]);
+                needs_render = 1;
+            } else if (ch == 'L') {
+                merged_logs_ui();
+                invalidate_dashboard_ui();
+                needs_render = 1;
+            } else if (ch == 'B' || ch == 'b') {
+                browse_all_services_ui(home);
+                invalidate_dashboard_ui();
+                invalidate_cache(); // cache may be stale after browse
+                needs_render = 1;
+            } else if (ch == 'o' || ch == 'O') {
+                if (focus_on_list && num_my_services > 0) {
+                    const char *svc = my_services[selected];
+                    char *scope = detect_scope(svc);
+                    char *port  = guess_port(svc, scope);
+                    if (port && strcmp(port, "-") != 0 && strlen(port) > 0) {
+                        open_in_browser_ui(port);
+                    } else {
+                        show_message_ui("Kein Port erkannt oder Service lauscht nicht.");
+                    }
                 } else {
-                    show_message_ui("Kein Port erkannt oder Service lauscht nicht.");
+                    show_message_ui("Kein Service ausgewaehlt.");
                 }
-            } else {
-                show_message_ui("Kein Service ausgewaehlt.");
+                invalidate_dashboard_ui();
+                needs_render = 1;
             }
         }
+        if (quit || ev_quit_requested()) break;
 
         if (needs_render) {
-            render_dashboard_ui(selected, focus_on_list);
-            needs_render = 0;
-            render_count = 0;
+            selected = clamp_selected(selected);
+            long long left = DASH_FRAME_MS - (now_ms() - last_draw);
+            if (left <= 0 || frame_timer < 0) {
+                render_dashboard_ui(selected, focus_on_list);
+                last_draw = now_ms();
+                needs_render = 0;
+            } else {
+                ev_timer_arm(frame_timer, (int)left);
+            }
         }
     }
 }
@@ -669,9 +1275,30 @@ void main_loop(const char *home) {
 // --------------------------------------------------
 // main
 // --------------------------------------------------
-int main(void) {
+int main(int argc, char **argv) {
+    int daemon_mode = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--daemon") == 0) {
+            daemon_mode = 1;
+        } else {
+            fprintf(stderr, "Aufruf: %s [--daemon]\n", argv[0]);
+            return 2;
+        }
+    }
+
     check_systemctl();
     init_sudo_flag();
+    bus_init(); // optional: ohne Bus laeuft alles ueber systemctl
+
+    if (daemon_mode) {
+        bus_subscribe();
+        int ret = daemon_run();
+        bus_close();
+        return ret;
+    }
+
+    // Laeuft ein Daemon, sammelt der fuer alle; Signale braucht dann nur er
+    if (remote_connect() != 0) bus_subscribe();
 
     const char *home = getenv("HOME");
     if (!home) {
@@ -680,8 +1307,17 @@ int main(void) {
     }
 
     load_services(home);
+    ev_init();      // vor dem Poller-Thread: Signale nur noch ueber signalfd
+    ev_add_fd(unitwatch_init(home));
+    poller_start(); // ab hier fragt nur noch der Poller-Thread Listen ab
+    ev_add_fd(poller_wakeup_fd());
     main_loop(home);
     end_ui();
+    poller_stop();
+    remote_close();
+    bus_close();
+    unitwatch_close();
+    ev_close();
 
     printf("\n%sBye%s\n", DIM_COLOR, RESET_COLOR);
     return 0;
@@ -7,41 +7,53 @@
 #include <signal.h>
 #include <time.h>
 
-#define MAX_SERVICES        1000
 #define MAX_LINE            1024
 #define MAX_DESC            256
+#define MAX_CGROUP          512
 #define DEFAULT_SERVICES_COUNT 3
 #define CONFIG_FILE         "%s/.config/sys-dashboard/services.txt"
 
-extern char my_services[MAX_SERVICES][MAX_LINE];
+// Favoriten: Zeiger in den String-Pool (strpool.h), Zugriff unter data_lock()
+extern const char **my_services;
 extern int  num_my_services;
-extern char all_services[MAX_SERVICES][MAX_LINE];
-extern int  num_all_services;
+int  add_my_service(const char *svc);   // 0 = ok, 1 = schon vorhanden, -1 = kein Speicher
+void remove_my_service(int idx);
 extern const char *sudo_flag;
 
-// Cache-Variablen (für Performance, global sichtbar)
-extern char summary_cache[MAX_SERVICES][MAX_LINE];
-extern int  cache_valid[MAX_SERVICES];
-extern time_t cache_timestamp[MAX_SERVICES];
-
-// Resize signal
-extern volatile sig_atomic_t need_resize;
-void resize_handler(int sig);
-
 void init_sudo_flag(void);
-int execute_cmd(const char *cmd, char *output, size_t max_output);
-int exec_simple(const char *cmd);
+// Subprozesse ohne Shell (spawn.c), mit Deadline
+#define CMD_TIMEOUT_MS      5000
+#define ACTION_TIMEOUT_MS   120000
+// Port-Index (/proc/net) hoechstens so oft neu einlesen
+#define PORT_INDEX_MAX_AGE_MS 1000
+int execute_argv(const char *const argv[], char *output, size_t max_output);
+int exec_simple(const char *const argv[], int timeout_ms);
+int systemctl_value(const char *scope, const char *svc, const char *prop,
+                    char *out, size_t outsize);
+int systemctl_query(const char *scope, const char *verb, const char *svc,
+                    char *out, size_t outsize);
+int systemctl_action(const char *scope, const char *verb, const char *svc);
 void check_systemctl(void);
 void load_services(const char *home);
 void save_services(const char *home);
-void get_service_summary(const char *svc, char *summary, size_t bufsize);
+int  sync_services(const char *home);   // 1 = Favoriten geaendert, 0 = gleich, -1 = Fehler
+struct unit_state;
+struct unit_info;
+void get_unit_state(const char *svc, struct unit_state *st);
+int  query_unit_info(const char *svc, struct unit_info *info);
+int  fetch_unit_states(const char **svcs, int count, struct unit_state *out);
 char *detect_scope(const char *svc);
 char *guess_port(const char *svc, const char *scope);
+struct listen_sock;
+int  get_unit_sockets(const char *cgroup, long main_pid, struct listen_sock *out, int max);
 void build_all_services_list(const char *home);
 void add_service_interactive(const char *home);
 void remove_service_interactive(const char *home);
 void main_loop(const char *home);
 void invalidate_cache(void);
 void invalidate_service_cache(const char *svc);
+int  invalidate_service_cache_event(const char *svc, int min_age);
+int  invalidate_scope_cache_event(void);
+void unit_file_changed(const char *svc);
 
 #endif
@@ -0,0 +1,212 @@
+/* Mock fuer org.freedesktop.systemd1 auf einem privaten Bus (DBUS_SYSTEM_BUS_ADDRESS).
+   Kann genau das, was bus.c benutzt: Properties.GetAll/Get auf Unit-Pfaden,
+   Manager.ListUnits/ListUnitFiles/Subscribe. Signale loest der Test ueber
+   org.sysdash.Mock.Emit(what, unit) aus, damit sie vom Namensbesitzer kommen.
+
+   Aufruf: mock_systemd1 system|user   (zwei Busse = zwei Scopes) */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <systemd/sd-bus.h>
+
+#define SD_DEST        "org.freedesktop.systemd1"
+#define SD_UNIT_PREFIX "/org/freedesktop/systemd1/unit"
+#define SD_UNIT_IFACE  "org.freedesktop.systemd1.Unit"
+#define SD_SVC_IFACE   "org.freedesktop.systemd1.Service"
+#define DBUS_PROPS     "org.freedesktop.DBus.Properties"
+#define SD_MGR_PATH    "/org/freedesktop/systemd1"
+#define SD_MGR_IFACE   "org.freedesktop.systemd1.Manager"
+#define MOCK_IFACE     "org.sysdash.Mock"
+
+struct mock_unit {
+    const char *name;
+    const char *active;
+    const char *sub;
+    const char *enabled;
+    const char *desc;
+    uint32_t main_pid;
+    const char *cgroup;
+};
+
+static const struct mock_unit system_units[] = {
+    { "a.service", "active", "running", "enabled", "Desc of a", 1234, "/system.slice/a.service" },
+    { "b.service", "failed", "failed", "disabled", "Broken b", 0, "/system.slice/b.service" },
+    { "getty@tty1.service", "active", "running", "static", "Getty on tty1", 99, "/system.slice/getty@tty1.service" },
+};
+
+static const struct mock_unit user_units[] = {
+    { "u.service", "active", "running", "enabled", "User thing", 4321, "/user.slice/u.service" },
+};
+
+static const struct mock_unit *units = system_units;
+static int num_units = 3;
+
+static const struct mock_unit *find_unit(const char *name) {
+    for (int i = 0; i < num_units; i++) {
+        if (strcmp(units[i].name, name) == 0) return &units[i];
+    }
+    return NULL;
+}
+
+// Wie systemd: unbekannte Units werden beim Zugriff "geladen" und sind not-found
+static int reply_get_all(sd_bus_message *call, const char *name, const char *iface) {
+    const struct mock_unit *u = find_unit(name);
+    sd_bus_message *reply = NULL;
+    int r = sd_bus_message_new_method_return(call, &reply);
+    if (r < 0) return r;
+
+    sd_bus_message_open_container(reply, 'a', "{sv}");
+    if (strcmp(iface, SD_UNIT_IFACE) == 0) {
+        sd_bus_message_append(reply, "{sv}", "Id", "s", name);
+        sd_bus_message_append(reply, "{sv}", "LoadState", "s", u ? "loaded" : "not-found");
+        sd_bus_message_append(reply, "{sv}", "ActiveState", "s", u ? u->active : "inactive");
+        sd_bus_message_append(reply, "{sv}", "SubState", "s", u ? u->sub : "dead");
+        sd_bus_message_append(reply, "{sv}", "UnitFileState", "s", u ? u->enabled : "");
+        sd_bus_message_append(reply, "{sv}", "Description", "s", u ? u->desc : name);
+        sd_bus_message_append(reply, "{sv}", "NeedDaemonReload", "b", 0);   // wird uebersprungen
+    } else if (strcmp(iface, SD_SVC_IFACE) == 0) {
+        sd_bus_message_append(reply, "{sv}", "MainPID", "u", u ? u->main_pid : 0);
+        sd_bus_message_append(reply, "{sv}", "ControlGroup", "s", u ? u->cgroup : "");
+    }
+    sd_bus_message_close_container(reply);
+
+    r = sd_bus_send(NULL, reply, NULL);
+    sd_bus_message_unref(reply);
+    return r < 0 ? r : 1;
+}
+
+static int on_unit_object(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+    (void)userdata; (void)ret_error;
+
+    char *name = NULL;
+    if (sd_bus_path_decode(sd_bus_message_get_path(m), SD_UNIT_PREFIX, &name) <= 0) return 0;
+
+    int r = 0;
+    const char *iface = NULL, *prop = NULL;
+    if (sd_bus_message_is_method_call(m, DBUS_PROPS, "GetAll")) {
+        if (sd_bus_message_read(m, "s", &iface) >= 0) r = reply_get_all(m, name, iface);
+    } else if (sd_bus_message_is_method_call(m, DBUS_PROPS, "Get")) {
+        if (sd_bus_message_read(m, "ss", &iface, &prop) >= 0 && strcmp(prop, "LoadState") == 0) {
+            r = sd_bus_reply_method_return(m, "v", "s", find_unit(name) ? "loaded" : "not-found");
+        }
+    }
+    free(name);
+    return r;
+}
+
+static int reply_list_units(sd_bus_message *call) {
+    sd_bus_message *reply = NULL;
+    int r = sd_bus_message_new_method_return(call, &reply);
+    if (r < 0) return r;
+
+    sd_bus_message_open_container(reply, 'a', "(ssssssouso)");
+    for (int i = 0; i < num_units; i++) {
+        char *path = NULL;
+        if (sd_bus_path_encode(SD_UNIT_PREFIX, units[i].name, &path) < 0) continue;
+        sd_bus_message_append(reply, "(ssssssouso)", units[i].name, units[i].desc, "loaded",
+                              units[i].active, units[i].sub, "", path, (uint32_t)0, "", "/");
+        free(path);
+    }
+    sd_bus_message_close_container(reply);
+
+    r = sd_bus_send(NULL, reply, NULL);
+    sd_bus_message_unref(reply);
+    return r < 0 ? r : 1;
+}
+
+static int reply_list_unit_files(sd_bus_message *call) {
+    sd_bus_message *reply = NULL;
+    int r = sd_bus_message_new_method_return(call, &reply);
+    if (r < 0) return r;
+
+    sd_bus_message_open_container(reply, 'a', "(ss)");
+    for (int i = 0; i < num_units; i++) {
+        char file[256];
+        snprintf(file, sizeof(file), "/etc/systemd/system/%s", units[i].name);
+        sd_bus_message_append(reply, "(ss)", file, units[i].enabled);
+    }
+    // Nur als Datei vorhanden, nie geladen
+    sd_bus_message_append(reply, "(ss)", "/usr/lib/systemd/system/c.service", "static");
+    sd_bus_message_close_container(reply);
+
+    r = sd_bus_send(NULL, reply, NULL);
+    sd_bus_message_unref(reply);
+    return r < 0 ? r : 1;
+}
+
+static int emit(sd_bus *bus, const char *what, const char *unit) {
+    char *path = NULL;
+    if (sd_bus_path_encode(SD_UNIT_PREFIX, unit, &path) < 0) return -1;
+
+    int r = -1;
+    if (strcmp(what, "PropertiesChanged") == 0) {
+        r = sd_bus_emit_signal(bus, path, DBUS_PROPS, "PropertiesChanged", "sa{sv}as",
+                               SD_UNIT_IFACE, 1, "ActiveState", "s", "inactive", 0);
+    } else if (strcmp(what, "JobRemoved") == 0) {
+        r = sd_bus_emit_signal(bus, SD_MGR_PATH, SD_MGR_IFACE, "JobRemoved", "uoss",
+                               (uint32_t)7, "/org/freedesktop/systemd1/job/7", unit, "done");
+    } else if (strcmp(what, "UnitNew") == 0 || strcmp(what, "UnitRemoved") == 0) {
+        r = sd_bus_emit_signal(bus, SD_MGR_PATH, SD_MGR_IFACE, what, "so", unit, path);
+    } else if (strcmp(what, "Reloading") == 0) {
+        // Erst Beginn, dann Ende: nur das Ende darf invalidieren
+        r = sd_bus_emit_signal(bus, SD_MGR_PATH, SD_MGR_IFACE, "Reloading", "b", 1);
+        if (r >= 0) r = sd_bus_emit_signal(bus, SD_MGR_PATH, SD_MGR_IFACE, "Reloading", "b", 0);
+    } else if (strcmp(what, "UnitFilesChanged") == 0) {
+        r = sd_bus_emit_signal(bus, SD_MGR_PATH, SD_MGR_IFACE, "UnitFilesChanged", NULL);
+    }
+    free(path);
+    return r;
+}
+
+static int on_manager_object(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+    (void)ret_error;
+    sd_bus *bus = userdata;
+
+    if (sd_bus_message_is_method_call(m, SD_MGR_IFACE, "Subscribe")) {
+        return sd_bus_reply_method_return(m, NULL);
+    }
+    if (sd_bus_message_is_method_call(m, SD_MGR_IFACE, "ListUnits")) {
+        return reply_list_units(m);
+    }
+    if (sd_bus_message_is_method_call(m, SD_MGR_IFACE, "ListUnitFiles")) {
+        return reply_list_unit_files(m);
+    }
+    if (sd_bus_message_is_method_call(m, MOCK_IFACE, "Emit")) {
+        const char *what = NULL, *unit = NULL;
+        if (sd_bus_message_read(m, "ss", &what, &unit) < 0 || emit(bus, what, unit) < 0) {
+            return sd_bus_reply_method_errorf(m, "org.sysdash.Mock.Error", "emit failed");
+        }
+        return sd_bus_reply_method_return(m, NULL);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "user") == 0) {
+        units = user_units;
+        num_units = (int)(sizeof(user_units) / sizeof(user_units[0]));
+    }
+
+    sd_bus *bus = NULL;
+    if (sd_bus_open_system(&bus) < 0) {
+        fprintf(stderr, "mock_systemd1: kein Bus (DBUS_SYSTEM_BUS_ADDRESS?)\n");
+        return 1;
+    }
+    if (sd_bus_add_object(bus, NULL, SD_MGR_PATH, on_manager_object, bus) < 0 ||
+        sd_bus_add_fallback(bus, NULL, SD_UNIT_PREFIX, on_unit_object, NULL) < 0 ||
+        sd_bus_request_name(bus, SD_DEST, 0) < 0) {
+        fprintf(stderr, "mock_systemd1: Registrierung fehlgeschlagen\n");
+        return 1;
+    }
+
+    // Laeuft, bis der Test den Bus beendet
+    while (1) {
+        int r = sd_bus_process(bus, NULL);
+        if (r < 0) break;
+        if (r > 0) continue;
+        if (sd_bus_wait(bus, UINT64_MAX) < 0) break;
+    }
+    sd_bus_flush_close_unref(bus);
+    return 0;
+}
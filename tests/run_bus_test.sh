@@ -0,0 +1,52 @@
+#!/bin/sh
+# Baut test_bus + mock_systemd1 und laesst beide gegen zwei private
+# dbus-daemons laufen (einer spielt den System-, einer den User-Bus).
+# Aufruf aus dem Repo-Verzeichnis: sh tests/run_bus_test.sh
+# Braucht dbus-daemon und libsystemd-dev; CC/CFLAGS/SYSTEMD_LIBS ueberschreibbar.
+set -e
+
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:-"-Wall -Wextra -O2"}
+SYSTEMD_LIBS=${SYSTEMD_LIBS:-"-lsystemd"}
+
+dir=$(cd "$(dirname "$0")" && pwd)
+src=$(dirname "$dir")
+tmp=$(mktemp -d)
+pids=""
+
+cleanup() {
+    for p in $pids; do kill "$p" 2>/dev/null || true; done
+    rm -rf "$tmp"
+}
+trap cleanup EXIT INT TERM
+
+$CC $CFLAGS -o "$tmp/mock_systemd1" "$dir/mock_systemd1.c" $SYSTEMD_LIBS
+$CC $CFLAGS -DHAVE_LIBSYSTEMD -o "$tmp/test_bus" "$dir/test_bus.c" \
+    "$src/bus.c" "$src/catalog.c" "$src/spawn.c" "$src/strpool.c" "$src/unitstate.c" \
+    $SYSTEMD_LIBS -lpthread
+
+# Zeile 1: Adresse, Zeile 2: PID
+sys_out=$(dbus-daemon --session --fork --nopidfile --print-address=1 --print-pid=1)
+usr_out=$(dbus-daemon --session --fork --nopidfile --print-address=1 --print-pid=1)
+pids="$(echo "$sys_out" | sed -n 2p) $(echo "$usr_out" | sed -n 2p)"
+sys_addr=$(echo "$sys_out" | sed -n 1p)
+usr_addr=$(echo "$usr_out" | sed -n 1p)
+
+# Der Mock verbindet sich immer per sd_bus_open_system()
+DBUS_SYSTEM_BUS_ADDRESS=$sys_addr "$tmp/mock_systemd1" system &
+pids="$pids $!"
+DBUS_SYSTEM_BUS_ADDRESS=$usr_addr "$tmp/mock_systemd1" user &
+pids="$pids $!"
+
+# Warten, bis beide Mocks ihren Namen haben
+for addr in "$sys_addr" "$usr_addr"; do
+    i=0
+    until dbus-send --bus="$addr" --print-reply --dest=org.freedesktop.DBus / \
+          org.freedesktop.DBus.GetNameOwner string:org.freedesktop.systemd1 >/dev/null 2>&1; do
+        i=$((i + 1))
+        [ $i -lt 50 ] || { echo "mock_systemd1 startet nicht" >&2; exit 1; }
+        sleep 0.1
+    done
+done
+
+DBUS_SYSTEM_BUS_ADDRESS=$sys_addr DBUS_SESSION_BUS_ADDRESS=$usr_addr "$tmp/test_bus"
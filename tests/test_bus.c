@@ -0,0 +1,201 @@
+/* Test fuer bus.c gegen mock_systemd1 auf zwei privaten Bussen
+   (system + user, siehe run_bus_test.sh). Ohne Mock-Bus schlaegt er fehl. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <time.h>
+#include <systemd/sd-bus.h>
+
+#include "../bus.h"
+#include "../catalog.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (cond) printf("ok   %s\n", #cond); \
+    else { printf("FAIL %s (%s:%d)\n", #cond, __FILE__, __LINE__); failures++; } \
+} while (0)
+
+// --------------------------------------------------
+// Ersatz fuer den Cache aus sys_dashboard.c: nur mitschreiben
+// --------------------------------------------------
+static char last_service[256];
+static int last_min_age = -1;
+static int service_events = 0;
+static int scope_events = 0;
+
+int invalidate_service_cache_event(const char *svc, int min_age) {
+    snprintf(last_service, sizeof(last_service), "%s", svc);
+    last_min_age = min_age;
+    service_events++;
+    return 1;
+}
+
+int invalidate_scope_cache_event(void) {
+    scope_events++;
+    return 1;
+}
+
+static void reset_events(void) {
+    last_service[0] = '\0';
+    last_min_age = -1;
+    service_events = scope_events = 0;
+}
+
+// --------------------------------------------------
+// Signale ueber den Mock ausloesen und abholen
+// --------------------------------------------------
+static int mock_emit(sd_bus *ctl, const char *what, const char *unit) {
+    sd_bus_error err = SD_BUS_ERROR_NULL;
+    int r = sd_bus_call_method(ctl, "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
+                               "org.sysdash.Mock", "Emit", &err, NULL, "ss", what, unit);
+    sd_bus_error_free(&err);
+    return r;
+}
+
+static long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+// Wie die Poller-Schleife: poll() auf die Bus-fds, dann abarbeiten
+static int pump_events(int want) {
+    int changed = 0;
+    long deadline = now_ms() + 2000;
+    while (changed < want && now_ms() < deadline) {
+        struct pollfd pfds[BUS_MAX_FDS];
+        int n = bus_fill_pollfds(pfds, BUS_MAX_FDS);
+        poll(pfds, (nfds_t)n, 100);
+        changed += bus_process_events();
+    }
+    return changed;
+}
+
+// --------------------------------------------------
+// Tests
+// --------------------------------------------------
+static void test_unit_info(void) {
+    struct unit_info info;
+
+    CHECK(bus_get_unit_info("a.service", &info) == 0);
+    CHECK(strcmp(info.scope, "system") == 0);
+    CHECK(strcmp(info.active, "active") == 0);
+    CHECK(strcmp(info.enabled, "enabled") == 0);
+    CHECK(strcmp(info.load_state, "loaded") == 0);
+    CHECK(strcmp(info.sub_state, "running") == 0);
+    CHECK(strcmp(info.desc, "Desc of a") == 0);
+    CHECK(info.main_pid == 1234);
+    CHECK(strcmp(info.cgroup, "/system.slice/a.service") == 0);
+
+    CHECK(bus_get_unit_info("u.service", &info) == 0);
+    CHECK(strcmp(info.scope, "user") == 0);
+    CHECK(info.main_pid == 4321);
+
+    CHECK(bus_get_unit_info("missing.service", &info) == 0);
+    CHECK(strcmp(info.scope, "none") == 0);
+}
+
+static void test_unit_infos(void) {
+    const char *names[] = { "a.service", "b.service", "u.service", "missing.service",
+                            "getty@tty1.service" };
+    struct unit_info infos[5];
+
+    CHECK(bus_get_unit_infos(names, 5, infos) == 0);
+    CHECK(strcmp(infos[0].scope, "system") == 0);
+    CHECK(strcmp(infos[1].scope, "system") == 0);
+    CHECK(strcmp(infos[1].active, "failed") == 0);
+    CHECK(strcmp(infos[1].enabled, "disabled") == 0);
+    CHECK(strcmp(infos[2].scope, "user") == 0);
+    CHECK(strcmp(infos[2].desc, "User thing") == 0);
+    CHECK(strcmp(infos[3].scope, "none") == 0);
+    CHECK(infos[3].desc[0] == '\0');
+    CHECK(strcmp(infos[4].scope, "system") == 0);
+    CHECK(infos[4].main_pid == 99);
+}
+
+static void test_detect_scope(void) {
+    char scope[16];
+
+    CHECK(bus_detect_scope("a.service", scope, sizeof(scope)) == 0);
+    CHECK(strcmp(scope, "system") == 0);
+    CHECK(bus_detect_scope("u.service", scope, sizeof(scope)) == 0);
+    CHECK(strcmp(scope, "user") == 0);
+    CHECK(bus_detect_scope("missing.service", scope, sizeof(scope)) == 0);
+    CHECK(strcmp(scope, "none") == 0);
+}
+
+static void test_catalog(void) {
+    CHECK(catalog_refresh() == 5);
+
+    const struct catalog_unit *a = catalog_find("a.service");
+    CHECK(a && a->scope == UNIT_SCOPE_SYSTEM);
+    CHECK(a && strcmp(a->desc, "Desc of a") == 0);
+    CHECK(a && a->active == UNIT_ACTIVE_ACTIVE);
+    CHECK(a && a->enabled == UNIT_ENABLED_ENABLED);
+
+    const struct catalog_unit *c = catalog_find("c.service");
+    CHECK(c && c->load[0] == '\0');
+    CHECK(c && c->enabled == UNIT_ENABLED_STATIC);
+
+    const struct catalog_unit *u = catalog_find("u.service");
+    CHECK(u && u->scope == UNIT_SCOPE_USER);
+}
+
+static void test_signals(sd_bus *ctl) {
+    CHECK(bus_subscribe() == 0);
+    CHECK(bus_events_active());
+
+    reset_events();
+    CHECK(mock_emit(ctl, "PropertiesChanged", "a.service") >= 0);
+    CHECK(pump_events(1) == 1);
+    CHECK(strcmp(last_service, "a.service") == 0 && last_min_age == 0);
+
+    reset_events();
+    CHECK(mock_emit(ctl, "JobRemoved", "b.service") >= 0);
+    CHECK(pump_events(1) == 1);
+    CHECK(strcmp(last_service, "b.service") == 0 && last_min_age == 0);
+
+    reset_events();
+    CHECK(mock_emit(ctl, "UnitNew", "getty@tty1.service") >= 0);
+    CHECK(pump_events(1) == 1);
+    CHECK(strcmp(last_service, "getty@tty1.service") == 0 && last_min_age > 0);
+
+    // Reloading(true) + Reloading(false): nur das Ende zaehlt
+    reset_events();
+    CHECK(mock_emit(ctl, "Reloading", "") >= 0);
+    CHECK(pump_events(1) == 1);
+    CHECK(scope_events == 1 && service_events == 0);
+
+    reset_events();
+    CHECK(mock_emit(ctl, "UnitFilesChanged", "") >= 0);
+    CHECK(pump_events(1) == 1);
+    CHECK(scope_events == 1);
+}
+
+int main(void) {
+    if (bus_init() != 0 || !bus_available()) {
+        printf("FAIL bus_init (DBUS_SYSTEM_BUS_ADDRESS/DBUS_SESSION_BUS_ADDRESS?)\n");
+        return 1;
+    }
+
+    // Eigene Verbindung fuer die Steuer-Aufrufe an den Mock
+    sd_bus *ctl = NULL;
+    if (sd_bus_open_system(&ctl) < 0) {
+        printf("FAIL sd_bus_open_system\n");
+        return 1;
+    }
+
+    test_unit_info();
+    test_unit_infos();
+    test_detect_scope();
+    test_catalog();
+    test_signals(ctl);
+
+    sd_bus_flush_close_unref(ctl);
+    bus_close();
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <ncurses.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -5,23 +6,50 @@
 #include <ctype.h>
 #include <sys/wait.h>
 #include <signal.h>
+#include <poll.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <limits.h>
+#include <strings.h>
+#include <sys/ioctl.h>
 
 #include "ui.h"
 #include "utils.h"
 #include "sys_dashboard.h"
+#include "poller.h"
+#include "spawn.h"
+#include "ports.h"
+#include "history.h"
+#include "journal.h"
+#include "catalog.h"
+#include "bus.h"
+#include "unitstate.h"
+#include "evloop.h"
+#include "unitwatch.h"
 
 // Externe Deklarationen aus sys_dashboard.c
-extern void get_service_summary(const char *svc, char *summary, size_t bufsize);
+extern void get_unit_state(const char *svc, struct unit_state *st);
 extern char *detect_scope(const char *svc);
 extern char *guess_port(const char *svc, const char *scope);
+extern int get_unit_sockets(const char *cgroup, long main_pid, struct listen_sock *out, int max);
 extern void build_all_services_list(const char *home);
 extern void load_services(const char *home);
 extern void save_services(const char *home);
 extern void invalidate_cache(void);
 extern void invalidate_service_cache(const char *svc);
-extern int execute_cmd(const char *cmd, char *output, size_t max_output);
 
 #define DETAIL_LOG_LINES 20
+#define DASH_SPARK_WIDTH 10
+#define DETAIL_CHART_HEIGHT 6
+#define DETAIL_MAX_SOCKETS 64     // abgefragt
+#define DETAIL_SHOW_SOCKETS 8     // angezeigt
+#define DETAIL_WAIT_MS 1000       // spaetestens dann neu zeichnen
+#define DETAIL_PROPS_MS 5000      // frische Unit-Abfrage der Detailseite
+#define LOGVIEW_LINES 1000000     // Live-Logs: Ring nach Zeilen ...
+#define LOGVIEW_TEXT_BYTES (64 * 1024 * 1024)   // ... und nach Bytes
+#define LOGVIEW_BACKLOG 1000      // Zeilen beim Oeffnen
+#define LOGVIEW_FRAME_MS 50       // hoechstens 20 Bilder/s
 
 // ncurses-Fenster
 static WINDOW *main_win = NULL;
@@ -34,6 +62,10 @@ static WINDOW *status_win = NULL;
 // 4: Fehler/Hinweis (rot)
 // 5: Standard (weiss)
 // 6: Auswahl-Hintergrund (invertiert)
+// 7..12: Unit-Markierung in gemischten Logs
+#define UNIT_TAG_PAIR 7
+#define UNIT_TAG_COLORS 6
+#define UNIT_TAG_WIDTH 20
 static void init_colors(void) {
     start_color();
     use_default_colors();
@@ -43,6 +75,12 @@ static void init_colors(void) {
     init_pair(4, COLOR_RED,    -1);
     init_pair(5, COLOR_WHITE,  -1);
     init_pair(6, COLOR_BLACK,  COLOR_CYAN);
+    init_pair(7,  COLOR_CYAN,    -1);
+    init_pair(8,  COLOR_GREEN,   -1);
+    init_pair(9,  COLOR_MAGENTA, -1);
+    init_pair(10, COLOR_YELLOW,  -1);
+    init_pair(11, COLOR_BLUE,    -1);
+    init_pair(12, COLOR_RED,     -1);
 }
 
 // --------------------------------------------------
@@ -78,9 +116,11 @@ void init_ui(void) {
     wrefresh(main_win);
     wrefresh(status_win);
 
-    // halfdelay(5) = 0.5s timeout - seltener pollen spart CPU
-    halfdelay(5);
-    nodelay(stdscr, TRUE);
+    /* Gewartet wird in ev_wait(); main_loop() liest danach alle Tasten von
+       main_win. Nie von stdscr: getch() wuerde das leere stdscr ausgeben
+       und Kopf- und Statuszeile loeschen, die nur bei vollen Bildern kommen.
+       status_win bleibt blockierend (Rueckfragen, Eingaben). */
+    nodelay(main_win, TRUE);
 }
 
 void end_ui(void) {
@@ -107,210 +147,368 @@ void show_message_ui(const char *msg) {
     wrefresh(status_win);
 }
 
-// Hilfsfunktion zum Parsen der Summary
-static void parse_summary(const char *summary, char parts[5][MAX_DESC]) {
-    char temp[MAX_LINE];
-    strncpy(temp, summary, sizeof(temp) - 1);
-    temp[sizeof(temp) - 1] = '\0';
+// Noch nicht vom Poller geliefert -> Platzhalter statt blockierender Abfrage
+static const struct unit_state loading_state = {
+    .scope = UNIT_SCOPE_UNKNOWN, .active = UNIT_ACTIVE_UNKNOWN,
+    .enabled = UNIT_ENABLED_UNKNOWN, .desc = "(wird geladen)",
+};
 
-    char *tok = strtok(temp, "|");
-    int j = 0;
-    while (tok && j < 5) {
-        strncpy(parts[j], tok, MAX_DESC - 1);
-        parts[j][MAX_DESC - 1] = '\0';
-        tok = strtok(NULL, "|");
-        j++;
-    }
-    while (j < 5) {
-        parts[j][0] = '\0';
-        j++;
-    }
+static const struct unit_state *state_or_placeholder(const struct unit_state *st) {
+    return st ? st : &loading_state;
 }
 
 // --------------------------------------------------
 // Dashboard-Rendering
 // --------------------------------------------------
 
-static int color_for_active(const char *state) {
-    if (strcmp(state, "active") == 0) return 2;
-    if (strcmp(state, "inactive") == 0) return 5;
-    if (strcmp(state, "failed") == 0) return 4;
-    return 3;
+static int color_for_active(int state) {
+    switch (state) {
+    case UNIT_ACTIVE_ACTIVE:   return 2;
+    case UNIT_ACTIVE_INACTIVE: return 5;
+    case UNIT_ACTIVE_FAILED:   return 4;
+    default:                   return 3;
+    }
 }
 
-static int color_for_enabled(const char *state) {
-    if (strcmp(state, "enabled") == 0) return 2;
-    if (strcmp(state, "disabled") == 0) return 5;
-    return 3;
+static int color_for_enabled(int state) {
+    switch (state) {
+    case UNIT_ENABLED_ENABLED:  return 2;
+    case UNIT_ENABLED_DISABLED: return 5;
+    default:                    return 3;
+    }
 }
 
-static int color_for_port(const char *port) {
-    if (!port || strcmp(port, "-") == 0 || strlen(port) == 0) return 5;
-    return 2;
+static int color_for_ports(const struct unit_ports *ports) {
+    return (ports && (ports->n > 0 || ports->n_unix > 0)) ? 2 : 5;
 }
 
-void render_dashboard_ui(int selected_idx, int focus_on_list) {
-    if (!main_win || !status_win) return;
-
-    werase(main_win);
-    int maxy, maxx;
-    getmaxyx(main_win, maxy, maxx);
-
-    // Bei resize: Fenster anpassen
-    if (need_resize) {
-        need_resize = 0;
-        endwin();
-        clearok(stdscr, TRUE);
-        refresh();
-        resize_term(0, 0);
-        maxy = LINES; maxx = COLS;
-        int status_height = (maxy > 5) ? 3 : 1;
-        wresize(main_win, maxy - status_height, maxx);
-        wresize(status_win, status_height, maxx);
-        mvwin(status_win, maxy - status_height, 0);
+static const char *const series_names[HIST_NSERIES] = {
+    [HIST_CPU] = "CPU", [HIST_RSS] = "RSS", [HIST_IO] = "IO", [HIST_TASKS] = "Tasks"
+};
+
+// Achsenbeschriftung je Reihe
+static void format_series_value(int series, float v, char *buf, size_t bufsize) {
+    switch (series) {
+    case HIST_CPU: snprintf(buf, bufsize, "%.1f%%", v); break;
+    case HIST_RSS: snprintf(buf, bufsize, "%.1fM", v / 1024.0f); break;
+    case HIST_IO:  snprintf(buf, bufsize, "%.0fK/s", v); break;
+    default:       snprintf(buf, bufsize, "%.0f", v); break;
     }
+}
 
-    int y = 0;
+/* Balkendiagramm einer Verlaufsreihe, neuester Wert rechts.
+   Zeichnet DETAIL_CHART_HEIGHT Zeilen ab *y. */
+static void draw_history_chart(int *y, const struct unit_history *hist, int series, int maxx) {
+    float vals[HISTORY_LEN];
+    int width = maxx - 12;
+    if (width > HISTORY_LEN) width = HISTORY_LEN;
+    int n = hist ? history_series(hist, series, vals, width) : 0;
+    if (n == 0) {
+        mvwprintw(main_win, (*y)++, 0, "  (noch kein Verlauf - nur fuer Favoriten)");
+        return;
+    }
 
-    // Header
-    wattron(main_win, COLOR_PAIR(1) | A_BOLD);
-    mvwprintw(main_win, y++, 0, "=====================================================");
-    mvwprintw(main_win, y++, 0, "        Systemd Dashboard  Eigene Services          ");
-    mvwprintw(main_win, y++, 0, "=====================================================");
-    wattroff(main_win, COLOR_PAIR(1) | A_BOLD);
-    y++;
+    float top = history_scale(series, vals, n);
+    char label[16];
+    for (int row = DETAIL_CHART_HEIGHT - 1; row >= 0; row--) {
+        if (row == DETAIL_CHART_HEIGHT - 1)  format_series_value(series, top, label, sizeof(label));
+        else if (row == 0)                    format_series_value(series, 0.0f, label, sizeof(label));
+        else                                  label[0] = '\0';
+        mvwprintw(main_win, *y, 0, "%9s |", label);
+
+        wattron(main_win, COLOR_PAIR(3));
+        for (int i = 0; i < n; i++) {
+            if (vals[i] < 0) continue;
+            float level = vals[i] / top * DETAIL_CHART_HEIGHT;
+            char c = ' ';
+            if (level >= row + 1)        c = '#';
+            else if (level > row + 0.5f) c = '+';
+            else if (row == 0)           c = '_';
+            if (c != ' ') mvwaddch(main_win, *y, 11 + (width - n) + i, c);
+        }
+        wattroff(main_win, COLOR_PAIR(3));
+        (*y)++;
+    }
+}
 
-    if (num_my_services == 0) {
-        wattron(main_win, COLOR_PAIR(4));
-        mvwprintw(main_win, y++, 0, "Keine Services konfiguriert.");
-        wattroff(main_win, COLOR_PAIR(4));
-        mvwprintw(main_win, y++, 0, "Mit 'a' kannst du Services hinzufuegen.");
-    } else {
-        // Tabellenkopf
-        wattron(main_win, COLOR_PAIR(5) | A_BOLD);
-        mvwprintw(main_win, y,   0, "Nr.");
-        mvwprintw(main_win, y,   5, "SCOPE");
-        mvwprintw(main_win, y,  12, "SERVICE");
-        mvwprintw(main_win, y,  48, "ACTIVE");
-        mvwprintw(main_win, y,  60, "ENABLED");
-        mvwprintw(main_win, y,  74, "PORT");
-        mvwprintw(main_win, y,  82, "DESCRIPTION");
-        y++;
-        mvwhline(main_win, y++, 0, '-', maxx);
-        wattroff(main_win, COLOR_PAIR(5) | A_BOLD);
+/* CPU als "12.3%", RSS mit Einheit ("512K", "48.2M", "1.3G"); "-" = unbekannt */
+static void format_usage(const struct unit_usage *u, char *cpu, size_t cpu_size,
+                         char *rss, size_t rss_size) {
+    snprintf(cpu, cpu_size, "-");
+    snprintf(rss, rss_size, "-");
+    if (!u) return;
+
+    if (u->cpu_pct >= 0) snprintf(cpu, cpu_size, "%.1f%%", u->cpu_pct);
+
+    if (u->rss_kb >= 1024L * 1024L)
+        snprintf(rss, rss_size, "%.1fG", u->rss_kb / (1024.0 * 1024.0));
+    else if (u->rss_kb >= 1024L)
+        snprintf(rss, rss_size, "%.1fM", u->rss_kb / 1024.0);
+    else if (u->rss_kb >= 0)
+        snprintf(rss, rss_size, "%ldK", u->rss_kb);
+}
 
-        // Einträge
-        for (int i = 0; i < num_my_services && y < maxy - 1; i++) {
-            const char *svc = my_services[i];
-            char summary[MAX_LINE];
-            char parts[5][MAX_DESC];
+// --------------------------------------------------
+// Zeilen-Modell: Dashboard und Browse zeichnen nur geaenderte Zeilen
+// --------------------------------------------------
+#define LIST_FRAME_MS 50          // Browse: hoechstens 20 Bilder/s
+#define LIST_PREFETCH_ROWS 5      // ueber/unter dem sichtbaren Ausschnitt mit abfragen
+
+/* Alles, was eine Tabellenzeile sichtbar macht. Namen und Beschreibungen
+   kommen aus dem String-Pool, gleicher Text <=> gleicher Zeiger. */
+struct list_row {
+    const char *name;             // NULL = leere Zeile
+    const char *desc;
+    int nr;
+    unsigned char scope, active, enabled;
+    unsigned char selected, marked, loading;
+    unsigned char port_color;
+    char port[16];
+    char cpu[16], rss[16];        // nur Dashboard
+    char spark_cpu[DASH_SPARK_WIDTH + 1], spark_rss[DASH_SPARK_WIDTH + 1];
+};
+
+/* Zuletzt gezeichnete Zeilen eines Fensters, Index = Fensterzeile.
+   Kopf und Statuszeile werden nur bei einem vollen Bild neu gemalt. */
+struct row_cache {
+    struct list_row *rows;
+    int size;
+    int maxy, maxx;
+    int layout;                   // Kopf haengt davon ab (z.B. leere Liste)
+    int valid;                    // 0 = naechstes Bild komplett
+};
+
+static struct row_cache dash_rows;
+static int dash_top = 0;          // erste sichtbare Favoriten-Zeile
+static int dash_page = 1;         // sichtbare Zeilen
+static char dash_scroll[48];      // zuletzt gezeichnete Position
+
+static int list_row_equal(const struct list_row *a, const struct list_row *b) {
+    return a->name == b->name && a->desc == b->desc && a->nr == b->nr &&
+           a->scope == b->scope && a->active == b->active && a->enabled == b->enabled &&
+           a->selected == b->selected && a->marked == b->marked && a->loading == b->loading &&
+           a->port_color == b->port_color && strcmp(a->port, b->port) == 0 &&
+           strcmp(a->cpu, b->cpu) == 0 && strcmp(a->rss, b->rss) == 0 &&
+           strcmp(a->spark_cpu, b->spark_cpu) == 0 && strcmp(a->spark_rss, b->spark_rss) == 0;
+}
 
-            get_service_summary(svc, summary, sizeof(summary));
-            parse_summary(summary, parts);
+/* Beginnt ein Bild. Rueckgabe 1: Fenster geleert, alles neu zeichnen
+   (erstes Bild, andere Groesse, anderer Aufbau oder invalidiert). */
+static int row_cache_begin(struct row_cache *c, WINDOW *w, int layout) {
+    int maxy, maxx;
+    getmaxyx(w, maxy, maxx);
+    if (c->valid && c->maxy == maxy && c->maxx == maxx && c->layout == layout)
+        return 0;
+
+    if (maxy > c->size) {
+        struct list_row *rows = realloc(c->rows, (size_t)maxy * sizeof(*rows));
+        if (rows) {
+            c->rows = rows;
+            c->size = maxy;
+        }
+    }
+    if (c->rows) memset(c->rows, 0, (size_t)c->size * sizeof(*c->rows));
+    c->maxy = maxy;
+    c->maxx = maxx;
+    c->layout = layout;
+    // Ohne Speicher bleibt jedes Bild ein volles
+    c->valid = c->rows && c->size >= maxy;
+    werase(w);
+    return 1;
+}
 
-            const char *scope_str = parts[0];
-            const char *active    = parts[1];
-            const char *enabled   = parts[2];
-            const char *desc      = parts[3];
-            const char *port      = parts[4];
+// 1 = Zeile y hat sich geaendert und muss gezeichnet werden
+static int row_cache_put(struct row_cache *c, int y, const struct list_row *r) {
+    if (!c->valid || y >= c->size) return 1;
+    if (list_row_equal(&c->rows[y], r)) return 0;
+    c->rows[y] = *r;
+    return 1;
+}
 
-            const char *scope_disp;
-            if (strcmp(scope_str, "system") == 0)      scope_disp = "SYS";
-            else if (strcmp(scope_str, "user") == 0)    scope_disp = "USR";
-            else                                         scope_disp = "???";
+// Leert ab Zeile y alles, was im letzten Bild noch eine Zeile war
+static int row_cache_clear_from(struct row_cache *c, WINDOW *w, int y) {
+    int cleared = 0;
+    if (!c->valid) return 0;
+    for (; y < c->size; y++) {
+        if (!c->rows[y].name) continue;
+        memset(&c->rows[y], 0, sizeof(c->rows[y]));
+        wmove(w, y, 0);
+        wclrtoeol(w);
+        cleared++;
+    }
+    return cleared;
+}
 
-            int is_selected = (i == selected_idx && focus_on_list);
+static void row_cache_free(struct row_cache *c) {
+    free(c->rows);
+    memset(c, 0, sizeof(*c));
+}
 
-            if (is_selected) {
-                wattron(main_win, COLOR_PAIR(6) | A_BOLD);
-            }
+void invalidate_dashboard_ui(void) {
+    dash_rows.valid = 0;
+}
 
-            mvwprintw(main_win, y, 0, "%-3d", i + 1);
-            mvwprintw(main_win, y, 5, "%-4s", scope_disp);
-            mvwprintw(main_win, y, 12, "%-30.30s", svc);
+int dashboard_page_rows(void) {
+    return dash_page;
+}
 
-            int c_active = color_for_active(active);
-            wattron(main_win, COLOR_PAIR(c_active));
-            mvwprintw(main_win, y, 48, "%-10.10s", active);
-            wattroff(main_win, COLOR_PAIR(c_active));
+// Neuer Anfang des Ausschnitts, so dass selected sichtbar bleibt
+static int list_scroll(int top, int selected, int count, int page) {
+    if (selected < top) top = selected;
+    if (selected >= top + page) top = selected - page + 1;
+    if (top > count - page) top = count - page;
+    return top > 0 ? top : 0;
+}
 
-            int c_enabled = color_for_enabled(enabled);
-            wattron(main_win, COLOR_PAIR(c_enabled));
-            mvwprintw(main_win, y, 60, "%-10.10s", enabled);
-            wattroff(main_win, COLOR_PAIR(c_enabled));
+// Bild auf/ab, Pos1/Ende: neue Auswahl
+int list_page_key(int ch, int selected, int count, int page) {
+    if (count <= 0) return 0;
+    if (ch == KEY_PPAGE) selected -= page;
+    else if (ch == KEY_NPAGE) selected += page;
+    else if (ch == KEY_HOME) selected = 0;
+    else if (ch == KEY_END) selected = count - 1;
+    if (selected >= count) selected = count - 1;
+    return selected > 0 ? selected : 0;
+}
 
-            int c_port = color_for_port(port);
-            wattron(main_win, COLOR_PAIR(c_port));
-            mvwprintw(main_win, y, 74, "%-6.6s", port);
-            wattroff(main_win, COLOR_PAIR(c_port));
+// Zeilen [*first, *first + Rueckgabe) inkl. Rand, fuer die Daten geholt werden
+static int list_prefetch(int top, int page, int count, int *first) {
+    int lo = top - LIST_PREFETCH_ROWS;
+    int hi = top + page + LIST_PREFETCH_ROWS;
+    if (lo < 0) lo = 0;
+    if (hi > count) hi = count;
+    *first = lo;
+    return hi > lo ? hi - lo : 0;
+}
 
-            mvwprintw(main_win, y, 82, "%.*s", maxx - 83, desc);
+/* Trennlinie unter dem Tabellenkopf, bei langen Listen rechts mit der
+   Position (" 41-72/300 "). Nur neu gezeichnet, wenn sich der Text aendert. */
+static int draw_list_rule(int y, int top, int shown, int count, int full, char *last, size_t size) {
+    char buf[48] = "";
+    if (count > shown && shown > 0) snprintf(buf, sizeof(buf), " %d-%d/%d ", top + 1, top + shown, count);
+    if (!full && strcmp(buf, last) == 0) return 0;
+    snprintf(last, size, "%s", buf);
+
+    int maxx = getmaxx(main_win);
+    wattron(main_win, COLOR_PAIR(5) | A_BOLD);
+    mvwhline(main_win, y, 0, '-', maxx);
+    if (buf[0] && maxx > (int)strlen(buf) + 2) mvwprintw(main_win, y, maxx - (int)strlen(buf) - 2, "%s", buf);
+    wattroff(main_win, COLOR_PAIR(5) | A_BOLD);
+    return 1;
+}
 
-            if (is_selected) {
-                wattroff(main_win, COLOR_PAIR(6) | A_BOLD);
-            }
+static long long ui_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
 
-            y++;
-        }
+/* Einzige Stelle fuer Groessenaenderungen: Terminalgroesse neu lesen,
+   Fenster anpassen, beim naechsten Bild alles neu ausgeben. */
+static void ui_resize(void) {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        resizeterm(ws.ws_row, ws.ws_col);
     }
+    int status_height = (LINES > 5) ? 3 : 1;
+    wresize(main_win, LINES - status_height, COLS);
+    wresize(status_win, status_height, COLS);
+    mvwin(status_win, LINES - status_height, 0);
+    clearok(curscr, TRUE);
+    dash_rows.valid = 0;
+}
 
-    wborder(main_win, 0,0,0,0,0,0,0,0);
-    wrefresh(main_win);
+/* Wartet auf Taste, Signal, neue Journal-Eintraege oder einen neuen
+   Snapshot. Groessenaenderungen sind bei der Rueckkehr schon erledigt.
+   Rueckgabe: EV_*-Bits (EV_KEY = Taste liegt an) */
+int wait_events_ui(int journal_fd, int timeout_ms) {
+    int ev = ev_wait(journal_fd, timeout_ms);
+    if (ev & EV_RESIZE) ui_resize();
+    if (ev & EV_DATA) {
+        poller_drain_wakeup();
+        unitwatch_process();   // Deltas fuer Katalog und Favoriten
+    }
+    return ev;
+}
 
-    // Status-Zeile
-    werase(status_win);
-    wattron(status_win, COLOR_PAIR(1) | A_BOLD);
-    mvwprintw(status_win, 0, 0, " Pfeile/jk: Auswahl | Enter: Details | o: Browser | a: Add | x: Remove | R: Reload | B: Browse | Tab: Fokus | r: Restart | q: Quit");
-    wattroff(status_win, COLOR_PAIR(1) | A_BOLD);
-    box(status_win, 0, 0);
-    wrefresh(status_win);
+int read_key_ui(void) {
+    return wgetch(main_win);
 }
 
 // --------------------------------------------------
-// Browse-All-Services
+// Dashboard-Tabelle
 // --------------------------------------------------
-void browse_all_services_ui(const char *home) {
-    build_all_services_list(home);
+static void draw_dash_row(int y, const struct list_row *r, int maxx) {
+    wmove(main_win, y, 0);
+    wclrtoeol(main_win);
+    if (r->selected) wattron(main_win, COLOR_PAIR(6) | A_BOLD);
+
+    mvwprintw(main_win, y, 0, "%-3d%c", r->nr, r->marked ? '*' : ' ');
+    mvwprintw(main_win, y, 5, "%-4s", unit_scope_label(r->scope));
+    mvwprintw(main_win, y, 12, "%-30.30s", r->name);
+
+    int c_active = color_for_active(r->active);
+    wattron(main_win, COLOR_PAIR(c_active));
+    mvwprintw(main_win, y, 48, "%-10.10s", r->loading ? "..." : unit_active_name(r->active));
+    wattroff(main_win, COLOR_PAIR(c_active));
+
+    int c_enabled = color_for_enabled(r->enabled);
+    wattron(main_win, COLOR_PAIR(c_enabled));
+    mvwprintw(main_win, y, 60, "%-10.10s", r->loading ? "..." : unit_enabled_name(r->enabled));
+    wattroff(main_win, COLOR_PAIR(c_enabled));
+
+    wattron(main_win, COLOR_PAIR(r->port_color));
+    mvwprintw(main_win, y, 74, "%-6.6s", r->port);
+    wattroff(main_win, COLOR_PAIR(r->port_color));
+
+    mvwprintw(main_win, y, 82, "%6s", r->cpu);
+    mvwprintw(main_win, y, 100, "%7s", r->rss);
+
+    if (r->spark_cpu[0]) {
+        wattron(main_win, COLOR_PAIR(3));
+        mvwprintw(main_win, y, 89, "%s", r->spark_cpu);
+        mvwprintw(main_win, y, 108, "%s", r->spark_rss);
+        wattroff(main_win, COLOR_PAIR(3));
+    }
 
-    char filter[256] = "";
-    int filtered_idx[MAX_SERVICES];
-    int filtered_count = 0;
-    int selected = 0;
+    if (maxx > 121) mvwprintw(main_win, y, 120, "%.*s", maxx - 121, r->desc);
 
-    while (1) {
-        filtered_count = 0;
-        for (int i = 0; i < num_all_services && filtered_count < MAX_SERVICES; i++) {
-            if (filter[0] != '\0' && strstr(all_services[i], filter) == NULL) {
-                continue;
-            }
-            filtered_idx[filtered_count++] = i;
-        }
-        if (selected >= filtered_count && filtered_count > 0) selected = filtered_count - 1;
-        if (selected < 0) selected = 0;
+    if (r->selected) wattroff(main_win, COLOR_PAIR(6) | A_BOLD);
+}
 
-        werase(main_win);
-        int maxy, maxx;
-        getmaxyx(main_win, maxy, maxx);
-        int y = 0;
+/* Zeichnet nur Zeilen, deren Modell sich seit dem letzten Bild geaendert
+   hat, und schickt alles mit einem doupdate() raus. Ohne Aenderung
+   geht nichts ans Terminal. */
+void render_dashboard_ui(int selected_idx, int focus_on_list) {
+    if (!main_win || !status_win) return;
+
+    int full = row_cache_begin(&dash_rows, main_win, num_my_services == 0);
+    int changed = full;
+    int maxy, maxx;
+    getmaxyx(main_win, maxy, maxx);
 
+    if (full) {
         wattron(main_win, COLOR_PAIR(1) | A_BOLD);
-        mvwprintw(main_win, y++, 0, "=====================================================");
-        mvwprintw(main_win, y++, 0, "        Alle Services System + User                ");
-        mvwprintw(main_win, y++, 0, "=====================================================");
+        mvwprintw(main_win, 0, 0, "=====================================================");
+        mvwprintw(main_win, 1, 0, "        Systemd Dashboard  Eigene Services          ");
+        mvwprintw(main_win, 2, 0, "=====================================================");
         wattroff(main_win, COLOR_PAIR(1) | A_BOLD);
-        y++;
-
-        wattron(main_win, COLOR_PAIR(5));
-        mvwprintw(main_win, y++, 0,
-                  "Suche: [%s]  (/ Filter, Pfeile/jk, Enter=Details, a=Fav, o=Browser, q=Zurueck)", filter);
-        wattroff(main_win, COLOR_PAIR(5));
-        y++;
+    }
+    int y = 4;
 
-        if (filtered_count == 0) {
+    if (num_my_services == 0) {
+        if (full) {
             wattron(main_win, COLOR_PAIR(4));
-            mvwprintw(main_win, y++, 0, "Keine Services gefunden.");
+            mvwprintw(main_win, y, 0, "Keine Services konfiguriert.");
             wattroff(main_win, COLOR_PAIR(4));
-        } else {
+            mvwprintw(main_win, y + 1, 0, "Mit 'a' kannst du Services hinzufuegen.");
+        }
+        y += 2;
+        dash_top = 0;
+        poller_view_favorites(0, 0);
+    } else {
+        if (full) {
+            // Tabellenkopf
             wattron(main_win, COLOR_PAIR(5) | A_BOLD);
             mvwprintw(main_win, y,   0, "Nr.");
             mvwprintw(main_win, y,   5, "SCOPE");
@@ -318,90 +516,319 @@ void browse_all_services_ui(const char *home) {
             mvwprintw(main_win, y,  48, "ACTIVE");
             mvwprintw(main_win, y,  60, "ENABLED");
             mvwprintw(main_win, y,  74, "PORT");
-            mvwprintw(main_win, y,  82, "DESCRIPTION");
-            y++;
-            mvwhline(main_win, y++, 0, '-', maxx);
+            mvwprintw(main_win, y,  82, "   CPU");
+            mvwprintw(main_win, y,  89, "Verlauf");
+            mvwprintw(main_win, y, 100, "    RSS");
+            mvwprintw(main_win, y, 108, "Verlauf");
+            mvwprintw(main_win, y, 120, "DESCRIPTION");
             wattroff(main_win, COLOR_PAIR(5) | A_BOLD);
+        }
+        y++;
 
-            for (int k = 0; k < filtered_count && y < maxy - 1; k++) {
-                int idx = filtered_idx[k];
-                const char *svc = all_services[idx];
+        // Ausschnitt um die Auswahl; nur dessen Favoriten fragt der Poller ab
+        dash_page = maxy - 2 - y > 0 ? maxy - 2 - y : 1;
+        dash_top = list_scroll(dash_top, selected_idx, num_my_services, dash_page);
+        int first;
+        int n = list_prefetch(dash_top, dash_page, num_my_services, &first);
+        poller_view_favorites(first, n);
 
-                char summary[MAX_LINE];
-                char parts[5][MAX_DESC];
-                get_service_summary(svc, summary, sizeof(summary));
-                parse_summary(summary, parts);
+        int shown = num_my_services - dash_top < dash_page ? num_my_services - dash_top : dash_page;
+        if (draw_list_rule(y, dash_top, shown, num_my_services, full, dash_scroll, sizeof(dash_scroll)))
+            changed = 1;
+        y++;
 
-                const char *scope_str = parts[0];
-                const char *active    = parts[1];
-                const char *enabled   = parts[2];
-                const char *desc      = parts[3];
-                const char *port      = parts[4];
+        // Daten kommen fertig vom Poller-Thread, hier wird nichts abgefragt
+        const struct snapshot *snap = poller_snapshot();
 
-                const char *scope_disp;
-                if (strcmp(scope_str, "system") == 0)      scope_disp = "SYS";
-                else if (strcmp(scope_str, "user") == 0)    scope_disp = "USR";
-                else                                         scope_disp = "???";
+        for (int i = dash_top; i < num_my_services && y < maxy - 1; i++, y++) {
+            const char *svc = my_services[i];
+            int hint = i - snap->fav_first;
+            const struct unit_state *st = state_or_placeholder(snapshot_state(snap, hint, svc));
+
+            struct list_row r;
+            memset(&r, 0, sizeof(r));
+            r.name = svc;
+            r.desc = st->desc;
+            r.nr = i + 1;
+            r.scope = st->scope;
+            r.active = st->active;
+            r.enabled = st->enabled;
+            r.selected = (i == selected_idx && focus_on_list);
+            r.marked = is_log_marked(svc);
+            r.loading = (st == &loading_state);
+            port_format_compact(&st->ports, r.port, sizeof(r.port));
+            r.port_color = (unsigned char)color_for_ports(&st->ports);
+            format_usage(snapshot_usage(snap, hint, svc), r.cpu, sizeof(r.cpu), r.rss, sizeof(r.rss));
+
+            const struct unit_history *hist = snapshot_history(snap, hint, svc);
+            if (hist) {
+                history_sparkline(hist, HIST_CPU, r.spark_cpu, DASH_SPARK_WIDTH);
+                history_sparkline(hist, HIST_RSS, r.spark_rss, DASH_SPARK_WIDTH);
+            }
 
-                int is_selected = (k == selected);
-                if (is_selected) wattron(main_win, COLOR_PAIR(6) | A_BOLD);
+            if (row_cache_put(&dash_rows, y, &r)) {
+                draw_dash_row(y, &r, maxx);
+                changed = 1;
+            }
+        }
+    }
+    if (row_cache_clear_from(&dash_rows, main_win, y) > 0) changed = 1;
 
-                mvwprintw(main_win, y, 0, "%-3d", k + 1);
-                mvwprintw(main_win, y, 5, "%-4s", scope_disp);
-                mvwprintw(main_win, y, 12, "%-30.30s", svc);
+    if (changed) {
+        wborder(main_win, 0,0,0,0,0,0,0,0);
+        wnoutrefresh(main_win);
+    }
 
-                wattron(main_win, COLOR_PAIR(color_for_active(active)));
-                mvwprintw(main_win, y, 48, "%-10.10s", active);
-                wattroff(main_win, COLOR_PAIR(color_for_active(active)));
+    // Status-Zeile
+    if (full) {
+        werase(status_win);
+        wattron(status_win, COLOR_PAIR(1) | A_BOLD);
+        mvwprintw(status_win, 0, 0, " Pfeile/jk: Auswahl | Enter: Details | o: Browser | a: Add | x: Remove | R: Reload | B: Browse | Tab: Fokus | r: Restart | m/L: Logs | q: Quit");
+        wattroff(status_win, COLOR_PAIR(1) | A_BOLD);
+        box(status_win, 0, 0);
+        wnoutrefresh(status_win);
+    }
 
-                wattron(main_win, COLOR_PAIR(color_for_enabled(enabled)));
-                mvwprintw(main_win, y, 60, "%-10.10s", enabled);
-                wattroff(main_win, COLOR_PAIR(color_for_enabled(enabled)));
+    if (changed) doupdate();
+}
 
-                wattron(main_win, COLOR_PAIR(color_for_port(port)));
-                mvwprintw(main_win, y, 74, "%-6.6s", port);
-                wattroff(main_win, COLOR_PAIR(color_for_port(port)));
+// --------------------------------------------------
+// Browse-All-Services
+// --------------------------------------------------
+struct browse_view {
+    struct catalog_filter flt;
+    char filter[CATALOG_QUERY_LEN];
+    int filter_len;
+    int typing;                   // Filter nimmt gerade Tasten an
+    int selected;
+    int count;                    // Treffer fuer filter
+    int top;                      // erster sichtbarer Treffer
+    int page;                     // sichtbare Zeilen
+    struct row_cache rows;
+    char search_line[256];        // zuletzt gezeichnet
+    char scroll_info[48];
+    int status_mode;              // zuletzt gezeichnete Statuszeile, -1 = keine
+};
+
+static void draw_browse_row(int y, const struct list_row *r, int maxx) {
+    wmove(main_win, y, 0);
+    wclrtoeol(main_win);
+    if (r->selected) wattron(main_win, COLOR_PAIR(6) | A_BOLD);
+
+    mvwprintw(main_win, y, 0, "%-3d", r->nr);
+    mvwprintw(main_win, y, 5, "%-4s", unit_scope_label(r->scope));
+    mvwprintw(main_win, y, 12, "%-30.30s", r->name);
+
+    wattron(main_win, COLOR_PAIR(color_for_active(r->active)));
+    mvwprintw(main_win, y, 48, "%-10.10s", unit_active_name(r->active));
+    wattroff(main_win, COLOR_PAIR(color_for_active(r->active)));
+
+    wattron(main_win, COLOR_PAIR(color_for_enabled(r->enabled)));
+    mvwprintw(main_win, y, 60, "%-10.10s", unit_enabled_name(r->enabled));
+    wattroff(main_win, COLOR_PAIR(color_for_enabled(r->enabled)));
+
+    wattron(main_win, COLOR_PAIR(r->port_color));
+    mvwprintw(main_win, y, 74, "%-6.6s", r->port);
+    wattroff(main_win, COLOR_PAIR(r->port_color));
+
+    mvwprintw(main_win, y, 82, "%.*s", maxx - 83, r->desc);
+
+    if (r->selected) wattroff(main_win, COLOR_PAIR(6) | A_BOLD);
+}
 
-                mvwprintw(main_win, y, 82, "%.*s", maxx - 83, desc);
+static void draw_browse_view(struct browse_view *v) {
+    int full = row_cache_begin(&v->rows, main_win, v->count == 0);
+    int changed = full;
+    int maxy, maxx;
+    getmaxyx(main_win, maxy, maxx);
 
-                if (is_selected) wattroff(main_win, COLOR_PAIR(6) | A_BOLD);
-                y++;
-            }
+    if (full) {
+        wattron(main_win, COLOR_PAIR(1) | A_BOLD);
+        mvwprintw(main_win, 0, 0, "=====================================================");
+        mvwprintw(main_win, 1, 0, "        Alle Services System + User                ");
+        mvwprintw(main_win, 2, 0, "=====================================================");
+        wattroff(main_win, COLOR_PAIR(1) | A_BOLD);
+        v->status_mode = -1;
+    }
+    int y = 4;
+
+    char line[sizeof(v->search_line)];
+    if (v->typing)
+        snprintf(line, sizeof(line), "Suche: [%s_]  %d Treffer  (Tippen filtert, Enter=fertig, Esc=leeren)",
+                 v->filter, v->count);
+    else
+        snprintf(line, sizeof(line),
+                 "Suche: [%s]  (/ Filter, Pfeile/jk, Enter=Details, a=Fav, o=Browser, q=Zurueck)", v->filter);
+    if (full || strcmp(line, v->search_line) != 0) {
+        snprintf(v->search_line, sizeof(v->search_line), "%s", line);
+        wmove(main_win, y, 0);
+        wclrtoeol(main_win);
+        wattron(main_win, COLOR_PAIR(5));
+        mvwprintw(main_win, y, 0, "%s", line);
+        wattroff(main_win, COLOR_PAIR(5));
+        changed = 1;
+    }
+    y += 2;
+
+    if (v->count == 0) {
+        if (full) {
+            wattron(main_win, COLOR_PAIR(4));
+            mvwprintw(main_win, y, 0, "Keine Services gefunden.");
+            wattroff(main_win, COLOR_PAIR(4));
         }
+        y++;
+        poller_watch(NULL, 0);
+    } else {
+        if (full) {
+            wattron(main_win, COLOR_PAIR(5) | A_BOLD);
+            mvwprintw(main_win, y,   0, "Nr.");
+            mvwprintw(main_win, y,   5, "SCOPE");
+            mvwprintw(main_win, y,  12, "SERVICE");
+            mvwprintw(main_win, y,  48, "ACTIVE");
+            mvwprintw(main_win, y,  60, "ENABLED");
+            mvwprintw(main_win, y,  74, "PORT");
+            mvwprintw(main_win, y,  82, "DESCRIPTION");
+            wattroff(main_win, COLOR_PAIR(5) | A_BOLD);
+        }
+        y++;
+
+        v->page = maxy - 2 - y > 0 ? maxy - 2 - y : 1;
+        v->top = list_scroll(v->top, v->selected, v->count, v->page);
+        int shown = v->count - v->top < v->page ? v->count - v->top : v->page;
+        if (draw_list_rule(y, v->top, shown, v->count, full, v->scroll_info, sizeof(v->scroll_info)))
+            changed = 1;
+        y++;
 
-        wrefresh(main_win);
+        // Nur den Ausschnitt (plus Rand) beim Poller anmelden
+        int first;
+        int n = list_prefetch(v->top, v->page, v->count, &first);
+        const char *watch[n > 0 ? n : 1];
+        for (int k = 0; k < n; k++) {
+            watch[k] = catalog_get(catalog_filter_at(&v->flt, first + k))->name;
+        }
+        poller_watch(watch, n);
+        const struct snapshot *snap = poller_snapshot();
+
+        for (int k = v->top; k < v->count && y < maxy - 1; k++, y++) {
+            // Beschreibung aus dem Katalog, Zustand und Port vom Poller, sobald da
+            const struct catalog_unit *u = catalog_get(catalog_filter_at(&v->flt, k));
+            const struct unit_state *st = snapshot_state(snap, snap->view_offset + k - first, u->name);
+
+            struct list_row r;
+            memset(&r, 0, sizeof(r));
+            r.name = u->name;
+            r.desc = u->desc;
+            r.nr = k + 1;
+            r.scope = u->scope;
+            // Der Katalog wird nicht bei jedem Oeffnen neu eingesammelt: sichtbare Zeilen live
+            r.active = st ? st->active : u->active;
+            r.enabled = st ? st->enabled : u->enabled;
+            r.selected = (k == v->selected);
+            snprintf(r.port, sizeof(r.port), "...");
+            if (st) port_format_compact(&st->ports, r.port, sizeof(r.port));
+            r.port_color = (unsigned char)color_for_ports(st ? &st->ports : NULL);
+
+            if (row_cache_put(&v->rows, y, &r)) {
+                draw_browse_row(y, &r, maxx);
+                changed = 1;
+            }
+        }
+    }
+    if (row_cache_clear_from(&v->rows, main_win, y) > 0) changed = 1;
+    if (changed) wnoutrefresh(main_win);
 
+    if (v->status_mode != v->typing) {
+        v->status_mode = v->typing;
         werase(status_win);
         wattron(status_win, COLOR_PAIR(5));
-        mvwprintw(status_win, 0, 0,
-                  "Browse: Pfeile/jk | Enter=Details | / Filter | a=Favorit | o=Browser | q=Zurueck");
+        if (v->typing)
+            mvwprintw(status_win, 0, 0,
+                      "Filter: Tippen | Backspace | Pfeile | Enter=fertig | Esc=leeren");
+        else
+            mvwprintw(status_win, 0, 0,
+                      "Browse: Pfeile/jk | Enter=Details | / Filter | a=Favorit | o=Browser | q=Zurueck");
         wattroff(status_win, COLOR_PAIR(5));
-        wrefresh(status_win);
+        wnoutrefresh(status_win);
+        changed = 1;
+    }
+
+    if (changed) doupdate();
+}
 
+void browse_all_services_ui(const char *home) {
+    build_all_services_list(home);
+
+    // Filter waehrend des Tippens; Katalog-Deltas (inotify) setzen ihn ueber gen zurueck
+    struct browse_view v;
+    memset(&v, 0, sizeof(v));
+    catalog_filter_init(&v.flt);
+    v.status_mode = -1;
+    long long last_draw = 0;
+
+    while (1) {
+        v.count = catalog_filter_set(&v.flt, v.filter);
+        if (v.selected >= v.count && v.count > 0) v.selected = v.count - 1;
+        if (v.selected < 0) v.selected = 0;
+
+        // Tastenwiederholung fasst mehrere Schritte zu einem Bild zusammen;
+        // sonst schlafen bis Taste oder neuer Snapshot
+        int wait_ms = -1;
+        long long now = ui_now_ms();
+        if (now - last_draw >= LIST_FRAME_MS) {
+            draw_browse_view(&v);
+            last_draw = now;
+        } else {
+            wait_ms = (int)(LIST_FRAME_MS - (now - last_draw));
+        }
+
+        int ev = wait_events_ui(-1, wait_ms);
+        if (ev_quit_requested()) break;
+        if (!(ev & EV_KEY)) continue;
         int ch = wgetch(main_win);
+        if (ch == ERR) continue;
+
+        if (v.typing) {
+            // Jede Taste filtert sofort; Pfeile blaettern weiter
+            if (ch == 27) {
+                v.filter[0] = '\0';
+                v.filter_len = 0;
+                v.typing = 0;
+                v.selected = 0;
+            } else if (ch == '\n' || ch == KEY_ENTER) {
+                v.typing = 0;
+            } else if (ch == KEY_BACKSPACE || ch == 127 || ch == 8) {
+                if (v.filter_len > 0) v.filter[--v.filter_len] = '\0';
+                v.selected = 0;
+            } else if (ch == KEY_UP && v.count > 0) {
+                v.selected = (v.selected > 0) ? v.selected - 1 : v.count - 1;
+            } else if (ch == KEY_DOWN && v.count > 0) {
+                v.selected = (v.selected < v.count - 1) ? v.selected + 1 : 0;
+            } else if (ch == KEY_PPAGE || ch == KEY_NPAGE || ch == KEY_HOME || ch == KEY_END) {
+                v.selected = list_page_key(ch, v.selected, v.count, v.page);
+            } else if (ch >= 0x20 && ch < 0x7f && v.filter_len < (int)sizeof(v.filter) - 1) {
+                v.filter[v.filter_len++] = (char)ch;
+                v.filter[v.filter_len] = '\0';
+                v.selected = 0;
+            }
+            continue;
+        }
 
         if (ch == 'q' || ch == 'Q' || ch == 27) {
+            poller_watch(NULL, 0);
             break;
-        } else if ((ch == KEY_UP || ch == 'k') && filtered_count > 0) {
-            selected = (selected > 0) ? selected - 1 : filtered_count - 1;
-        } else if ((ch == KEY_DOWN || ch == 'j') && filtered_count > 0) {
-            selected = (selected < filtered_count - 1) ? selected + 1 : 0;
+        } else if ((ch == KEY_UP || ch == 'k') && v.count > 0) {
+            v.selected = (v.selected > 0) ? v.selected - 1 : v.count - 1;
+        } else if ((ch == KEY_DOWN || ch == 'j') && v.count > 0) {
+            v.selected = (v.selected < v.count - 1) ? v.selected + 1 : 0;
+        } else if (ch == KEY_PPAGE || ch == KEY_NPAGE || ch == KEY_HOME || ch == KEY_END) {
+            v.selected = list_page_key(ch, v.selected, v.count, v.page);
         } else if (ch == '/') {
-            werase(status_win);
-            wattron(status_win, COLOR_PAIR(5));
-            mvwprintw(status_win, 0, 0, "Filter: ");
-            wattroff(status_win, COLOR_PAIR(5));
-            wrefresh(status_win);
-            echo();
-            curs_set(1);
-            wgetnstr(status_win, filter, sizeof(filter) - 1);
-            noecho();
-            curs_set(0);
-            selected = 0;
-        } else if ((ch == '\n' || ch == KEY_ENTER) && filtered_count > 0) {
-            service_detail_page_ui(all_services[filtered_idx[selected]]);
-        } else if ((ch == 'o' || ch == 'O') && filtered_count > 0) {
-            const char *svc = all_services[filtered_idx[selected]];
+            v.typing = 1;
+        } else if ((ch == '\n' || ch == KEY_ENTER) && v.count > 0) {
+            service_detail_page_ui(catalog_get(catalog_filter_at(&v.flt, v.selected))->name);
+            v.rows.valid = 0;
+        } else if ((ch == 'o' || ch == 'O') && v.count > 0) {
+            const char *svc = catalog_get(catalog_filter_at(&v.flt, v.selected))->name;
             char *scope = detect_scope(svc);
             char *port  = guess_port(svc, scope);
             if (port && strcmp(port, "-") != 0 && strlen(port) > 0) {
@@ -409,34 +836,496 @@ void browse_all_services_ui(const char *home) {
             } else {
                 show_message_ui("Kein Port erkannt oder Service lauscht nicht.");
             }
-        } else if ((ch == 'a' || ch == 'A') && filtered_count > 0) {
-            const char *svc = all_services[filtered_idx[selected]];
-            int exists = 0;
-            for (int i = 0; i < num_my_services; i++) {
-                if (strcmp(my_services[i], svc) == 0) { exists = 1; break; }
-            }
-            if (exists) {
+            v.rows.valid = 0;
+        } else if ((ch == 'a' || ch == 'A') && v.count > 0) {
+            const char *svc = catalog_get(catalog_filter_at(&v.flt, v.selected))->name;
+            data_lock();
+            int r = add_my_service(svc);
+            data_unlock();
+            if (r == 1) {
                 show_message_ui("Service ist bereits in den Favoriten.");
-            } else if (num_my_services >= MAX_SERVICES) {
-                show_message_ui("Maximale Anzahl Favoriten erreicht.");
+            } else if (r < 0) {
+                show_message_ui("Kein Speicher mehr fuer weitere Favoriten.");
             } else {
-                strncpy(my_services[num_my_services], svc, MAX_LINE - 1);
-                my_services[num_my_services][MAX_LINE - 1] = '\0';
-                num_my_services++;
                 save_services(home);
                 invalidate_cache();
                 show_message_ui("Service zu Favoriten hinzugefuegt.");
             }
+            v.rows.valid = 0;
         }
     }
+    row_cache_free(&v.rows);
+    catalog_filter_free(&v.flt);
 }
 
 // --------------------------------------------------
 // Detailseite
 // --------------------------------------------------
+static int color_for_priority(int priority) {
+    if (priority < 0) return 5;
+    if (priority <= 3) return 4;   // err und schlimmer
+    if (priority == 4) return 3;   // warning
+    return 5;
+}
+
+// --------------------------------------------------
+// Live-Logs (ersetzt journalctl -f | less)
+// --------------------------------------------------
+struct log_view {
+    const char *title;
+    struct journal_tail *tail;
+    struct log_ring ring;
+    int follow;                 // 1 = neueste Zeile unten, sonst pausiert
+    unsigned long top;          // erste angezeigte Zeile (seq), wenn pausiert
+    int rows;                   // Logzeilen im Fenster
+    double rate;                // Zeilen/s
+    char search[128];           // "" = keine Suche
+    struct log_matches matches;
+    unsigned long scanned;      // bis hier durchsucht
+    unsigned long match_seq;    // aktueller Treffer (n/N), NO_MATCH = keiner
+};
+
+#define NO_MATCH ULONG_MAX
+
+static const char *const priority_names[8] = {
+    "emerg", "alert", "crit", "err", "warning", "notice", "info", "debug"
+};
+
+/* Eingabezeile in der Statusleiste. Rueckgabe: Laenge, -1 Abbruch */
+static int prompt_ui(const char *label, char *buf, size_t bufsize) {
+    werase(status_win);
+    wattron(status_win, COLOR_PAIR(5));
+    mvwprintw(status_win, 0, 0, "%s", label);
+    wattroff(status_win, COLOR_PAIR(5));
+    wrefresh(status_win);
+
+    echo();
+    curs_set(1);
+    int r = wgetnstr(status_win, buf, (int)bufsize - 1);
+    noecho();
+    curs_set(0);
+
+    if (r == ERR) {
+        buf[0] = '\0';
+        return -1;
+    }
+    for (int i = (int)strlen(buf) - 1; i >= 0 && isspace((unsigned char)buf[i]); i--)
+        buf[i] = '\0';
+    return (int)strlen(buf);
+}
+
+static void log_view_clamp(struct log_view *v) {
+    unsigned long first = log_ring_first(&v->ring);
+    unsigned long last_top = v->ring.total > (unsigned long)v->rows ? v->ring.total - (unsigned long)v->rows : 0;
+    if (last_top < first) last_top = first;
+    if (v->follow || v->top > last_top) v->top = last_top;
+    if (v->top < first) v->top = first;
+}
+
+// Index des ersten Treffers mit seq >= target (count, wenn keiner)
+static size_t match_lower_bound(const struct log_matches *m, unsigned long target) {
+    size_t lo = m->start, hi = m->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (m->seq[mid] < target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Neue und verdraengte Zeilen in der Trefferliste nachziehen
+static void log_view_update_matches(struct log_view *v) {
+    log_matches_trim(&v->matches, log_ring_first(&v->ring));
+    if (v->search[0] && v->scanned < v->ring.total) {
+        log_ring_search(&v->ring, v->search, v->scanned, &v->matches);
+    }
+    v->scanned = v->ring.total;
+    if (v->match_seq != NO_MATCH && v->match_seq < log_ring_first(&v->ring)) v->match_seq = NO_MATCH;
+}
+
+// Treffer in die Mitte holen; dir > 0: naechster, < 0: vorheriger
+static int log_view_jump(struct log_view *v, int dir) {
+    const struct log_matches *m = &v->matches;
+    if (m->start >= m->count) return -1;
+
+    unsigned long from = v->match_seq != NO_MATCH ? v->match_seq
+                       : v->top + (dir > 0 ? 0 : (unsigned long)v->rows);
+    size_t idx = match_lower_bound(m, from);
+    if (dir > 0) {
+        if (idx < m->count && m->seq[idx] == from && v->match_seq != NO_MATCH) idx++;
+        if (idx >= m->count) return -1;
+    } else {
+        if (idx == m->start) return -1;
+        idx--;
+    }
+
+    v->match_seq = m->seq[idx];
+    v->follow = 0;
+    unsigned long third = (unsigned long)v->rows / 3;
+    v->top = v->match_seq > third ? v->match_seq - third : 0;
+    log_view_clamp(v);
+    return 0;
+}
+
+static void log_view_set_search(struct log_view *v, const char *pattern) {
+    snprintf(v->search, sizeof(v->search), "%s", pattern);
+    v->matches.start = v->matches.count = 0;
+    v->scanned = log_ring_first(&v->ring);
+    v->match_seq = NO_MATCH;
+    log_view_update_matches(v);
+    if (v->search[0] && log_view_jump(v, 1) != 0) log_view_jump(v, -1);
+}
+
+// Filter geaendert: Journal von vorn, Ring und Treffer leeren
+static void log_view_refilter(struct log_view *v, int max_priority, uint64_t since_usec) {
+    journal_tail_set_filter(v->tail, max_priority, since_usec);
+    log_ring_clear(&v->ring);
+    v->matches.start = v->matches.count = 0;
+    v->scanned = v->ring.total;
+    v->match_seq = NO_MATCH;
+    v->follow = 1;
+}
+
+// "3", "err", "warning" ... -> 0..7, leer -> -1 (alle), -2 ungueltig
+static int parse_priority(const char *s) {
+    if (!s[0]) return -1;
+    if (s[0] >= '0' && s[0] <= '7' && s[1] == '\0') return s[0] - '0';
+    for (int p = 0; p < 8; p++) {
+        if (strcasecmp(s, priority_names[p]) == 0) return p;
+    }
+    return -2;
+}
+
+// "30" (Minuten), "90s", "2h", "1d" -> Sekunden, leer -> 0, ungueltig -> -1
+static long parse_duration(const char *s) {
+    if (!s[0]) return 0;
+    char *end;
+    long n = strtol(s, &end, 10);
+    if (n <= 0 || end == s) return -1;
+    switch (*end) {
+    case '\0': case 'm': return n * 60;
+    case 's': return n;
+    case 'h': return n * 3600;
+    case 'd': return n * 86400;
+    default:  return -1;
+    }
+}
+
+static void draw_log_view(struct log_view *v) {
+    werase(main_win);
+    int maxy, maxx;
+    getmaxyx(main_win, maxy, maxx);
+    v->rows = maxy - 3 > 1 ? maxy - 3 : 1;
+    log_view_clamp(v);
+
+    char state[160];
+    int len;
+    if (v->follow) {
+        len = snprintf(state, sizeof(state), "FOLGEN  %.0f Zeilen/s", v->rate);
+    } else {
+        len = snprintf(state, sizeof(state), "PAUSE  Zeile %lu/%lu",
+                       v->top - log_ring_first(&v->ring) + 1, (unsigned long)v->ring.count);
+    }
+    if (v->tail->max_priority >= 0 && len < (int)sizeof(state)) {
+        len += snprintf(state + len, sizeof(state) - (size_t)len, "  <=%s",
+                        priority_names[v->tail->max_priority]);
+    }
+    if (v->tail->since_usec && len < (int)sizeof(state)) {
+        time_t since = (time_t)(v->tail->since_usec / 1000000);
+        struct tm tm;
+        char ts[16] = "";
+        if (localtime_r(&since, &tm)) strftime(ts, sizeof(ts), "%H:%M", &tm);
+        len += snprintf(state + len, sizeof(state) - (size_t)len, "  seit %s", ts);
+    }
+    if (v->search[0] && len < (int)sizeof(state)) {
+        const struct log_matches *m = &v->matches;
+        size_t n = m->count - m->start;
+        if (v->match_seq != NO_MATCH) {
+            size_t pos = match_lower_bound(m, v->match_seq) - m->start + 1;
+            snprintf(state + len, sizeof(state) - (size_t)len, "  /%s %zu/%zu", v->search, pos, n);
+        } else {
+            snprintf(state + len, sizeof(state) - (size_t)len, "  /%s %zu Treffer", v->search, n);
+        }
+    }
+
+    wattron(main_win, COLOR_PAIR(1) | A_BOLD);
+    mvwprintw(main_win, 1, 1, "Live-Logs: %s", v->title);
+    wattroff(main_win, COLOR_PAIR(1) | A_BOLD);
+    int sx = maxx - 2 - (int)strlen(state);
+    wattron(main_win, COLOR_PAIR(v->follow ? 2 : 3) | A_BOLD);
+    mvwprintw(main_win, 1, sx > 1 ? sx : 1, "%.*s", maxx > 2 ? maxx - 2 : 0, state);
+    wattroff(main_win, COLOR_PAIR(v->follow ? 2 : 3) | A_BOLD);
+
+    // Mehrere Units: farbige Markierung vor jeder Zeile
+    int tag_width = 0;
+    if (v->tail->nunits > 1) {
+        for (int u = 0; u < v->tail->nunits; u++) {
+            int ulen = (int)strlen(v->tail->units[u].name);
+            if (ulen > tag_width) tag_width = ulen;
+        }
+        if (tag_width > UNIT_TAG_WIDTH) tag_width = UNIT_TAG_WIDTH;
+    }
+
+    int width = maxx > 2 ? maxx - 2 : 0;
+    size_t plen = strlen(v->search);
+    for (int i = 0; i < v->rows; i++) {
+        unsigned long seq = v->top + (unsigned long)i;
+        const struct log_entry *e = log_ring_at(&v->ring, seq);
+        if (!e) break;
+        int x = 1;
+        if (tag_width > 0) {
+            const char *name = e->unit >= 0 ? v->tail->units[e->unit].name : "?";
+            int tag = COLOR_PAIR(UNIT_TAG_PAIR + (e->unit >= 0 ? e->unit % UNIT_TAG_COLORS : 0));
+            wattron(main_win, tag | A_BOLD);
+            mvwprintw(main_win, 2 + i, x, "%-*.*s", tag_width, tag_width, name);
+            wattroff(main_win, tag | A_BOLD);
+            x += tag_width + 1;
+        }
+        int avail = width - (x - 1) > 0 ? width - (x - 1) : 0;
+        const char *text = log_ring_text(&v->ring, e);
+        int color = color_for_priority(e->priority);
+        int attr = e->priority >= 0 && e->priority <= 3 ? A_BOLD : 0;
+        wattron(main_win, COLOR_PAIR(color) | attr);
+        mvwprintw(main_win, 2 + i, x, "%.*s", avail, text);
+        wattroff(main_win, COLOR_PAIR(color) | attr);
+
+        // Treffer hervorheben (nur sichtbarer Teil)
+        if (plen > 0) {
+            attr_t hl = A_REVERSE | (seq == v->match_seq ? A_BOLD : 0);
+            size_t shown = e->len < (uint32_t)avail ? e->len : (size_t)avail;
+            for (const char *p = memmem(text, shown, v->search, plen); p;
+                 p = memmem(p + plen, shown - (size_t)(p + plen - text), v->search, plen)) {
+                int col = (int)(p - text);
+                int n = (int)plen;
+                if (col + n > avail) n = avail - col;
+                mvwchgat(main_win, 2 + i, x + col, n, hl, 3, NULL);
+                if ((size_t)(p + plen - text) >= shown) break;
+            }
+        }
+    }
+    if (v->ring.count == 0) {
+        mvwprintw(main_win, 2, 1, "(Noch keine Logs)");
+    }
+
+    box(main_win, 0, 0);
+    wnoutrefresh(main_win);
+
+    werase(status_win);
+    wattron(status_win, COLOR_PAIR(1));
+    mvwprintw(status_win, 0, 0, " Leertaste=Pause/Weiter | Pfeile/PgUp/PgDn=Zurueckblaettern | Home/End | /=Suche n/N | p=Prioritaet | t=Zeitraum | q=Zurueck");
+    wattroff(status_win, COLOR_PAIR(1));
+    wnoutrefresh(status_win);
+    doupdate();
+}
+
+/* Folgt dem Journal im Dashboard. Pausiert wird nicht mehr gelesen: der
+   Ring bleibt stehen, das Journal haelt die Position ueber den Cursor. */
+static void run_log_viewer(const char *title, struct journal_tail *tail) {
+    struct log_view v;
+    memset(&v, 0, sizeof(v));
+    v.title = title;
+    v.tail = tail;
+    v.follow = 1;
+    v.rows = 1;
+    v.match_seq = NO_MATCH;
+    if (log_ring_init(&v.ring, LOGVIEW_LINES, LOGVIEW_TEXT_BYTES) != 0) {
+        show_message_ui("Kein Speicher fuer den Log-Puffer.");
+        return;
+    }
+
+    // Der Rueckblick beim Oeffnen zaehlt nicht zur Rate
+    journal_tail_read(tail, &v.ring);
+    long long last_draw = 0;
+    long long rate_ms = ui_now_ms();
+    unsigned long rate_total = v.ring.total;
+    int dirty = 1;
+
+    while (1) {
+        if (v.follow && journal_tail_read(tail, &v.ring) > 0) {
+            log_view_update_matches(&v);
+            dirty = 1;
+        }
+
+        long long now = ui_now_ms();
+        if (now - rate_ms >= 1000) {
+            v.rate = v.follow ? (double)(v.ring.total - rate_total) * 1000.0 / (double)(now - rate_ms) : 0;
+            rate_total = v.ring.total;
+            rate_ms = now;
+            dirty = 1;
+        }
+        if (dirty && now - last_draw >= LOGVIEW_FRAME_MS) {
+            draw_log_view(&v);
+            last_draw = now;
+            dirty = 0;
+        }
+
+        int wait_ms = DETAIL_WAIT_MS;
+        if (v.follow && tail->pending) wait_ms = 0;
+        else if (dirty) wait_ms = (int)(LOGVIEW_FRAME_MS - (now - last_draw));
+        // Pausiert bleibt der Journal-fd lesbar -> nicht mit pollen
+        int ev = wait_events_ui(v.follow ? journal_tail_fd(tail) : -1, wait_ms);
+        if (ev_quit_requested()) break;
+        if (ev & EV_RESIZE) dirty = 1;
+        if (!(ev & EV_KEY)) continue;
+
+        int ch = wgetch(status_win);
+        if (ch == ERR) continue;
+        dirty = 1;
+
+        if (ch == 'q' || ch == 'Q' || ch == 27) {
+            break;
+        } else if (ch == ' ') {
+            v.follow = !v.follow;
+        } else if (ch == KEY_UP || ch == 'k') {
+            v.follow = 0;
+            if (v.top > 0) v.top--;
+        } else if (ch == KEY_DOWN || ch == 'j') {
+            v.follow = 0;
+            v.top++;
+        } else if (ch == KEY_PPAGE) {
+            v.follow = 0;
+            v.top = v.top > (unsigned long)v.rows ? v.top - (unsigned long)v.rows : 0;
+        } else if (ch == KEY_NPAGE) {
+            v.follow = 0;
+            v.top += (unsigned long)v.rows;
+        } else if (ch == KEY_HOME || ch == 'g') {
+            v.follow = 0;
+            v.top = 0;
+        } else if (ch == KEY_END || ch == 'G' || ch == 'F') {
+            v.follow = 1;
+            v.match_seq = NO_MATCH;
+        } else if (ch == '/') {
+            char pattern[sizeof(v.search)];
+            if (prompt_ui("Suche (leer = aus): ", pattern, sizeof(pattern)) >= 0) {
+                log_view_set_search(&v, pattern);
+            }
+        } else if (ch == 'n' || ch == 'N') {
+            if (!v.search[0]) continue;
+            if (log_view_jump(&v, ch == 'n' ? 1 : -1) != 0) beep();
+        } else if (ch == 'p') {
+            char buf[16];
+            if (prompt_ui("Hoechstens Prioritaet 0-7 / err / warning ... (leer = alle): ",
+                          buf, sizeof(buf)) < 0) continue;
+            int prio = parse_priority(buf);
+            if (prio == -2) {
+                show_message_ui("Unbekannte Prioritaet.");
+                continue;
+            }
+            log_view_refilter(&v, prio, v.tail->since_usec);
+        } else if (ch == 't') {
+            char buf[16];
+            if (prompt_ui("Zeitraum: letzte N Minuten bzw. 90s / 2h / 1d (leer = Rueckblick): ",
+                          buf, sizeof(buf)) < 0) continue;
+            long sec = parse_duration(buf);
+            if (sec < 0) {
+                show_message_ui("Ungueltiger Zeitraum.");
+                continue;
+            }
+            uint64_t since = sec ? ((uint64_t)time(NULL) - (uint64_t)sec) * 1000000ULL : 0;
+            log_view_refilter(&v, v.tail->max_priority, since);
+        }
+        log_view_clamp(&v);
+    }
+    log_matches_free(&v.matches);
+    log_ring_free(&v.ring);
+}
+
+// Fuer die gemischten Logs markierte Favoriten (nach Name)
+static char **log_marks = NULL;
+static int num_log_marks = 0;
+
+static int find_log_mark(const char *svc) {
+    for (int i = 0; i < num_log_marks; i++) {
+        if (strcmp(log_marks[i], svc) == 0) return i;
+    }
+    return -1;
+}
+
+int is_log_marked(const char *svc) {
+    return find_log_mark(svc) >= 0;
+}
+
+void toggle_log_mark_ui(const char *svc) {
+    int idx = find_log_mark(svc);
+    if (idx >= 0) {
+        free(log_marks[idx]);
+        log_marks[idx] = log_marks[--num_log_marks];
+        return;
+    }
+    char **marks = realloc(log_marks, (size_t)(num_log_marks + 1) * sizeof(*marks));
+    if (!marks) return;
+    log_marks = marks;
+    log_marks[num_log_marks] = strdup(svc);
+    if (log_marks[num_log_marks]) num_log_marks++;
+}
+
+/* Ein Journal fuer alle markierten Favoriten (ohne Markierung: alle),
+   zeitlich gemischt. */
+void merged_logs_ui(void) {
+    if (num_my_services <= 0) {
+        show_message_ui("Keine Services konfiguriert.");
+        return;
+    }
+
+    const char **units  = malloc((size_t)num_my_services * sizeof(*units));
+    const char **scopes = malloc((size_t)num_my_services * sizeof(*scopes));
+    int n = 0, marked = 0;
+    if (units && scopes) {
+        for (int i = 0; i < num_my_services; i++) {
+            const char *svc = my_services[i];
+            if (num_log_marks > 0 && !is_log_marked(svc)) continue;
+            marked++;
+            const char *scope = detect_scope(svc);
+            if (strcmp(scope, "none") == 0) continue;
+            units[n]  = svc;
+            scopes[n] = strcmp(scope, "user") == 0 ? "user" : "system";
+            n++;
+        }
+    }
+
+    struct journal_tail tail;
+    if (n > 0 && journal_tail_open_units(&tail, units, scopes, n, LOGVIEW_BACKLOG) == 0) {
+        char title[96];
+        snprintf(title, sizeof(title), "%d von %d %s", n, marked,
+                 num_log_marks > 0 ? "markierten Services" : "Favoriten");
+        run_log_viewer(title, &tail);
+        journal_tail_close(&tail);
+    } else {
+        show_message_ui("Keine Logs: kein (markierter) Service gefunden.");
+    }
+    free(units);
+    free(scopes);
+}
+
+static void log_viewer_ui(const char *svc, const char *scope) {
+    struct journal_tail tail;
+    if (journal_tail_open(&tail, svc, scope, LOGVIEW_BACKLOG) != 0) {
+        show_message_ui("Journal nicht lesbar.");
+        return;
+    }
+    run_log_viewer(svc, &tail);
+    journal_tail_close(&tail);
+}
+
 void service_detail_page_ui(const char *svc) {
     if (!main_win || !status_win) return;
 
+    int chart_series = HIST_CPU;
+
+    // Logs: Journal ab Cursor verfolgen statt journalctl pro Bild
+    struct journal_tail tail;
+    struct log_ring logs;
+    int tail_open = 0;
+    if (log_ring_init(&logs, DETAIL_LOG_LINES, DETAIL_LOG_LINES * LOG_MSG_LEN) != 0) return;
+
+    /* Eine Abfrage (GetAll bzw. ein systemctl show) alle DETAIL_PROPS_MS bzw.
+       nach einer Aktion; die Socket-Liste kommt aus deren Cgroup/MainPID */
+    struct unit_info props;
+    memset(&props, 0, sizeof(props));
+    long long props_ms = -1;
+    struct listen_sock socks[DETAIL_MAX_SOCKETS];
+    int n_socks = 0;
+
     while (1) {
         werase(main_win);
         int maxy, maxx;
@@ -450,32 +1339,46 @@ void service_detail_page_ui(const char *svc) {
         wattroff(main_win, COLOR_PAIR(1) | A_BOLD);
         y++;
 
-        char summary[MAX_LINE];
-        char parts[5][MAX_DESC];
-        get_service_summary(svc, summary, sizeof(summary));
-        parse_summary(summary, parts);
+        struct unit_state st;
+        get_unit_state(svc, &st);
 
-        // Invalidate cache so detail page shows fresh state
-        const char *scope_str = parts[0];
-        const char *active    = parts[1];
-        const char *enabled   = parts[2];
-        const char *desc      = parts[3];
-        const char *port      = parts[4];
+        const char *scope_str = unit_scope_name(st.scope);
+        const char *active    = unit_active_name(st.active);
+        const char *enabled   = unit_enabled_name(st.enabled);
+        const char *desc      = st.desc;
+        int active_state      = st.active;
+        int enabled_state     = st.enabled;
+        char port[16];
+        port_format_compact(&st.ports, port, sizeof(port));
 
         // Re-query fresh state for detail page (cache has 5s TTL)
-        char fresh_active[32] = {0}, fresh_enabled[32] = {0};
-        const char *user_flag = (strcmp(scope_str, "system") == 0 ? "" : "--user");
-        char cmd[MAX_LINE];
+        const char *user_flag = (strcmp(scope_str, "system") == 0 ? NULL : "--user");
+
+        long long now = ui_now_ms();
+        if (props_ms < 0 || now - props_ms >= DETAIL_PROPS_MS) {
+            props_ms = now;
+            memset(&props, 0, sizeof(props));
+            n_socks = 0;
+            if (strcmp(scope_str, "none") != 0 && query_unit_info(svc, &props) != 0) {
+                memset(&props, 0, sizeof(props));
+            } else if (strcmp(scope_str, "none") != 0) {
+                n_socks = get_unit_sockets(props.cgroup, props.main_pid, socks, DETAIL_MAX_SOCKETS);
+            }
+        }
 
-        if (strcmp(scope_str, "none") != 0) {
-            snprintf(cmd, sizeof(cmd), "systemctl %s is-active \"%s\" 2>/dev/null", user_flag, svc);
-            execute_cmd(cmd, fresh_active, sizeof(fresh_active));
-            snprintf(cmd, sizeof(cmd), "systemctl %s is-enabled \"%s\" 2>/dev/null", user_flag, svc);
-            execute_cmd(cmd, fresh_enabled, sizeof(fresh_enabled));
+        if (!tail_open && strcmp(scope_str, "none") != 0) {
+            tail_open = journal_tail_open(&tail, svc, scope_str, DETAIL_LOG_LINES) == 0;
         }
+        if (tail_open) journal_tail_read(&tail, &logs);
 
-        if (strlen(fresh_active) > 0) active = fresh_active;
-        if (strlen(fresh_enabled) > 0) enabled = fresh_enabled;
+        if (strlen(props.active) > 0) {
+            active = props.active;
+            active_state = unit_active_parse(props.active);
+        }
+        if (strlen(props.enabled) > 0) {
+            enabled = props.enabled;
+            enabled_state = unit_enabled_parse(props.enabled);
+        }
 
         const char *scope_label;
         if (strcmp(scope_str, "system") == 0)
@@ -499,139 +1402,138 @@ void service_detail_page_ui(const char *svc) {
         mvwprintw(main_win, y++, 0, "  Name:        %s", svc);
         mvwprintw(main_win, y++, 0, "  Scope:       %s", scope_label);
 
-        wattron(main_win, COLOR_PAIR(color_for_active(active)));
+        wattron(main_win, COLOR_PAIR(color_for_active(active_state)));
         mvwprintw(main_win, y++, 0, "  Active:      %s", active);
-        wattroff(main_win, COLOR_PAIR(color_for_active(active)));
+        wattroff(main_win, COLOR_PAIR(color_for_active(active_state)));
 
-        wattron(main_win, COLOR_PAIR(color_for_enabled(enabled)));
+        wattron(main_win, COLOR_PAIR(color_for_enabled(enabled_state)));
         mvwprintw(main_win, y++, 0, "  Enabled:     %s", enabled);
-        wattroff(main_win, COLOR_PAIR(color_for_enabled(enabled)));
+        wattroff(main_win, COLOR_PAIR(color_for_enabled(enabled_state)));
 
-        wattron(main_win, COLOR_PAIR(color_for_port(port)));
+        wattron(main_win, COLOR_PAIR(color_for_ports(&st.ports)));
         mvwprintw(main_win, y++, 0, "  Port:        %s", port);
-        wattroff(main_win, COLOR_PAIR(color_for_port(port)));
+        wattroff(main_win, COLOR_PAIR(color_for_ports(&st.ports)));
+
+        // Alle Sockets der Unit (jeder Prozess der Cgroup)
+        for (int i = 0; i < n_socks && i < DETAIL_SHOW_SOCKETS; i++) {
+            const struct listen_sock *sk = &socks[i];
+            if (sk->proto == PROTO_UNIX) {
+                mvwprintw(main_win, y++, 0, "               unix  %s", sk->addr);
+            } else {
+                const char *proto = sk->proto == PROTO_TCP ? "tcp" : "udp";
+                mvwprintw(main_win, y++, 0, sk->ipv6 ? "               %s6  [%s]:%u"
+                                                     : "               %-5s %s:%u",
+                          proto, sk->addr, sk->port);
+            }
+        }
+        if (n_socks > DETAIL_SHOW_SOCKETS) {
+            mvwprintw(main_win, y++, 0, "               ... %d weitere%s", n_socks - DETAIL_SHOW_SOCKETS,
+                      n_socks == DETAIL_MAX_SOCKETS ? " (gekuerzt)" : "");
+        }
 
         mvwprintw(main_win, y++, 0, "  Description: %s", desc);
 
         // Zusätzliche Infos
-        char act_ts[MAX_LINE] = {0};
-        char fragment_path[MAX_LINE] = {0};
-        char unit_state[32] = {0};
-        char substate[32] = {0};
-
-        if (strcmp(scope_str, "none") != 0) {
-            snprintf(cmd, sizeof(cmd),
-                     "systemctl %s show -p ActiveEnterTimestamp --value \"%s\" 2>/dev/null",
-                     user_flag, svc);
-            execute_cmd(cmd, act_ts, sizeof(act_ts));
-
-            snprintf(cmd, sizeof(cmd),
-                     "systemctl %s show -p FragmentPath --value \"%s\" 2>/dev/null",
-                     user_flag, svc);
-            execute_cmd(cmd, fragment_path, sizeof(fragment_path));
-
-            snprintf(cmd, sizeof(cmd),
-                     "systemctl %s show -p LoadState --value \"%s\" 2>/dev/null",
-                     user_flag, svc);
-            execute_cmd(cmd, unit_state, sizeof(unit_state));
-
-            snprintf(cmd, sizeof(cmd),
-                     "systemctl %s show -p SubState --value \"%s\" 2>/dev/null",
-                     user_flag, svc);
-            execute_cmd(cmd, substate, sizeof(substate));
-        }
-
         wattron(main_win, COLOR_PAIR(1));
         mvwprintw(main_win, y++, 0, "Zusaetzliche Infos");
         wattroff(main_win, COLOR_PAIR(1));
 
-        mvwprintw(main_win, y++, 0, "  LoadState:     %s", strlen(unit_state) ? unit_state : "unknown");
-        mvwprintw(main_win, y++, 0, "  SubState:      %s", strlen(substate) ? substate : "unknown");
-        mvwprintw(main_win, y++, 0, "  Fragment:      %s", strlen(fragment_path) ? fragment_path : "unknown");
-        mvwprintw(main_win, y++, 0, "  Active seit:   %s", strlen(act_ts) ? act_ts : "n/a");
+        mvwprintw(main_win, y++, 0, "  LoadState:     %s", strlen(props.load_state) ? props.load_state : "unknown");
+        mvwprintw(main_win, y++, 0, "  SubState:      %s", strlen(props.sub_state) ? props.sub_state : "unknown");
+        mvwprintw(main_win, y++, 0, "  Fragment:      %s", strlen(props.fragment) ? props.fragment : "unknown");
+        mvwprintw(main_win, y++, 0, "  Active seit:   %s", strlen(props.active_since) ? props.active_since : "n/a");
+
+        // Verlauf (Ringpuffer aus dem Poller-Snapshot)
+        char interval_label[32];
+        snprintf(interval_label, sizeof(interval_label), "%ds", history_interval_ms() / 1000);
+        wattron(main_win, COLOR_PAIR(1));
+        mvwprintw(main_win, y++, 0, "Verlauf %s (je %s, h = Reihe wechseln)",
+                  series_names[chart_series], interval_label);
+        wattroff(main_win, COLOR_PAIR(1));
+        draw_history_chart(&y, snapshot_history(poller_snapshot(), -1, svc), chart_series, maxx);
 
-        // Logs
+        // Logs (neueste unten; was nicht passt, faellt oben weg)
         wattron(main_win, COLOR_PAIR(1));
-        mvwprintw(main_win, y++, 0, "Letzte Logs (journalctl -u %s -n %d)", svc, DETAIL_LOG_LINES);
+        mvwprintw(main_win, y++, 0, "Letzte Logs (%s, max. %d)", svc, DETAIL_LOG_LINES);
         wattroff(main_win, COLOR_PAIR(1));
         y++;
 
-        char log_cmd[MAX_LINE];
-        snprintf(log_cmd, sizeof(log_cmd),
-                 "journalctl %s -u \"%s\" -n %d --no-pager 2>/dev/null",
-                 user_flag, svc, DETAIL_LOG_LINES);
-
-        FILE *log_fp = popen(log_cmd, "r");
-        if (log_fp) {
-            char log_line[MAX_LINE];
-            while (fgets(log_line, sizeof(log_line), log_fp) && y < maxy - 2) {
-                log_line[strcspn(log_line, "\n")] = '\0';
-                wattron(main_win, COLOR_PAIR(5) | A_DIM);
-                mvwprintw(main_win, y++, 0, "%s", log_line);
-                wattroff(main_win, COLOR_PAIR(5) | A_DIM);
+        if (logs.count > 0) {
+            int room = maxy - 2 - y;
+            unsigned long first = log_ring_first(&logs);
+            if (logs.count > room) first = logs.total - (unsigned long)(room > 0 ? room : 0);
+            for (unsigned long seq = first; seq < logs.total; seq++) {
+                const struct log_entry *e = log_ring_at(&logs, seq);
+                int color = color_for_priority(e->priority);
+                int attr = color == 5 ? A_DIM : A_BOLD;
+                wattron(main_win, COLOR_PAIR(color) | attr);
+                mvwprintw(main_win, y++, 0, "%.*s", maxx > 2 ? maxx - 2 : 0, log_ring_text(&logs, e));
+                wattroff(main_win, COLOR_PAIR(color) | attr);
             }
-            pclose(log_fp);
         } else {
             mvwprintw(main_win, y++, 0, "(Keine Logs verfuegbar)");
         }
 
         box(main_win, 0, 0);
-        wrefresh(main_win);
+        wnoutrefresh(main_win);
 
         werase(status_win);
         wattron(status_win, COLOR_PAIR(1));
-        mvwprintw(status_win, 0, 0, " s=Start | t=Stop | r=Restart | e=Enable | d=Disable | S=Status | L=Live-Logs | o=Browser | c=CPU/RAM | D=Deps | V=Edit Unit | q=Zurueck");
+        mvwprintw(status_win, 0, 0, " s=Start | t=Stop | r=Restart | e=Enable | d=Disable | S=Status | L=Live-Logs | o=Browser | c=CPU/RAM | h=Verlauf | D=Deps | V=Edit Unit | q=Zurueck");
         wattroff(status_win, COLOR_PAIR(1));
-        wrefresh(status_win);
-
-        int ch = wgetch(status_win);
+        wnoutrefresh(status_win);
+        doupdate();
+
+        int ch = ERR;
+        int wait_ms = tail_open && tail.pending ? 0 : DETAIL_WAIT_MS;
+        int ev = wait_events_ui(tail_open ? journal_tail_fd(&tail) : -1, wait_ms);
+        if (ev_quit_requested()) break;
+        if (ev & EV_KEY) ch = wgetch(status_win);
+        if (ch == ERR) continue;
+        // Nur nach Aktionen frisch abfragen, nicht nach jeder Taste
+        if (ch > 0 && ch < 256 && strchr("stTrReEdSV", ch)) props_ms = -1;
 
         if (ch == 'q' || ch == 'Q' || ch == 27) {
             break;
+        } else if (ch == 'h') {
+            chart_series = (chart_series + 1) % HIST_NSERIES;
         } else if (ch == 's') {
-            snprintf(cmd, sizeof(cmd), "%ssystemctl %s start \"%s\"", sudo_flag, user_flag, svc);
-            int ret = system(cmd);
-            if (WIFEXITED(ret) && WEXITSTATUS(ret) == 0)
+            if (systemctl_action(scope_str, "start", svc) == 0)
                 show_message_ui("Gestartet.");
             else
                 show_message_ui("Start fehlgeschlagen. Siehe Logs.");
         } else if (ch == 't' || ch == 'T') {
-            snprintf(cmd, sizeof(cmd), "%ssystemctl %s stop \"%s\"", sudo_flag, user_flag, svc);
-            int ret = system(cmd);
-            if (WIFEXITED(ret) && WEXITSTATUS(ret) == 0)
+            if (systemctl_action(scope_str, "stop", svc) == 0)
                 show_message_ui("Gestoppt.");
             else
                 show_message_ui("Stop fehlgeschlagen.");
         } else if (ch == 'r' || ch == 'R') {
-            snprintf(cmd, sizeof(cmd), "%ssystemctl %s restart \"%s\"", sudo_flag, user_flag, svc);
-            int ret = system(cmd);
-            if (WIFEXITED(ret) && WEXITSTATUS(ret) == 0)
+            if (systemctl_action(scope_str, "restart", svc) == 0)
                 show_message_ui("Neugestartet.");
             else
                 show_message_ui("Restart fehlgeschlagen.");
         } else if (ch == 'e' || ch == 'E') {
-            snprintf(cmd, sizeof(cmd), "%ssystemctl %s enable \"%s\"", sudo_flag, user_flag, svc);
-            system(cmd);
+            systemctl_action(scope_str, "enable", svc);
             invalidate_cache(); // Cache invalidieren nach enable
         } else if (ch == 'd') {
-            snprintf(cmd, sizeof(cmd), "%ssystemctl %s disable \"%s\"", sudo_flag, user_flag, svc);
-            system(cmd);
+            systemctl_action(scope_str, "disable", svc);
             invalidate_cache();
         } else if (ch == 'S') {
+            // systemctl startet selbst einen Pager
+            const char *argv[] = { "systemctl", user_flag ? user_flag : "--system",
+                                   "status", "--", svc, NULL };
             def_prog_mode();
             endwin();
-            snprintf(cmd, sizeof(cmd), "systemctl %s status \"%s\" | less", user_flag, svc);
-            system(cmd);
+            spawn_cmd(argv, SPAWN_INTERACTIVE, 0, NULL, NULL);
             reset_prog_mode();
             refresh();
             invalidate_cache();
         } else if (ch == 'L') {
-            def_prog_mode();
-            endwin();
-            snprintf(cmd, sizeof(cmd), "journalctl %s -u \"%s\" -f | less", user_flag, svc);
-            system(cmd);
-            reset_prog_mode();
-            refresh();
+            if (strcmp(scope_str, "none") == 0) {
+                show_message_ui("Service nicht gefunden -- keine Logs.");
+            } else {
+                log_viewer_ui(svc, scope_str);
+            }
         } else if (ch == 'o' || ch == 'O') {
             if (strcmp(port, "-") != 0 && strlen(port) > 0) {
                 open_in_browser_ui(port);
@@ -639,24 +1541,19 @@ void service_detail_page_ui(const char *svc) {
                 show_message_ui("Kein Port erkannt.");
             }
         } else if (ch == 'c' || ch == 'C') {
-            char pid_str[32] = {0};
-            snprintf(cmd, sizeof(cmd),
-                     "systemctl %s show -p MainPID --value \"%s\" 2>/dev/null",
-                     user_flag, svc);
-            execute_cmd(cmd, pid_str, sizeof(pid_str));
-            long pid = atol(pid_str);
-            if (pid <= 0) {
-                show_message_ui("PID nicht verfuegbar.");
+            struct unit_usage u;
+            if (strcmp(scope_str, "none") != 0 && get_resource_usage(svc, &u) == 0) {
+                char msg[256];
+                int len = snprintf(msg, sizeof(msg), "CPU: %.1f%%  RAM: %ld KB  Tasks: %ld",
+                                   u.cpu_pct < 0 ? 0.0 : u.cpu_pct, u.rss_kb, u.tasks);
+                if (u.io_kbps >= 0 && len < (int)sizeof(msg))
+                    len += snprintf(msg + len, sizeof(msg) - (size_t)len, "  IO: %.0f KB/s", u.io_kbps);
+                if (u.psi_cpu >= 0 && len < (int)sizeof(msg))
+                    snprintf(msg + len, sizeof(msg) - (size_t)len, "  PSI cpu/mem/io: %.1f/%.1f/%.1f%%",
+                             u.psi_cpu, u.psi_memory, u.psi_io);
+                show_message_ui(msg);
             } else {
-                float cpu = 0.0f;
-                long rss  = 0;
-                if (get_resource_usage(pid, &cpu, &rss) == 0) {
-                    char msg[128];
-                    snprintf(msg, sizeof(msg), "RAM: %ld KB  (PID: %ld)", rss, pid);
-                    show_message_ui(msg);
-                } else {
-                    show_message_ui("Ressourcen nicht ermittelbar.");
-                }
+                show_message_ui("Ressourcen nicht ermittelbar (Service laeuft nicht?).");
             }
         } else if (ch == 'D') {
             show_dependencies_ui(svc, scope_str);
@@ -669,6 +1566,8 @@ void service_detail_page_ui(const char *svc) {
             }
         }
     }
+    if (tail_open) journal_tail_close(&tail);
+    log_ring_free(&logs);
     invalidate_cache(); // Nach Detailseite: Cache invalidieren
 }
 
@@ -726,14 +1625,13 @@ void add_service_ui(const char *home) {
         }
     }
 
-    if (num_my_services >= MAX_SERVICES) {
-        show_message_ui("Maximale Anzahl Services erreicht.");
+    data_lock();
+    int r = add_my_service(svc);
+    data_unlock();
+    if (r < 0) {
+        show_message_ui("Kein Speicher mehr fuer weitere Services.");
         return;
     }
-
-    strncpy(my_services[num_my_services], svc, MAX_LINE - 1);
-    my_services[num_my_services][MAX_LINE - 1] = '\0';
-    num_my_services++;
     save_services(home);
     invalidate_cache();
 
@@ -789,16 +1687,13 @@ void remove_service_ui(const char *home) {
     }
 
     idx--;
-    char removed[MAX_LINE];
-    strncpy(removed, my_services[idx], sizeof(removed) - 1);
-    removed[sizeof(removed) - 1] = '\0';
+    const char *removed = my_services[idx];   // String-Pool, bleibt gueltig
 
-    invalidate_service_cache(my_services[idx]);
+    invalidate_service_cache(removed);
 
-    for (int i = idx; i < num_my_services - 1; i++) {
-        memmove(my_services[i], my_services[i + 1], MAX_LINE);
-    }
-    num_my_services--;
+    data_lock();
+    remove_my_service(idx);
+    data_unlock();
     save_services(home);
 
     char msg[MAX_LINE];
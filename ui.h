@@ -4,13 +4,27 @@
 void init_ui(void);
 void end_ui(void);
 void show_message_ui(const char *msg);
+// Wartet in der Ereignisschleife (evloop.h), erledigt Resize; Rueckgabe EV_*-Bits
+int  wait_events_ui(int journal_fd, int timeout_ms);
+// Naechste anstehende Taste ohne zu warten, sonst ERR
+int  read_key_ui(void);
 
 void render_dashboard_ui(int selected_idx, int focus_on_list);
+// Naechstes render_dashboard_ui() zeichnet alles neu (andere Ansicht war sichtbar)
+void invalidate_dashboard_ui(void);
+// Sichtbare Favoriten-Zeilen (Bild auf/ab) und die Tastenlogik dazu
+int  dashboard_page_rows(void);
+int  list_page_key(int ch, int selected, int count, int page);
 void browse_all_services_ui(const char *home);
 void service_detail_page_ui(const char *svc);
 void add_service_ui(const char *home);
 void remove_service_ui(const char *home);
 
+// Gemischte Logs mehrerer Favoriten
+int  is_log_marked(const char *svc);
+void toggle_log_mark_ui(const char *svc);
+void merged_logs_ui(void);
+
 void get_input(char *buf, size_t bufsize);
 
 void edit_unit_file(const char *svc, const char *scope);
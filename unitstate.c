@@ -0,0 +1,87 @@
+#include <string.h>
+
+#include "unitstate.h"
+
+static const char *const scope_names[UNIT_SCOPE_COUNT] = {
+    [UNIT_SCOPE_UNKNOWN] = "?",
+    [UNIT_SCOPE_SYSTEM]  = "system",
+    [UNIT_SCOPE_USER]    = "user",
+    [UNIT_SCOPE_NONE]    = "none",
+};
+
+static const char *const scope_labels[UNIT_SCOPE_COUNT] = {
+    [UNIT_SCOPE_UNKNOWN] = "???",
+    [UNIT_SCOPE_SYSTEM]  = "SYS",
+    [UNIT_SCOPE_USER]    = "USR",
+    [UNIT_SCOPE_NONE]    = "???",
+};
+
+static const char *const active_names[UNIT_ACTIVE_COUNT] = {
+    [UNIT_ACTIVE_UNKNOWN]      = "?",
+    [UNIT_ACTIVE_ACTIVE]       = "active",
+    [UNIT_ACTIVE_RELOADING]    = "reloading",
+    [UNIT_ACTIVE_INACTIVE]     = "inactive",
+    [UNIT_ACTIVE_FAILED]       = "failed",
+    [UNIT_ACTIVE_ACTIVATING]   = "activating",
+    [UNIT_ACTIVE_DEACTIVATING] = "deactivating",
+    [UNIT_ACTIVE_MAINTENANCE]  = "maintenance",
+    [UNIT_ACTIVE_REFRESHING]   = "refreshing",
+    [UNIT_ACTIVE_NOT_FOUND]    = "not-found",
+};
+
+static const char *const enabled_names[UNIT_ENABLED_COUNT] = {
+    [UNIT_ENABLED_UNKNOWN]         = "?",
+    [UNIT_ENABLED_NONE]            = "-",
+    [UNIT_ENABLED_ENABLED]         = "enabled",
+    [UNIT_ENABLED_ENABLED_RUNTIME] = "enabled-runtime",
+    [UNIT_ENABLED_LINKED]          = "linked",
+    [UNIT_ENABLED_LINKED_RUNTIME]  = "linked-runtime",
+    [UNIT_ENABLED_ALIAS]           = "alias",
+    [UNIT_ENABLED_MASKED]          = "masked",
+    [UNIT_ENABLED_MASKED_RUNTIME]  = "masked-runtime",
+    [UNIT_ENABLED_STATIC]          = "static",
+    [UNIT_ENABLED_DISABLED]        = "disabled",
+    [UNIT_ENABLED_INDIRECT]        = "indirect",
+    [UNIT_ENABLED_GENERATED]       = "generated",
+    [UNIT_ENABLED_TRANSIENT]       = "transient",
+    [UNIT_ENABLED_BAD]             = "bad",
+    [UNIT_ENABLED_NOT_FOUND]       = "not-found",
+};
+
+// Erster Eintrag (UNKNOWN) ist der Platzhalter und wird nie getroffen
+static int lookup(const char *const *names, int count, const char *s) {
+    if (!s) return 0;
+    for (int i = 1; i < count; i++) {
+        if (strcmp(names[i], s) == 0) return i;
+    }
+    return 0;
+}
+
+int unit_scope_parse(const char *s) {
+    return lookup(scope_names, UNIT_SCOPE_COUNT, s);
+}
+
+int unit_active_parse(const char *s) {
+    return lookup(active_names, UNIT_ACTIVE_COUNT, s);
+}
+
+int unit_enabled_parse(const char *s) {
+    if (s && s[0] == '\0') return UNIT_ENABLED_NONE;
+    return lookup(enabled_names, UNIT_ENABLED_COUNT, s);
+}
+
+const char *unit_scope_name(int scope) {
+    return (scope >= 0 && scope < UNIT_SCOPE_COUNT) ? scope_names[scope] : "?";
+}
+
+const char *unit_scope_label(int scope) {
+    return (scope >= 0 && scope < UNIT_SCOPE_COUNT) ? scope_labels[scope] : "???";
+}
+
+const char *unit_active_name(int active) {
+    return (active >= 0 && active < UNIT_ACTIVE_COUNT) ? active_names[active] : "?";
+}
+
+const char *unit_enabled_name(int enabled) {
+    return (enabled >= 0 && enabled < UNIT_ENABLED_COUNT) ? enabled_names[enabled] : "?";
+}
@@ -0,0 +1,71 @@
+#ifndef UNITSTATE_H
+#define UNITSTATE_H
+
+#include "ports.h"
+
+// Zustaende als Enums: einmal beim Einlesen umgesetzt, beim Zeichnen nur noch Tabellen
+enum unit_scope {
+    UNIT_SCOPE_UNKNOWN = 0,         // noch nicht abgefragt
+    UNIT_SCOPE_SYSTEM,
+    UNIT_SCOPE_USER,
+    UNIT_SCOPE_NONE,                // in keinem Scope geladen
+    UNIT_SCOPE_COUNT
+};
+
+// ActiveState
+enum unit_active {
+    UNIT_ACTIVE_UNKNOWN = 0,
+    UNIT_ACTIVE_ACTIVE,
+    UNIT_ACTIVE_RELOADING,
+    UNIT_ACTIVE_INACTIVE,
+    UNIT_ACTIVE_FAILED,
+    UNIT_ACTIVE_ACTIVATING,
+    UNIT_ACTIVE_DEACTIVATING,
+    UNIT_ACTIVE_MAINTENANCE,
+    UNIT_ACTIVE_REFRESHING,
+    UNIT_ACTIVE_NOT_FOUND,          // Scope none
+    UNIT_ACTIVE_COUNT
+};
+
+// UnitFileState
+enum unit_enabled {
+    UNIT_ENABLED_UNKNOWN = 0,
+    UNIT_ENABLED_NONE,              // keine Unit-Datei ("")
+    UNIT_ENABLED_ENABLED,
+    UNIT_ENABLED_ENABLED_RUNTIME,
+    UNIT_ENABLED_LINKED,
+    UNIT_ENABLED_LINKED_RUNTIME,
+    UNIT_ENABLED_ALIAS,
+    UNIT_ENABLED_MASKED,
+    UNIT_ENABLED_MASKED_RUNTIME,
+    UNIT_ENABLED_STATIC,
+    UNIT_ENABLED_DISABLED,
+    UNIT_ENABLED_INDIRECT,
+    UNIT_ENABLED_GENERATED,
+    UNIT_ENABLED_TRANSIENT,
+    UNIT_ENABLED_BAD,
+    UNIT_ENABLED_NOT_FOUND,         // Scope none
+    UNIT_ENABLED_COUNT
+};
+
+/* Zustand einer Unit fuer Listen und Detailseite; ersetzt den frueheren
+   "scope|active|enabled|desc|port"-String. Klein genug zum Kopieren. */
+struct unit_state {
+    unsigned char scope;            // enum unit_scope
+    unsigned char active;           // enum unit_active
+    unsigned char enabled;          // enum unit_enabled
+    const char *desc;               // String-Pool, "" = keine
+    struct unit_ports ports;
+};
+
+// Texte wie von systemd; Unbekanntes -> *_UNKNOWN
+int unit_scope_parse(const char *s);
+int unit_active_parse(const char *s);
+int unit_enabled_parse(const char *s);
+
+const char *unit_scope_name(int scope);       // "system", "user", "none", "?"
+const char *unit_scope_label(int scope);      // "SYS", "USR", "???"
+const char *unit_active_name(int active);     // "?" bei UNKNOWN
+const char *unit_enabled_name(int enabled);   // "-" bei NONE, "?" bei UNKNOWN
+
+#endif
@@ -0,0 +1,200 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+
+#include "unitwatch.h"
+#include "sys_dashboard.h"
+#include "catalog.h"
+#include "unitstate.h"
+
+#define UNITWATCH_MAX_DIRS 12
+#define UNIT_DIR_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+#define CONFIG_EVENTS   (IN_CLOSE_WRITE | IN_MOVED_TO)   // Editoren schreiben oft per rename
+#define PARENT_EVENTS   (IN_CREATE | IN_MOVED_TO)
+
+struct watch_dir {
+    char path[MAX_LINE];
+    int scope;          // UNIT_SCOPE_SYSTEM / UNIT_SCOPE_USER
+    int wd;
+};
+
+static int ifd = -1;
+static struct watch_dir dirs[UNITWATCH_MAX_DIRS];
+static int num_dirs = 0;
+static int config_wd = -1;
+static int parent_wd = -1;               // wartet, bis config_path angelegt wird
+static char config_path[MAX_LINE];
+static const char *config_name = NULL;   // Dateiname innerhalb von config_path
+static char home_dir[MAX_LINE];
+
+/* Wie scope_check_unit_dirs(). /lib ist oft ein Link auf /usr/lib:
+   inotify liefert dann denselben wd, der zweite Eintrag entfaellt. */
+static void add_unit_dir(const char *path, int scope) {
+    if (num_dirs >= UNITWATCH_MAX_DIRS) return;
+    int wd = inotify_add_watch(ifd, path, UNIT_DIR_EVENTS | IN_ONLYDIR);
+    if (wd < 0) return;   // Verzeichnis fehlt: ueblich, z.B. /etc/systemd/user
+    for (int i = 0; i < num_dirs; i++) {
+        if (dirs[i].wd == wd) return;
+    }
+    snprintf(dirs[num_dirs].path, sizeof(dirs[num_dirs].path), "%s", path);
+    dirs[num_dirs].scope = scope;
+    dirs[num_dirs].wd = wd;
+    num_dirs++;
+}
+
+/* Verzeichnis statt Datei beobachten: ueberlebt Ersetzen per rename.
+   Fehlt es noch, das naechste vorhandene Elternverzeichnis beobachten und
+   es beim Anlegen eines Unterverzeichnisses erneut versuchen.
+   Rueckgabe: 1 = config_path wird (jetzt) beobachtet */
+static int watch_config_dir(void) {
+    config_wd = inotify_add_watch(ifd, config_path, CONFIG_EVENTS | IN_ONLYDIR);
+    if (config_wd >= 0) {
+        if (parent_wd >= 0) inotify_rm_watch(ifd, parent_wd);
+        parent_wd = -1;
+        return 1;
+    }
+
+    char dir[MAX_LINE];
+    snprintf(dir, sizeof(dir), "%s", config_path);
+    int wd = -1;
+    char *slash;
+    while (wd < 0 && (slash = strrchr(dir, '/')) && slash != dir) {
+        *slash = '\0';
+        wd = inotify_add_watch(ifd, dir, PARENT_EVENTS | IN_ONLYDIR);
+    }
+    if (parent_wd >= 0 && parent_wd != wd) inotify_rm_watch(ifd, parent_wd);
+    parent_wd = wd;
+    return 0;
+}
+
+int unitwatch_init(const char *home) {
+    if (ifd >= 0) return ifd;
+    ifd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (ifd < 0) return -1;
+
+    add_unit_dir("/etc/systemd/system", UNIT_SCOPE_SYSTEM);
+    add_unit_dir("/run/systemd/system", UNIT_SCOPE_SYSTEM);
+    add_unit_dir("/usr/lib/systemd/system", UNIT_SCOPE_SYSTEM);
+    add_unit_dir("/lib/systemd/system", UNIT_SCOPE_SYSTEM);
+    add_unit_dir("/etc/systemd/user", UNIT_SCOPE_USER);
+    add_unit_dir("/run/systemd/user", UNIT_SCOPE_USER);
+    add_unit_dir("/usr/lib/systemd/user", UNIT_SCOPE_USER);
+
+    char path[MAX_LINE];
+    snprintf(home_dir, sizeof(home_dir), "%s", home);
+    snprintf(path, sizeof(path), "%s/.config/systemd/user", home);
+    add_unit_dir(path, UNIT_SCOPE_USER);
+    snprintf(path, sizeof(path), "%s/.local/share/systemd/user", home);
+    add_unit_dir(path, UNIT_SCOPE_USER);
+
+    snprintf(config_path, sizeof(config_path), CONFIG_FILE, home);
+    char *slash = strrchr(config_path, '/');
+    if (slash) {
+        *slash = '\0';
+        config_name = slash + 1;
+        watch_config_dir();
+    }
+
+    if (num_dirs == 0 && config_wd < 0 && parent_wd < 0) {
+        unitwatch_close();
+        return -1;
+    }
+    return ifd;
+}
+
+int unitwatch_active(void) {
+    return ifd >= 0;
+}
+
+void unitwatch_close(void) {
+    if (ifd >= 0) close(ifd);
+    ifd = -1;
+    num_dirs = 0;
+    config_wd = -1;
+    parent_wd = -1;
+}
+
+static const struct watch_dir *find_dir(int wd) {
+    for (int i = 0; i < num_dirs; i++) {
+        if (dirs[i].wd == wd) return &dirs[i];
+    }
+    return NULL;
+}
+
+static int is_unit_file(const char *name) {
+    size_t len = strlen(name);
+    return len > 8 && strcmp(name + len - 8, ".service") == 0;
+}
+
+// Liegt noch eine Datei dieses Namens in einem anderen Verzeichnis des Scopes?
+static int file_in_scope(const char *name, int scope) {
+    char path[MAX_LINE + NAME_MAX + 2];
+    struct stat st;
+    for (int i = 0; i < num_dirs; i++) {
+        if (dirs[i].scope != scope) continue;
+        int n = snprintf(path, sizeof(path), "%s/%s", dirs[i].path, name);
+        if (n < 0 || (size_t)n >= sizeof(path)) continue;
+        if (lstat(path, &st) == 0) return 1;
+    }
+    return 0;
+}
+
+int unitwatch_process(void) {
+    if (ifd < 0) return 0;
+
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int changes = 0;
+    int favorites = 0;
+    int overflow = 0;
+    ssize_t len;
+
+    while ((len = read(ifd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + len; ) {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+            p += sizeof(*ev) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                overflow = 1;
+                continue;
+            }
+            // Favoriten-Verzeichnis geloescht: wieder auf das Anlegen warten
+            if (ev->wd == config_wd && (ev->mask & IN_IGNORED)) {
+                if (watch_config_dir()) favorites = 1;
+                continue;
+            }
+            if (ev->len == 0) continue;
+
+            if (ev->wd == parent_wd) {
+                // Schon angelegt, bevor der Watch stand: Datei gleich abgleichen
+                if ((ev->mask & IN_ISDIR) && watch_config_dir()) favorites = 1;
+                continue;
+            }
+            if (ev->wd == config_wd) {
+                if (config_name && strcmp(ev->name, config_name) == 0) favorites = 1;
+                continue;
+            }
+
+            const struct watch_dir *d = find_dir(ev->wd);
+            if (!d || !is_unit_file(ev->name)) continue;
+
+            int present = (ev->mask & (IN_CREATE | IN_MOVED_TO)) ? 1 : file_in_scope(ev->name, d->scope);
+            unit_file_changed(ev->name);
+            if (catalog_file_event(ev->name, d->scope, present)) changes |= UNITWATCH_UNITS;
+        }
+    }
+
+    // Ereignisse verloren: einmal alles neu, wie nach daemon-reload
+    if (overflow) {
+        invalidate_scope_cache_event();
+        changes |= UNITWATCH_UNITS;
+        favorites = 1;
+    }
+    if (favorites && sync_services(home_dir) > 0) changes |= UNITWATCH_FAVORITES;
+    return changes;
+}
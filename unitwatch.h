@@ -0,0 +1,20 @@
+#ifndef UNITWATCH_H
+#define UNITWATCH_H
+
+/* inotify auf die Unit-Verzeichnisse beider Scopes und auf das Verzeichnis
+   der Favoriten-Datei. Aenderungen kommen als Deltas an: neue/geloeschte
+   Unit-Dateien gehen in den Katalog (catalog_file_event) und den
+   Scope-Cache (unit_file_changed), die Favoriten-Datei wird mit
+   my_services abgeglichen (sync_services). Nur aus dem UI-Thread. */
+#define UNITWATCH_UNITS     0x1   // Katalog geaendert
+#define UNITWATCH_FAVORITES 0x2   // my_services geaendert
+
+// Vor poller_start(). Rueckgabe: fd fuer ev_add_fd() oder -1 (dann ohne inotify)
+int  unitwatch_init(const char *home);
+int  unitwatch_active(void);
+
+// Liest alle anstehenden Ereignisse, blockiert nie. Rueckgabe: UNITWATCH_*-Bits
+int  unitwatch_process(void);
+void unitwatch_close(void);
+
+#endif
@@ -2,15 +2,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
 #include <ncurses.h>
 #include <sys/stat.h>
 
 #include "sys_dashboard.h"
 #include "utils.h"
 #include "ui.h"
+#include "spawn.h"
+#include "poller.h"
+#include "stats.h"
 
 // Externe Deklarationen
-extern int execute_cmd(const char *cmd, char *output, size_t max_output);
 extern void show_message_ui(const char *msg);
 extern void invalidate_cache(void);
 extern void press_enter(void);
@@ -33,37 +36,51 @@ void open_in_browser_ui(const char *port_str) {
         return;
     }
 
-    char cmd[256];
-    snprintf(cmd, sizeof(cmd),
-             "xdg-open \"http://localhost:%s\" >/dev/null 2>&1 &",
-             port_str);
-    system(cmd);
+    // PORT-Spalte kann "8080+2" oder "unix" sein -> erster TCP-Port
+    int port = atoi(port_str);
+    if (port <= 0) {
+        show_message_ui("Kein gueltiger Port zum Oeffnen.");
+        return;
+    }
+
+    // Losgeloest: manche xdg-open-Backends warten, bis der Browser zu ist
+    char url[64];
+    snprintf(url, sizeof(url), "http://localhost:%d", port);
+    const char *argv[] = { "xdg-open", url, NULL };
+    if (spawn_detached(argv) != 0) {
+        show_message_ui("xdg-open fehlgeschlagen.");
+        return;
+    }
     show_message_ui("Browser geoeffnet: http://localhost:");
 }
 
 // --------------------------------------------------
-// Ressourcenabfrage über /proc/<pid>/
+// Ressourcenabfrage ueber die Sampling-Engine (stats.c)
 // --------------------------------------------------
-int get_resource_usage(long pid, float *cpu_pct, long *rss_kb) {
-    if (pid <= 0 || !cpu_pct || !rss_kb) return -1;
-
-    char path[64];
-    snprintf(path, sizeof(path), "/proc/%ld/statm", pid);
-    FILE *fp = fopen(path, "r");
-    if (!fp) return -1;
-
-    long total_pages = 0;
-    long rss_pages   = 0;
-    if (fscanf(fp, "%ld %ld", &total_pages, &rss_pages) != 2) {
-        fclose(fp);
-        return -1;
+#define USAGE_SECOND_PROBE_MS 250
+
+/* CPU%, RSS, Tasks, IO und PSI der ganzen Unit. Favoriten werden vom
+   Poller jede Sekunde gemessen; fuer andere Units hier zwei Proben im
+   kurzen Abstand. */
+int get_resource_usage(const char *svc, struct unit_usage *out) {
+    if (!svc || !out) return -1;
+
+    struct unit_usage u = UNIT_USAGE_UNKNOWN;
+    data_lock();
+    if (stats_last(svc, &u) != 0 || u.cpu_pct < 0) {
+        stats_sample(svc, &u);
+        if (u.rss_kb >= 0 && u.cpu_pct < 0) {
+            data_unlock();
+            struct timespec ts = { 0, USAGE_SECOND_PROBE_MS * 1000000L };
+            nanosleep(&ts, NULL);
+            data_lock();
+            stats_sample(svc, &u);
+        }
     }
-    fclose(fp);
-
-    long page_kb = sysconf(_SC_PAGESIZE) / 1024;
-    *rss_kb  = rss_pages * page_kb;
-    *cpu_pct = 0.0f;
+    data_unlock();
 
+    if (u.rss_kb < 0) return -1;
+    *out = u;
     return 0;
 }
 
@@ -71,17 +88,15 @@ int get_resource_usage(long pid, float *cpu_pct, long *rss_kb) {
 // Dependencies anzeigen (ncurses-safe)
 // --------------------------------------------------
 void show_dependencies_ui(const char *svc, const char *scope) {
-    const char *user_flag = (strcmp(scope, "system") == 0 ? "" : "--user");
-    char cmd[512];
+    const char *user_flag = (strcmp(scope, "system") == 0 ? "--system" : "--user");
+    const char *argv[] = { "systemctl", user_flag, "list-dependencies", "--", svc, NULL };
 
     def_prog_mode();
     endwin();
 
     printf("%sAbhaengigkeiten von %s%s\n\n", HEADER_COLOR, svc, RESET_COLOR);
-    snprintf(cmd, sizeof(cmd),
-             "systemctl %s list-dependencies \"%s\"",
-             user_flag, svc);
-    system(cmd);
+    fflush(stdout);
+    spawn_cmd(argv, SPAWN_INTERACTIVE, 0, NULL, NULL);
 
     printf("\n%sDruecke Enter fuer Zurueck...%s", DIM_COLOR, RESET_COLOR);
 
@@ -104,15 +119,11 @@ void edit_unit_file_ui(const char *svc, const char *scope) {
         return;
     }
 
-    const char *user_flag = (strcmp(scope, "system") == 0 ? "" : "--user");
+    const char *user_flag = (strcmp(scope, "system") == 0 ? "--system" : "--user");
     char fragment_path[MAX_LINE] = {0};
-    char cmd[MAX_LINE];
 
     // Pfad zur Unit-File holen
-    snprintf(cmd, sizeof(cmd),
-             "systemctl %s show -p FragmentPath --value \"%s\" 2>/dev/null",
-             user_flag, svc);
-    if (execute_cmd(cmd, fragment_path, sizeof(fragment_path)) != 0 ||
+    if (systemctl_value(scope, svc, "FragmentPath", fragment_path, sizeof(fragment_path)) != 0 ||
         strlen(fragment_path) == 0) {
         show_message_ui("Unit-File-Pfad nicht gefunden.");
         return;
@@ -132,29 +143,29 @@ void edit_unit_file_ui(const char *svc, const char *scope) {
     printf("%sNach dem Speichern wird automatisch daemon-reload ausgeführt.%s\n\n",
            OK_COLOR, RESET_COLOR);
 
-    // Editor öffnen (nano, dann vi)
-    char editor_cmd[512];
-    snprintf(editor_cmd, sizeof(editor_cmd),
-             "if command -v nano >/dev/null 2>&1; then nano \"%s\"; else vi \"%s\"; fi",
-             fragment_path, fragment_path);
-    int ret = system(editor_cmd);
+    // Editor öffnen (nano, dann vi) - posix_spawnp meldet fehlende Programme direkt
+    fflush(stdout);
+    const char *nano_argv[] = { "nano", fragment_path, NULL };
+    const char *vi_argv[]   = { "vi", fragment_path, NULL };
+    int exit_code = spawn_cmd(nano_argv, SPAWN_INTERACTIVE, 0, NULL, NULL);
+    if (exit_code == SPAWN_ERROR) {
+        exit_code = spawn_cmd(vi_argv, SPAWN_INTERACTIVE, 0, NULL, NULL);
+    }
 
-    if (WIFEXITED(ret)) {
-        int exit_code = WEXITSTATUS(ret);
+    if (exit_code >= 0) {
         if (exit_code == 0) {
             // Erfolgsfall: daemon-reload ausführen
             printf("\n%sFühre daemon-reload aus...%s\n", OK_COLOR, RESET_COLOR);
-            char reload_cmd[MAX_LINE];
-            snprintf(reload_cmd, sizeof(reload_cmd),
-                     "%ssystemctl %s daemon-reload 2>/dev/null",
-                     (geteuid() == 0 ? "" : "sudo "), user_flag);
-            int reload_ret = system(reload_cmd);
+            fflush(stdout);
+            const char *reload_argv[] = { "sudo", "systemctl", user_flag, "daemon-reload", NULL };
+            const char *const *argv = (geteuid() == 0) ? reload_argv + 1 : reload_argv;
+            int reload_ret = exec_simple(argv, ACTION_TIMEOUT_MS);
 
-            if (WIFEXITED(reload_ret) && WEXITSTATUS(reload_ret) == 0) {
+            if (reload_ret == 0) {
                 printf("%sdaemon-reload erfolgreich.%s\n", OK_COLOR, RESET_COLOR);
             } else {
                 printf("%sdaemon-reload fehlgeschlagen (Exit %d).%s\n",
-                       WARN_COLOR, WIFEXITED(reload_ret) ? WEXITSTATUS(reload_ret) : -1, RESET_COLOR);
+                       WARN_COLOR, reload_ret, RESET_COLOR);
             }
         } else {
             printf("\n%sEditor mit Exit-Code %d beendet.%s\n",
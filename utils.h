@@ -1,8 +1,10 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include "stats.h"
+
 void open_in_browser_ui(const char *port_str);
-int get_resource_usage(long pid, float *cpu_pct, long *rss_kb);
+int get_resource_usage(const char *svc, struct unit_usage *out);
 void show_dependencies_ui(const char *svc, const char *scope);
 void edit_unit_file_ui(const char *svc, const char *scope);
 void press_enter(void);
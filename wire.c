@@ -0,0 +1,281 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+#include "wire.h"
+#include "strpool.h"
+
+// --------------------------------------------------
+// Schreiben
+// --------------------------------------------------
+void wire_buf_free(struct wire_buf *b) {
+    free(b->data);
+    memset(b, 0, sizeof(*b));
+}
+
+static void put_bytes(struct wire_buf *b, const void *p, size_t len) {
+    if (b->err) return;
+    if (b->len + len > b->cap) {
+        size_t cap = b->cap ? b->cap : 4096;
+        while (cap < b->len + len) cap *= 2;
+        char *data = realloc(b->data, cap);
+        if (!data) {
+            b->err = 1;
+            return;
+        }
+        b->data = data;
+        b->cap = cap;
+    }
+    memcpy(b->data + b->len, p, len);
+    b->len += len;
+}
+
+size_t wire_begin(struct wire_buf *b, int type) {
+    size_t start = b->len;
+    struct wire_hdr hdr = { 0, (uint16_t)type, WIRE_VERSION };
+    put_bytes(b, &hdr, sizeof(hdr));
+    return start;
+}
+
+void wire_end(struct wire_buf *b, size_t start) {
+    if (b->err) return;
+    uint32_t len = (uint32_t)(b->len - start - sizeof(struct wire_hdr));
+    memcpy(b->data + start, &len, sizeof(len));
+}
+
+void wire_put_u8(struct wire_buf *b, unsigned v) {
+    uint8_t x = (uint8_t)v;
+    put_bytes(b, &x, sizeof(x));
+}
+
+void wire_put_u16(struct wire_buf *b, unsigned v) {
+    uint16_t x = (uint16_t)v;
+    put_bytes(b, &x, sizeof(x));
+}
+
+void wire_put_u32(struct wire_buf *b, uint32_t v) {
+    put_bytes(b, &v, sizeof(v));
+}
+
+void wire_put_f32(struct wire_buf *b, float v) {
+    put_bytes(b, &v, sizeof(v));
+}
+
+void wire_put_f64(struct wire_buf *b, double v) {
+    put_bytes(b, &v, sizeof(v));
+}
+
+void wire_put_str(struct wire_buf *b, const char *s) {
+    size_t len = s ? strlen(s) : 0;
+    if (len > 255) len = 255;
+    wire_put_u8(b, (unsigned)len);
+    put_bytes(b, s, len);
+}
+
+void wire_patch_u16(struct wire_buf *b, size_t at, unsigned v) {
+    if (b->err || at + sizeof(uint16_t) > b->len) return;
+    uint16_t x = (uint16_t)v;
+    memcpy(b->data + at, &x, sizeof(x));
+}
+
+// --------------------------------------------------
+// Lesen
+// --------------------------------------------------
+static int get_bytes(struct wire_reader *r, void *p, size_t len) {
+    if (r->err || r->left < len) {
+        r->err = 1;
+        memset(p, 0, len);
+        return -1;
+    }
+    memcpy(p, r->p, len);
+    r->p += len;
+    r->left -= len;
+    return 0;
+}
+
+unsigned wire_get_u8(struct wire_reader *r) {
+    uint8_t x;
+    get_bytes(r, &x, sizeof(x));
+    return x;
+}
+
+unsigned wire_get_u16(struct wire_reader *r) {
+    uint16_t x;
+    get_bytes(r, &x, sizeof(x));
+    return x;
+}
+
+uint32_t wire_get_u32(struct wire_reader *r) {
+    uint32_t x;
+    get_bytes(r, &x, sizeof(x));
+    return x;
+}
+
+float wire_get_f32(struct wire_reader *r) {
+    float x;
+    get_bytes(r, &x, sizeof(x));
+    return x;
+}
+
+double wire_get_f64(struct wire_reader *r) {
+    double x;
+    get_bytes(r, &x, sizeof(x));
+    return x;
+}
+
+const char *wire_get_str(struct wire_reader *r) {
+    char buf[256];
+    unsigned len = wire_get_u8(r);
+    if (get_bytes(r, buf, len) != 0) return NULL;
+    buf[len] = '\0';
+    return str_intern(buf);
+}
+
+// --------------------------------------------------
+// Zeilen
+// --------------------------------------------------
+void wire_put_state(struct wire_buf *b, const struct unit_state *st) {
+    wire_put_u8(b, st->scope);
+    wire_put_u8(b, st->active);
+    wire_put_u8(b, st->enabled);
+    wire_put_str(b, st->desc);
+    for (int i = 0; i < UNIT_PORTS_MAX; i++) wire_put_u16(b, st->ports.port[i]);
+    wire_put_u8(b, st->ports.n);
+    wire_put_u8(b, st->ports.n_unix);
+}
+
+void wire_get_state(struct wire_reader *r, struct unit_state *st) {
+    unsigned scope = wire_get_u8(r);
+    unsigned active = wire_get_u8(r);
+    unsigned enabled = wire_get_u8(r);
+    // Werte aus dem Netz nie ungeprueft als Tabellenindex benutzen
+    st->scope = scope < UNIT_SCOPE_COUNT ? scope : UNIT_SCOPE_UNKNOWN;
+    st->active = active < UNIT_ACTIVE_COUNT ? active : UNIT_ACTIVE_UNKNOWN;
+    st->enabled = enabled < UNIT_ENABLED_COUNT ? enabled : UNIT_ENABLED_UNKNOWN;
+    const char *desc = wire_get_str(r);
+    st->desc = desc ? desc : "";
+    for (int i = 0; i < UNIT_PORTS_MAX; i++) st->ports.port[i] = (unsigned short)wire_get_u16(r);
+    st->ports.n = (unsigned char)wire_get_u8(r);
+    st->ports.n_unix = (unsigned char)wire_get_u8(r);
+}
+
+void wire_put_usage(struct wire_buf *b, const struct unit_usage *u) {
+    wire_put_f64(b, u->cpu_pct);
+    wire_put_f64(b, (double)u->rss_kb);
+    wire_put_f64(b, (double)u->tasks);
+    wire_put_f64(b, u->io_kbps);
+    wire_put_f64(b, u->psi_cpu);
+    wire_put_f64(b, u->psi_memory);
+    wire_put_f64(b, u->psi_io);
+}
+
+void wire_get_usage(struct wire_reader *r, struct unit_usage *u) {
+    u->cpu_pct = wire_get_f64(r);
+    u->rss_kb = (long)wire_get_f64(r);
+    u->tasks = (long)wire_get_f64(r);
+    u->io_kbps = wire_get_f64(r);
+    u->psi_cpu = wire_get_f64(r);
+    u->psi_memory = wire_get_f64(r);
+    u->psi_io = wire_get_f64(r);
+}
+
+int wire_hist_delta(const struct unit_history *h, int sent_valid, int sent_count,
+                    unsigned long sent_seq, struct wire_buf *out) {
+    int flags = WIRE_ROW_HIST;
+    unsigned long d = h->seq - sent_seq;
+    int k = d < HISTORY_LEN ? (int)d : HISTORY_LEN;
+    int expect = sent_count + k < HISTORY_LEN ? sent_count + k : HISTORY_LEN;
+
+    if (sent_valid && h->seq == sent_seq && h->count == sent_count) return 0;
+    if (!sent_valid || h->seq < sent_seq || d >= HISTORY_LEN || expect != h->count) {
+        // Neues Abo, neuer Ring oder mindestens einmal ganz umrundet: komplett
+        if (h->count == 0) return 0;
+        flags |= WIRE_ROW_HIST_RESET;
+        k = h->count;
+    }
+    if (!out) return flags;
+
+    wire_put_u16(out, (unsigned)h->count);
+    wire_put_u16(out, (unsigned)h->head);
+    wire_put_u16(out, (unsigned)k);
+    for (int i = 0; i < k; i++) {
+        int slot = (h->head - k + i + HISTORY_LEN) % HISTORY_LEN;
+        for (int s = 0; s < HIST_NSERIES; s++) wire_put_f32(out, h->v[s][slot]);
+    }
+    return flags;
+}
+
+// Gleiche Ringplaetze wie beim Sender, damit head/count direkt passen
+void wire_get_hist(struct wire_reader *r, int flags, struct unit_history *h) {
+    int count = (int)wire_get_u16(r);
+    int head = (int)wire_get_u16(r);
+    int k = (int)wire_get_u16(r);
+    if (count > HISTORY_LEN || head >= HISTORY_LEN || k > HISTORY_LEN) {
+        r->err = 1;
+        return;
+    }
+    if (flags & WIRE_ROW_HIST_RESET) memset(h, 0, sizeof(*h));
+    for (int i = 0; i < k; i++) {
+        int slot = (head - k + i + HISTORY_LEN) % HISTORY_LEN;
+        for (int s = 0; s < HIST_NSERIES; s++) h->v[s][slot] = wire_get_f32(r);
+    }
+    h->count = count;
+    h->head = head;
+    h->seq += (unsigned long)k;   // eigene Zaehlung, nur fuer Aenderungserkennung
+}
+
+// --------------------------------------------------
+// Transport
+// --------------------------------------------------
+int wire_fill(int fd, struct wire_buf *in) {
+    char buf[16384];
+    while (1) {
+        ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) {
+            put_bytes(in, buf, (size_t)n);
+            if (in->err || in->len > 2 * (size_t)WIRE_MAX_MSG) return -1;   // Gegenseite schickt Unsinn
+            continue;
+        }
+        if (n == 0) return -1;
+        if (errno == EINTR) continue;
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+}
+
+int wire_next(struct wire_buf *in, size_t *pos, struct wire_hdr *hdr, struct wire_reader *body) {
+    if (in->len - *pos < sizeof(*hdr)) return 0;
+    memcpy(hdr, in->data + *pos, sizeof(*hdr));
+    if (hdr->version != WIRE_VERSION || hdr->len > WIRE_MAX_MSG) return -1;
+    if (in->len - *pos - sizeof(*hdr) < hdr->len) return 0;
+
+    body->p = in->data + *pos + sizeof(*hdr);
+    body->left = hdr->len;
+    body->err = 0;
+    *pos += sizeof(*hdr) + hdr->len;
+    return 1;
+}
+
+void wire_consume(struct wire_buf *in, size_t pos) {
+    if (pos == 0) return;
+    memmove(in->data, in->data + pos, in->len - pos);
+    in->len -= pos;
+}
+
+int wire_flush(int fd, struct wire_buf *out) {
+    size_t done = 0;
+    while (done < out->len) {
+        ssize_t n = send(fd, out->data + done, out->len - done, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) {
+            done += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        return -1;
+    }
+    wire_consume(out, done);
+    return out->len > 0 ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "stats.h"
+#include "history.h"
+#include "unitstate.h"
+
+/* Protokoll zwischen "sysdash --daemon" und den TUI-Clients ueber einen
+   Unix-Socket. Beide Seiten laufen auf demselben Rechner: Zahlen in
+   Host-Byte-Order, kein Padding (alles einzeln geschrieben).
+
+   Rahmen: u32 Laenge der Nutzdaten, u16 Typ, u16 WIRE_VERSION.
+
+   WIRE_SUBSCRIBE (Client -> Daemon), ersetzt das vorige Abo:
+     u32 sub_id, u16 count, u16 nfav, count x (u8 len, Name),
+     u16 nkeep, nkeep x (u8 len, Name)
+     Die ersten nfav Namen bekommen zusaetzlich CPU/RSS und Verlauf
+     (der Daemon kappt nfav bei DAEMON_MAX_FAVORITES). Die keep-Namen sind
+     Favoriten ausserhalb des Ausschnitts: der Daemon fuehrt ihren Verlauf
+     weiter, schickt fuer sie aber keine Zeilen.
+
+   WIRE_UPDATE (Daemon -> Client), nur geaenderte Zeilen:
+     u32 sub_id, u16 nrows, nrows x Zeile
+     Zeile: u16 Index im Abo, u8 WIRE_ROW_*-Bits, dann je nach Bit
+       STATE: u8 scope, u8 active, u8 enabled, u8 len + desc,
+              UNIT_PORTS_MAX x u16 port, u8 n, u8 n_unix
+       USAGE: 7 x f64 (Reihenfolge wie struct unit_usage)
+       HIST:  u16 count, u16 head, u16 k, k x HIST_NSERIES x f32
+              (die k Ringplaetze vor head, aeltester zuerst)
+   Die erste Antwort auf ein neues Abo enthaelt alle bekannten Zeilen. */
+#define WIRE_VERSION    2
+#define WIRE_SUBSCRIBE  1
+#define WIRE_UPDATE     2
+
+#define WIRE_MAX_MSG    (4 * 1024 * 1024)
+#define WIRE_MAX_NAMES  4096
+
+#define WIRE_ROW_STATE      0x01
+#define WIRE_ROW_USAGE      0x02
+#define WIRE_ROW_HIST       0x04
+#define WIRE_ROW_HIST_RESET 0x08   // Ring vorher leeren (neues Abo, Luecke)
+
+#define WIRE_SOCKET_ENV  "SYSDASH_SOCKET"
+#define WIRE_SOCKET_SYS  "/run/sysdash.sock"
+
+struct wire_hdr {
+    uint32_t len;
+    uint16_t type;
+    uint16_t version;
+};
+
+// Wachsender Sendepuffer
+struct wire_buf {
+    char *data;
+    size_t len;
+    size_t cap;
+    int err;             // Speicher fehlte: Nachricht verwerfen
+};
+
+struct wire_reader {
+    const char *p;
+    size_t left;
+    int err;             // zu kurz: Nachricht ungueltig
+};
+
+void   wire_buf_free(struct wire_buf *b);
+size_t wire_begin(struct wire_buf *b, int type);        // Rueckgabe: Position des Rahmens
+void   wire_end(struct wire_buf *b, size_t start);      // traegt die Laenge nach
+void   wire_put_u8(struct wire_buf *b, unsigned v);
+void   wire_put_u16(struct wire_buf *b, unsigned v);
+void   wire_put_u32(struct wire_buf *b, uint32_t v);
+void   wire_put_f32(struct wire_buf *b, float v);
+void   wire_put_f64(struct wire_buf *b, double v);
+void   wire_put_str(struct wire_buf *b, const char *s); // u8 Laenge, bei 255 gekappt
+void   wire_patch_u16(struct wire_buf *b, size_t at, unsigned v);   // Zaehler nachtragen
+
+unsigned wire_get_u8(struct wire_reader *r);
+unsigned wire_get_u16(struct wire_reader *r);
+uint32_t wire_get_u32(struct wire_reader *r);
+float    wire_get_f32(struct wire_reader *r);
+double   wire_get_f64(struct wire_reader *r);
+// Liefert einen String-Pool-Zeiger (oder NULL bei Fehler)
+const char *wire_get_str(struct wire_reader *r);
+
+void wire_put_state(struct wire_buf *b, const struct unit_state *st);
+void wire_get_state(struct wire_reader *r, struct unit_state *st);
+void wire_put_usage(struct wire_buf *b, const struct unit_usage *u);
+void wire_get_usage(struct wire_reader *r, struct unit_usage *u);
+
+/* Verlauf als Delta gegen den Stand sent_count/sent_seq beim Empfaenger.
+   Neu ist, was seit sent_seq dazukam; head/count allein sehen nach genau
+   einer Umrundung wieder gleich aus.
+   Rueckgabe: WIRE_ROW_HIST (ggf. | WIRE_ROW_HIST_RESET) oder 0 = nichts neu.
+   Geschrieben wird nur, wenn out != NULL. */
+int  wire_hist_delta(const struct unit_history *h, int sent_valid, int sent_count,
+                     unsigned long sent_seq, struct wire_buf *out);
+void wire_get_hist(struct wire_reader *r, int flags, struct unit_history *h);
+
+/* Gepufferter Empfang: haengt an, was der fd gerade hat.
+   Rueckgabe: 0 = ok, -1 = Verbindung zu oder Fehler */
+int  wire_fill(int fd, struct wire_buf *in);
+// Naechste vollstaendige Nachricht aus in (nach wire_fill). 1 = da, 0 = unvollstaendig, -1 = ungueltig
+int  wire_next(struct wire_buf *in, size_t *pos, struct wire_hdr *hdr, struct wire_reader *body);
+void wire_consume(struct wire_buf *in, size_t pos);
+
+/* Schickt so viel wie moeglich ohne zu blockieren und behaelt den Rest.
+   Rueckgabe: 0 = alles raus, 1 = Rest wartet auf POLLOUT, -1 = Fehler */
+int  wire_flush(int fd, struct wire_buf *out);
+
+#endif